@@ -0,0 +1,167 @@
+#include <vsync/map/hashtable_split.h>
+#include <vsync/smr/ebr.h>
+#include <vsync/common/assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N           4U
+#define MIN_BUCKETS 2U
+#define MIN_KEY     1U
+#define MAX_KEY     1024U
+
+typedef struct data_s {
+    vhashtable_split_entry_t ht_entry;
+    vuintptr_t key;
+    smr_node_t smr_node;
+    // data
+} data_t;
+
+vhashtable_split_t g_hashtable;
+vebr_t g_vebr;
+pthread_mutex_t g_lock;
+__thread vebr_thread_t g_thrd;
+
+static inline void
+lock_acq(void *arg)
+{
+    int ret = pthread_mutex_lock((pthread_mutex_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    int ret = pthread_mutex_unlock((pthread_mutex_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+smr_lock_lib_t g_lock_lib = {lock_acq, lock_rel, &g_lock};
+
+void *
+malloc_cb(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+void
+free_cb(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+vuint64_t
+hash_cb(vuintptr_t key)
+{
+    vuint64_t h = key;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+int
+cmp_key_cb(vhashtable_split_entry_t *entry, vhashtable_split_key_t key)
+{
+    data_t *data = V_CONTAINER_OF(entry, data_t, ht_entry);
+    if (data->key < key) {
+        return -1;
+    } else if (data->key > key) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+void
+free_data_cb(smr_node_t *node, void *arg)
+{
+    data_t *data = V_CONTAINER_OF(node, data_t, smr_node);
+    free(data);
+    V_UNUSED(arg);
+}
+
+void
+retire_cb(vhashtable_split_entry_t *entry, void *arg)
+{
+    data_t *data = V_CONTAINER_OF(entry, data_t, ht_entry);
+    vebr_retire(&g_vebr, &g_thrd, &data->smr_node, free_data_cb, NULL);
+    V_UNUSED(arg);
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid  = (vsize_t)(vuintptr_t)args;
+    data_t *data = NULL;
+    vsize_t cnt  = 0;
+
+    vebr_register(&g_vebr, &g_thrd);
+
+    /* every thread adds its share of the keys, the table grows on the way */
+    for (vuintptr_t key = MIN_KEY + tid; key <= MAX_KEY; key += N) {
+        data      = malloc(sizeof(data_t));
+        data->key = key;
+        vebr_enter(&g_vebr, &g_thrd);
+        if (vhashtable_split_insert(&g_hashtable, key, &data->ht_entry,
+                                    hash_cb(key))) {
+            cnt++;
+        } else {
+            free(data);
+        }
+        vebr_exit(&g_vebr, &g_thrd);
+    }
+
+    /* and removes every other key */
+    for (vuintptr_t key = MIN_KEY + tid; key <= MAX_KEY; key += 2 * N) {
+        vebr_enter(&g_vebr, &g_thrd);
+        if (vhashtable_split_remove(&g_hashtable, key, hash_cb(key))) {
+            cnt--;
+        }
+        vebr_exit(&g_vebr, &g_thrd);
+        (void)vebr_recycle(&g_vebr);
+    }
+    printf("T%zu: owns %zu keys\n", tid, cnt);
+
+    vebr_deregister(&g_vebr, &g_thrd);
+    return NULL;
+}
+
+int
+main(void)
+{
+    pthread_t threads[N];
+    vmem_lib_t mem_lib = {.free_fun   = free_cb,
+                          .malloc_fun = malloc_cb,
+                          .arg        = NULL};
+
+    pthread_mutex_init(&g_lock, NULL);
+    vebr_init(&g_vebr, g_lock_lib);
+    vhashtable_split_init(&g_hashtable, MIN_BUCKETS, retire_cb, NULL,
+                          cmp_key_cb, mem_lib);
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)i);
+    }
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("%zu entries in %zu buckets\n",
+           vhashtable_split_get_entries_count(&g_hashtable),
+           vhashtable_split_get_bucket_count(&g_hashtable));
+
+    vebr_register(&g_vebr, &g_thrd);
+    vhashtable_split_destroy(&g_hashtable);
+    vebr_deregister(&g_vebr, &g_thrd);
+    vebr_destroy(&g_vebr);
+    pthread_mutex_destroy(&g_lock);
+    return 0;
+}
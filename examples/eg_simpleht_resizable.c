@@ -0,0 +1,179 @@
+#include <vsync/map/simpleht_resizable.h>
+#include <vsync/smr/ebr.h>
+#include <vsync/common/assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N                 3U
+#define HASHTABLE_MIN_CAP 4U
+#define MIN_KEY           1U
+#define MAX_KEY           128U
+
+typedef struct data_s {
+    vuintptr_t key;
+    smr_node_t smr_node;
+    // data
+} data_t;
+
+vsimpleht_rsz_t g_hashtable;
+vebr_t g_vebr;
+pthread_mutex_t g_lock;
+__thread vebr_thread_t g_thrd;
+
+static inline void
+lock_acq(void *arg)
+{
+    int ret = pthread_mutex_lock((pthread_mutex_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    int ret = pthread_mutex_unlock((pthread_mutex_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+smr_lock_lib_t g_lock_lib = {lock_acq, lock_rel, &g_lock};
+
+void *
+malloc_cb(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+void
+free_cb(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+vuint64_t
+hash_cb(vuintptr_t key)
+{
+    vuint64_t h = key;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+vint8_t
+cmp_key_cb(vuintptr_t a, vuintptr_t b)
+{
+    if (a < b) {
+        return -1;
+    } else if (a > b) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+void
+free_data_cb(smr_node_t *node, void *arg)
+{
+    data_t *data = V_CONTAINER_OF(node, data_t, smr_node);
+    free(data);
+    V_UNUSED(arg);
+}
+
+void
+free_tbl_cb(smr_node_t *node, void *arg)
+{
+    vsimpleht_rsz_tbl_t *tbl =
+        V_CONTAINER_OF(node, vsimpleht_rsz_tbl_t, smr_node);
+    vsimpleht_rsz_tbl_free(&g_hashtable, tbl);
+    V_UNUSED(arg);
+}
+
+void
+retire_val_cb(void *val, void *arg)
+{
+    data_t *data = val;
+    vebr_retire(&g_vebr, &g_thrd, &data->smr_node, free_data_cb, NULL);
+    V_UNUSED(arg);
+}
+
+void
+retire_tbl_cb(vsimpleht_rsz_tbl_t *tbl, void *arg)
+{
+    vebr_retire(&g_vebr, &g_thrd, &tbl->smr_node, free_tbl_cb, NULL);
+    V_UNUSED(arg);
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid             = (vsize_t)(vuintptr_t)args;
+    data_t *data            = NULL;
+    vsimpleht_rsz_ret_t ret = VSIMPLEHT_RSZ_RET_OK;
+
+    vebr_register(&g_vebr, &g_thrd);
+
+    for (vuintptr_t key = MIN_KEY; key < MAX_KEY; key++) {
+        vebr_enter(&g_vebr, &g_thrd);
+        data = vsimpleht_rsz_get(&g_hashtable, key);
+        if (data) {
+            ASSERT(data->key == key);
+            ret = vsimpleht_rsz_remove(&g_hashtable, key);
+            if (ret == VSIMPLEHT_RSZ_RET_OK) {
+                printf("T%zu: removed key %lu\n", tid, key);
+            } else {
+                printf("T%zu: key %lu does not exist\n", tid, key);
+            }
+        } else {
+            data      = malloc(sizeof(data_t));
+            data->key = key;
+            ret       = vsimpleht_rsz_add(&g_hashtable, key, data);
+            if (ret == VSIMPLEHT_RSZ_RET_OK) {
+                printf("T%zu: added key %lu\n", tid, key);
+            } else {
+                printf("T%zu: key %lu already exists\n", tid, key);
+                free(data);
+            }
+        }
+        vebr_exit(&g_vebr, &g_thrd);
+        /* reclaim retired values and tables outside the critical section */
+        (void)vebr_recycle(&g_vebr);
+    }
+    vebr_deregister(&g_vebr, &g_thrd);
+    return NULL;
+}
+
+int
+main(void)
+{
+    pthread_t threads[N];
+    vmem_lib_t mem_lib = {.free_fun   = free_cb,
+                          .malloc_fun = malloc_cb,
+                          .arg        = NULL};
+
+    pthread_mutex_init(&g_lock, NULL);
+    vebr_init(&g_vebr, g_lock_lib);
+    vsimpleht_rsz_init(&g_hashtable, HASHTABLE_MIN_CAP, cmp_key_cb, hash_cb,
+                       retire_val_cb, retire_tbl_cb, NULL, mem_lib);
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)i);
+    }
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    vebr_register(&g_vebr, &g_thrd);
+    printf("%zu entries left\n", vsimpleht_rsz_get_entries_count(&g_hashtable));
+    vsimpleht_rsz_destroy(&g_hashtable);
+    vebr_deregister(&g_vebr, &g_thrd);
+    vebr_destroy(&g_vebr);
+    pthread_mutex_destroy(&g_lock);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#define TREESET_LOCK_TTAS
+#include <vsync/pool/sized_pool.h>
+#include <vsync/map/treeset_rb_coarse.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N         4U
+#define MAX_KEY   100U
+#define MAX_SIZE  1024U
+#define SLAB_SIZE 4096U
+
+sized_pool_t pool;
+treeset_t tree;
+__thread vuint32_t thread_id;
+
+vuint32_t
+get_thread_id(void)
+{
+    return thread_id;
+}
+
+void *
+malloc_cb(vsize_t sz, void *arg)
+{
+    (void)arg;
+    return malloc(sz);
+}
+
+void
+free_cb(void *ptr, void *arg)
+{
+    (void)arg;
+    free(ptr);
+}
+
+void *
+run(void *args)
+{
+    thread_id = (vuint32_t)(vuintptr_t)args;
+
+    /* tree nodes are allocated from the pool with the ID of this thread */
+    for (treeset_key_t key = thread_id; key < MAX_KEY; key += N) {
+        treeset_add(&tree, key, NULL, NULL);
+    }
+
+    /* the pool can also be used directly */
+    char *msg = sized_pool_alloc(&pool, thread_id, 32);
+    snprintf(msg, 32, "thread %u done", thread_id);
+    printf("%s\n", msg);
+    sized_pool_free(&pool, thread_id, msg);
+    return NULL;
+}
+
+int
+main(void)
+{
+    pthread_t threads[N];
+
+    vmem_lib_t mem_lib = {.free_fun   = free_cb,
+                          .malloc_fun = malloc_cb,
+                          .arg        = NULL};
+
+    /* jemalloc-like classes: 4 classes per doubling up to 1KiB */
+    if (!sized_pool_init(&pool, N + 1U, MAX_SIZE, 4U, SLAB_SIZE,
+                         get_thread_id, mem_lib)) {
+        return 1;
+    }
+    thread_id = N;
+    treeset_init(&tree, sized_pool_mem_lib(&pool));
+
+    for (vuint32_t i = 0; i < N; ++i) {
+        pthread_create(&threads[i], NULL, run, (void *)(vuintptr_t)i);
+    }
+    for (vuint32_t i = 0; i < N; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    treeset_destroy(&tree);
+    sized_pool_destroy(&pool);
+    return 0;
+}
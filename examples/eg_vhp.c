@@ -0,0 +1,119 @@
+#include <vsync/smr/hp.h>
+#include <pthread.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N  4U
+#define IT 1000U
+
+typedef struct config_s {
+    vsize_t version;
+    vhp_node_t hp_node;
+} config_t;
+
+vhp_t g_hp;
+pthread_mutex_t g_lock;
+/* readers load the current configuration, a writer replaces it */
+vatomicptr_t g_config;
+
+static inline void
+lock_acq(void *arg)
+{
+    int ret = pthread_mutex_lock((pthread_mutex_t *)arg);
+    assert(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    int ret = pthread_mutex_unlock((pthread_mutex_t *)arg);
+    assert(ret == 0);
+    V_UNUSED(ret);
+}
+
+smr_lock_lib_t g_lock_lib = {lock_acq, lock_rel, &g_lock};
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    config_t *cfg = V_CONTAINER_OF(node, config_t, hp_node.smr_node);
+    free(cfg);
+    V_UNUSED(args);
+}
+
+void
+writer(vhp_thread_t *thread)
+{
+    config_t *cfg = NULL;
+
+    for (vsize_t i = 1; i <= IT; i++) {
+        cfg          = malloc(sizeof(config_t));
+        cfg->version = i;
+        cfg          = vatomicptr_xchg(&g_config, cfg);
+        /* freed once no reader protects it */
+        vhp_retire(&g_hp, thread, cfg, &cfg->hp_node, free_cb, NULL);
+    }
+}
+
+void
+reader(vhp_thread_t *thread, vsize_t tid)
+{
+    config_t *cfg  = NULL;
+    vsize_t latest = 0;
+
+    for (vsize_t i = 0; i < IT; i++) {
+        cfg = vhp_protect(thread, 0, &g_config);
+        /* cfg cannot be freed until the slot is cleared */
+        assert(cfg->version >= latest);
+        latest = cfg->version;
+        vhp_clear(thread, 0);
+    }
+    printf("[T%zu] observed version %zu\n", tid, latest);
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    vhp_thread_t thread;
+
+    vhp_register(&g_hp, &thread);
+    if (tid == 0) {
+        writer(&thread);
+    } else {
+        reader(&thread, tid);
+    }
+    vhp_deregister(&g_hp, &thread);
+    return NULL;
+}
+
+int
+main(void)
+{
+    pthread_t threads[N];
+    config_t *cfg = malloc(sizeof(config_t));
+
+    int ret = pthread_mutex_init(&g_lock, NULL);
+    assert(ret == 0);
+
+    cfg->version = 0;
+    vatomicptr_init(&g_config, cfg);
+    vhp_init(&g_hp, g_lock_lib);
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)i);
+    }
+
+    for (vsize_t i = 0; i < N; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(vatomicptr_read(&g_config));
+    vhp_destroy(&g_hp);
+
+    ret = pthread_mutex_destroy(&g_lock);
+    assert(ret == 0);
+    return 0;
+}
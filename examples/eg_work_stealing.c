@@ -0,0 +1,100 @@
+#include <vsync/thread/work_stealing.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#define N_WORKERS 4U
+#define LEN       10000U
+#define GRAIN     100U
+
+typedef struct range_s {
+    vws_task_t task; /* keep first */
+    vsize_t from;
+    vsize_t to;
+} range_t;
+
+vws_sched_t g_sched;
+vws_worker_t g_workers[N_WORKERS];
+vuint32_t g_vals[LEN];
+
+vuint32_t
+rand_fun(vuint32_t min, vuint32_t max)
+{
+    return min + ((vuint32_t)rand() % (max - min + 1U));
+}
+
+void *
+malloc_fun(vsize_t sz, void *arg)
+{
+    (void)arg;
+    return malloc(sz);
+}
+
+void
+free_fun(void *ptr, void *arg)
+{
+    (void)arg;
+    free(ptr);
+}
+
+/* doubles every value in the range, splits ranges larger than GRAIN */
+void
+double_range(vws_worker_t *w, vws_task_t *task)
+{
+    range_t *r = (range_t *)task;
+
+    if (r->to - r->from <= GRAIN) {
+        for (vsize_t i = r->from; i < r->to; i++) {
+            g_vals[i] *= 2U;
+        }
+        return;
+    }
+    range_t left  = {.from = r->from, .to = (r->from + r->to) / 2U};
+    range_t right = {.from = left.to, .to = r->to};
+    vws_spawn(w, task, &left.task, double_range);
+    vws_spawn(w, task, &right.task, double_range);
+    vws_sync(w, task);
+}
+
+void *
+run(void *arg)
+{
+    vws_worker_run(&g_sched, (vuint32_t)(vuintptr_t)arg);
+    return NULL;
+}
+
+int
+main(void)
+{
+    vmem_lib_t mem_lib = {
+        .free_fun = free_fun, .malloc_fun = malloc_fun, .arg = NULL};
+    pthread_t threads[N_WORKERS];
+    vws_task_t root;
+    range_t all = {.from = 0, .to = LEN};
+
+    for (vsize_t i = 0; i < LEN; i++) {
+        g_vals[i] = (vuint32_t)i;
+    }
+    vws_init(&g_sched, g_workers, N_WORKERS, rand_fun, mem_lib);
+    /* worker 0 belongs to the main thread */
+    for (vuint32_t i = 1; i < N_WORKERS; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)(vuintptr_t)i);
+    }
+
+    vws_task_init(&root);
+    vws_spawn(vws_worker(&g_sched, 0), &root, &all.task, double_range);
+    vws_sync(vws_worker(&g_sched, 0), &root);
+
+    vws_stop(&g_sched);
+    for (vuint32_t i = 1; i < N_WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    vws_destroy(&g_sched);
+
+    for (vsize_t i = 0; i < LEN; i++) {
+        assert(g_vals[i] == 2U * i);
+    }
+    printf("doubled %u values\n", LEN);
+    return 0;
+}
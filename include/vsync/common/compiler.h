@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2024. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -29,6 +29,30 @@
         }
 #endif
 
+#ifndef V_PREFETCH
+    /**
+     * @brief Hints the CPU to fetch the cacheline of the given address for
+     * reading.
+     */
+    #if defined(VSYNC_VERIFICATION)
+        #define V_PREFETCH(_addr_) ((void)(_addr_))
+    #else
+        #define V_PREFETCH(_addr_) __builtin_prefetch((_addr_), 0)
+    #endif
+#endif
+
+#ifndef V_PREFETCH_W
+    /**
+     * @brief Hints the CPU to fetch the cacheline of the given address for
+     * writing.
+     */
+    #if defined(VSYNC_VERIFICATION)
+        #define V_PREFETCH_W(_addr_) ((void)(_addr_))
+    #else
+        #define V_PREFETCH_W(_addr_) __builtin_prefetch((_addr_), 1)
+    #endif
+#endif
+
 #if defined(container_of)
     #define V_CONTAINER_OF(_ptr_, _type_, _member_)                            \
         container_of(_ptr_, _type_, _member_)
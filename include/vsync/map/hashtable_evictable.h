@@ -0,0 +1,460 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VHASHTABLE_EVICTABLE_H
+#define VHASHTABLE_EVICTABLE_H
+/*******************************************************************************
+ * @file hashtable_evictable.h
+ * @ingroup requires_smr lock_free linearizable
+ * @brief Lock-free listset based hashtable with CLOCK eviction.
+ *
+ * The table has the same layout and interface as
+ * vsync/map/hashtable_standard.h, i.e., `VHASHTABLE_BUCKET_COUNT` buckets each
+ * holding a lock-free listset, and users pass `hash_idx` to the APIs.
+ *
+ * In addition, entries can be evicted with the CLOCK algorithm. Every entry
+ * carries a reference bit which is set when the entry is inserted or found by
+ * `vhashtable_get`. The clock hand moves over the buckets. It clears the bit
+ * of the entries that have it set, giving them a second chance, and evicts the
+ * ones that have it cleared. Eviction runs concurrently with all other
+ * operations: an entry is evicted exactly like it is removed, and it is
+ * handed to the retire callback once detached, which is expected to retire it
+ * to an SMR scheme.
+ *
+ * Eviction happens on two occasions. Users can call `vhashtable_evict`. And
+ * if the table is initialized with `vhashtable_init_bounded`, every insertion
+ * that pushes the number of entries above the capacity evicts one entry.
+ *
+ * The table counts hits and misses of `vhashtable_get` per bucket and the
+ * number of evicted entries, see `vhashtable_get_stats`.
+ *
+ * @example
+ * @include eg_hashtable_evictable.c
+ *
+ * @cite
+ * Fernando J. Corbato - A Paging Experiment with the Multics System
+ ******************************************************************************/
+#include <vsync/vtypes.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/common/cache.h>
+#include <vsync/common/compiler.h>
+#include <vsync/map/listset_lf.h>
+#include <vsync/map/internal/hashtable/hashtable_config.h>
+#include <vsync/utils/math.h>
+
+#if defined(VLISTSET_NO_FUN_POINTER)
+    #error "hashtable_evictable.h cannot be used with VLISTSET_NO_FUN_POINTER"
+#endif
+
+typedef vlistset_key_t vhashtable_key_t;
+
+typedef struct vhashtable_entry_s {
+    vlistset_node_t lst_node;
+    vatomic8_t referenced; /* reference bit of CLOCK */
+} vhashtable_entry_t;
+
+/**
+ * The function is expected to return
+ * 0 if container(entry)->key == key
+ * -1 if container(entry)->key < key
+ * 1 if container(entry)->key > key
+ */
+typedef int (*vhashtable_cmp_key_t)(vhashtable_entry_t *entry,
+                                    vhashtable_key_t key);
+/**
+ * Called on every entry detached from the hashtable, removed or evicted, and
+ * on the remaining entries by `vhashtable_destroy`.
+ */
+typedef void (*vhashtable_entry_retire_t)(vhashtable_entry_t *entry,
+                                          void *arg);
+
+typedef struct vbucket_s {
+    vlistset_t lst;
+    vatomic64_t hits;
+    vatomic64_t misses;
+} VSYNC_CACHEALIGN vbucket_t;
+
+typedef struct vhashtable_s {
+    vbucket_t buckets[VHASHTABLE_BUCKET_COUNT];
+    vatomic64_t num_entries;
+    vatomic64_t evictions;
+    vatomicsz_t clock_hand;
+    vuint64_t capacity; /* 0 if unbounded */
+    vhashtable_cmp_key_t cmp_fun;
+    vhashtable_entry_retire_t retire_fun;
+    void *retire_fun_arg;
+} vhashtable_t;
+
+typedef struct vhashtable_stats_s {
+    vuint64_t hits;
+    vuint64_t misses;
+    vuint64_t evictions;
+} vhashtable_stats_t;
+
+/* the key passed down to the listset */
+typedef struct vhashtable_query_s {
+    vhashtable_t *table;
+    vhashtable_key_t key;
+} vhashtable_query_t;
+
+static inline vuint64_t _vhashtable_bucket_evict(vhashtable_t *table,
+                                                 vbucket_t *bucket,
+                                                 vuint64_t count);
+static inline int _vhashtable_cmp(vlistset_node_t *node, vlistset_key_t key);
+static inline void _vhashtable_retire(vlistset_node_t *node, void *arg);
+static inline void _vhashtable_count(vlistset_node_t *node, void *arg);
+
+/**
+ * Initializes the hashtable with a capacity.
+ *
+ * @param table address of vhashtable_t object.
+ * @param retire_cb address of a callback function of type
+ * `vhashtable_entry_retire_t`. The function is called whenever an entry is
+ * detached from the hashtable.
+ * @param retire_cb_arg address of an extra argument of `retire_cb`.
+ * @param cmp_cb address of callback function of type `vhashtable_cmp_key_t`.
+ * Used for comparing an entry key to a given key.
+ * @param capacity maximum number of entries. An insertion that exceeds it
+ * evicts an entry. `0` disables the bound.
+ * @note must be called before threads start accessing the hashtable.
+ */
+static inline void
+vhashtable_init_bounded(vhashtable_t *table,
+                        vhashtable_entry_retire_t retire_cb,
+                        void *retire_cb_arg, vhashtable_cmp_key_t cmp_cb,
+                        vuint64_t capacity)
+{
+    ASSERT(table);
+    ASSERT(retire_cb);
+    ASSERT(cmp_cb);
+    for (vsize_t i = 0; i < VHASHTABLE_BUCKET_COUNT; i++) {
+        vlistset_init(&table->buckets[i].lst, _vhashtable_retire, table,
+                      _vhashtable_cmp);
+        vatomic64_write_rlx(&table->buckets[i].hits, 0);
+        vatomic64_write_rlx(&table->buckets[i].misses, 0);
+    }
+    vatomic64_write_rlx(&table->num_entries, 0);
+    vatomic64_write_rlx(&table->evictions, 0);
+    vatomicsz_write_rlx(&table->clock_hand, 0);
+    table->capacity       = capacity;
+    table->cmp_fun        = cmp_cb;
+    table->retire_fun     = retire_cb;
+    table->retire_fun_arg = retire_cb_arg;
+}
+/**
+ * Initializes the hashtable without capacity, entries are only evicted by
+ * `vhashtable_evict`.
+ *
+ * @param table address of vhashtable_t object.
+ * @param retire_cb address of a callback function of type
+ * `vhashtable_entry_retire_t`. The function is called whenever an entry is
+ * detached from the hashtable.
+ * @param retire_cb_arg address of an extra argument of `retire_cb`.
+ * @param cmp_cb address of callback function of type `vhashtable_cmp_key_t`.
+ * Used for comparing an entry key to a given key.
+ * @note must be called before threads start accessing the hashtable.
+ */
+static inline void
+vhashtable_init(vhashtable_t *table, vhashtable_entry_retire_t retire_cb,
+                void *retire_cb_arg, vhashtable_cmp_key_t cmp_cb)
+{
+    vhashtable_init_bounded(table, retire_cb, retire_cb_arg, cmp_cb, 0);
+}
+/**
+ * Retires all entries in the hashtable.
+ *
+ * @param table address of vhashtable_t object.
+ * @note this function is not thread-safe, can be called iff all threads are
+ * done accessing the hashtable.
+ */
+static inline void
+vhashtable_destroy(vhashtable_t *table)
+{
+    ASSERT(table);
+    for (vsize_t i = 0; i < VHASHTABLE_BUCKET_COUNT; i++) {
+        vlistset_destroy(&table->buckets[i].lst);
+    }
+}
+/**
+ * Evicts up to `count` entries.
+ *
+ * Moves the clock hand over the buckets until `count` entries are evicted or
+ * the hand went twice around the table.
+ *
+ * @param table address of vhashtable_t object.
+ * @param count number of entries to evict.
+ * @return vuint64_t number of evicted entries.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vuint64_t
+vhashtable_evict(vhashtable_t *table, vuint64_t count)
+{
+    vuint64_t evicted = 0;
+    vsize_t idx       = 0;
+
+    ASSERT(table);
+    /* a single round clears the reference bits, the second one evicts */
+    for (vsize_t i = 0; i < 2U * VHASHTABLE_BUCKET_COUNT && evicted < count;
+         i++) {
+        idx = vatomicsz_get_inc_rlx(&table->clock_hand) &
+              (VHASHTABLE_BUCKET_COUNT - 1U);
+        evicted += _vhashtable_bucket_evict(table, &table->buckets[idx],
+                                            count - evicted);
+    }
+    if (evicted > 0) {
+        vatomic64_add_rlx(&table->evictions, evicted);
+    }
+    return evicted;
+}
+/**
+ * Inserts the given `entry` into the hashtable.
+ *
+ * If the table is bounded and the insertion exceeds the capacity, an entry is
+ * evicted.
+ *
+ * @param table address of vhashtable_t object.
+ * @param key value of the key object.
+ * @param val address of vhashtable_entry_t object.
+ * @param hash_idx a hash value of the key used as a bucket index. must be
+ * `< VHASHTABLE_BUCKET_COUNT`
+ * @return true successful insertion.
+ * @return false failed insertion, an entry associated with the given `key`
+ * already exists.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vbool_t
+vhashtable_insert(vhashtable_t *table, vhashtable_key_t key,
+                  vhashtable_entry_t *val, vsize_t hash_idx)
+{
+    vhashtable_query_t query = {.table = table, .key = key};
+    vuint64_t count          = 0;
+
+    ASSERT(table);
+    ASSERT(val);
+    ASSERT(hash_idx < VHASHTABLE_BUCKET_COUNT);
+    vatomic8_write_rlx(&val->referenced, 1U);
+    if (!vlistset_add(&table->buckets[hash_idx].lst, (vlistset_key_t)&query,
+                      &val->lst_node)) {
+        return false;
+    }
+    count = vatomic64_inc_get_rlx(&table->num_entries);
+    if (table->capacity != 0 && count > table->capacity) {
+        (void)vhashtable_evict(table, 1);
+    }
+    return true;
+}
+/**
+ * Looks for the entry associated with the given `key`.
+ *
+ * Sets the reference bit of the found entry.
+ *
+ * @param table address of vhashtable_t object.
+ * @param key value of the key object.
+ * @param hash_idx a hash value of the key used as a bucket index. must be
+ * `< VHASHTABLE_BUCKET_COUNT`
+ * @return vhashtable_entry_t* address of the
+ * `vhashtable_entry_t` object associated with the given key, if found.
+ * @return `NULL` if key is not found.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vhashtable_entry_t *
+vhashtable_get(vhashtable_t *table, vhashtable_key_t key, vsize_t hash_idx)
+{
+    vhashtable_query_t query = {.table = table, .key = key};
+    vhashtable_entry_t *entry = NULL;
+    vlistset_node_t *node     = NULL;
+    vbucket_t *bucket         = NULL;
+
+    ASSERT(table);
+    ASSERT(hash_idx < VHASHTABLE_BUCKET_COUNT);
+    bucket = &table->buckets[hash_idx];
+    node   = vlistset_get(&bucket->lst, (vlistset_key_t)&query);
+    if (node == NULL) {
+        vatomic64_inc_rlx(&bucket->misses);
+        return NULL;
+    }
+    vatomic64_inc_rlx(&bucket->hits);
+    entry = V_CONTAINER_OF(node, vhashtable_entry_t, lst_node);
+    /* avoid writing to the cacheline if the bit is set already */
+    if (vatomic8_read_rlx(&entry->referenced) == 0U) {
+        vatomic8_write_rlx(&entry->referenced, 1U);
+    }
+    return entry;
+}
+/**
+ * Removes the entry associated with the given key from the the hashtable.
+ *
+ * @param table address of vhashtable_t object.
+ * @param key value of the key object.
+ * @param hash_idx a hash value of the key used as a bucket index. must be
+ * `< VHASHTABLE_BUCKET_COUNT`.
+ * @return true successful remove, the entry associated with the given key was
+ * removed.
+ * @return false failed remove, no entry associated with the given key exists.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vbool_t
+vhashtable_remove(vhashtable_t *table, vhashtable_key_t key, vsize_t hash_idx)
+{
+    vhashtable_query_t query = {.table = table, .key = key};
+
+    ASSERT(table);
+    ASSERT(hash_idx < VHASHTABLE_BUCKET_COUNT);
+    if (!vlistset_remove(&table->buckets[hash_idx].lst,
+                         (vlistset_key_t)&query)) {
+        return false;
+    }
+    vatomic64_dec_rlx(&table->num_entries);
+    return true;
+}
+/**
+ * Returns the count of entries currently available in the hashtable.
+ *
+ * @param table address of vhashtable_t object.
+ * @return vuint64_t an approximate count of the entries available in the
+ * hashtable.
+ */
+static inline vuint64_t
+vhashtable_get_entries_count(vhashtable_t *table)
+{
+    ASSERT(table);
+    return vatomic64_read_rlx(&table->num_entries);
+}
+/**
+ * Collects the hit, miss and eviction counters.
+ *
+ * @param table address of vhashtable_t object.
+ * @param stats output parameter, address of vhashtable_stats_t object.
+ * @note the counters are read one by one, the result is approximate if other
+ * threads access the table at the same time.
+ */
+static inline void
+vhashtable_get_stats(vhashtable_t *table, vhashtable_stats_t *stats)
+{
+    ASSERT(table);
+    ASSERT(stats);
+    stats->hits      = 0;
+    stats->misses    = 0;
+    stats->evictions = vatomic64_read_rlx(&table->evictions);
+    for (vsize_t i = 0; i < VHASHTABLE_BUCKET_COUNT; i++) {
+        stats->hits += vatomic64_read_rlx(&table->buckets[i].hits);
+        stats->misses += vatomic64_read_rlx(&table->buckets[i].misses);
+    }
+}
+/**
+ * Returns the number of entries in the given bucket.
+ *
+ * @param bucket address of vbucket_t object.
+ * @return vuint64_t number of entries.
+ * @note not thread-safe, meant for statistics after threads are done.
+ */
+static inline vuint64_t
+vbucket_get_length(vbucket_t *bucket)
+{
+    vuint64_t len = 0;
+    ASSERT(bucket);
+    _vlistset_visit(&bucket->lst, _vhashtable_count, &len, false);
+    return len;
+}
+/**
+ * Evicts up to `count` entries of the given bucket.
+ *
+ * Entries with the reference bit set get their bit cleared, the others are
+ * marked as removed and detached.
+ *
+ * @param table address of vhashtable_t object.
+ * @param bucket address of vbucket_t object.
+ * @param count maximum number of entries to evict.
+ * @return vuint64_t number of evicted entries.
+ */
+static inline vuint64_t
+_vhashtable_bucket_evict(vhashtable_t *table, vbucket_t *bucket,
+                         vuint64_t count)
+{
+    vlistset_t *lst           = &bucket->lst;
+    vlistset_node_t *tail     = &lst->tail_sentinel;
+    vlistset_node_t *pred     = NULL;
+    vlistset_node_t *curr     = NULL;
+    vlistset_node_t *succ     = NULL;
+    vhashtable_entry_t *entry = NULL;
+    vbool_t marked            = false;
+    vuint64_t evicted         = 0;
+
+RETRY:
+    pred = &lst->head_sentinel;
+    curr = vatomicptr_markable_get_pointer(&pred->next);
+    while (curr != tail && evicted < count) {
+        succ = vatomicptr_markable_get(&curr->next, &marked);
+        if (!marked) {
+            entry = V_CONTAINER_OF(curr, vhashtable_entry_t, lst_node);
+            if (vatomic8_read_rlx(&entry->referenced)) {
+                /* second chance */
+                vatomic8_write_rlx(&entry->referenced, 0U);
+                pred = curr;
+                curr = succ;
+                continue;
+            }
+            /* logically remove the entry, like vlistset_remove does */
+            if (!vatomicptr_markable_cmpxchg(&curr->next, succ, false, succ,
+                                             true)) {
+                /* curr->next changed, look at curr again */
+                continue;
+            }
+            vatomic64_dec_rlx(&table->num_entries);
+            evicted++;
+        }
+        /* detach the marked entry, whoever detaches it retires it */
+        if (!vatomicptr_markable_cmpxchg(&pred->next, curr, false, succ,
+                                         false)) {
+            goto RETRY;
+        }
+        lst->retire_fun(curr, lst->retire_fun_arg);
+        curr = succ;
+    }
+    return evicted;
+}
+/**
+ * Compares the given list node with the given query.
+ *
+ * @param node address of vlistset_node_t object.
+ * @param key address of vhashtable_query_t object.
+ * @return int result of the user compare callback.
+ */
+static inline int
+_vhashtable_cmp(vlistset_node_t *node, vlistset_key_t key)
+{
+    vhashtable_query_t *query = (vhashtable_query_t *)key;
+    return query->table->cmp_fun(
+        V_CONTAINER_OF(node, vhashtable_entry_t, lst_node), query->key);
+}
+/**
+ * Forwards the detached entries to the user retire callback.
+ *
+ * @param node address of the detached vlistset_node_t object.
+ * @param arg address of vhashtable_t object.
+ */
+static inline void
+_vhashtable_retire(vlistset_node_t *node, void *arg)
+{
+    vhashtable_t *table = (vhashtable_t *)arg;
+    table->retire_fun(V_CONTAINER_OF(node, vhashtable_entry_t, lst_node),
+                      table->retire_fun_arg);
+}
+/**
+ * Counts the visited nodes.
+ *
+ * @param node address of vlistset_node_t object.
+ * @param arg address of the vuint64_t counter.
+ */
+static inline void
+_vhashtable_count(vlistset_node_t *node, void *arg)
+{
+    vuint64_t *len = (vuint64_t *)arg;
+    (*len)++;
+    V_UNUSED(node);
+}
+
+#endif
@@ -0,0 +1,554 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VHASHTABLE_SPLIT_H
+#define VHASHTABLE_SPLIT_H
+/*******************************************************************************
+ * @file hashtable_split.h
+ * @ingroup requires_smr lock_free linearizable
+ * @brief Lock-free hashtable that grows by split-ordering a single listset.
+ *
+ * All entries are kept in one lock-free listset (see vsync/map/listset_lf.h)
+ * ordered by the bit-reversed hash of their keys. A bucket is a pointer to a
+ * dummy node in that list, and the entries of the bucket are the nodes that
+ * follow it. When the average bucket length exceeds
+ * `VHASHTABLE_SPLIT_LOAD_FACTOR` the number of buckets is doubled. Because of
+ * the bit-reversed order, the entries of a bucket are split between the bucket
+ * and its new sibling just by inserting the dummy node of the sibling. No node
+ * is ever moved.
+ *
+ * Buckets are initialized lazily by the first insert or remove that maps to
+ * them. The bucket directory is a fixed array of segments, segment `0` holds
+ * the first `min_buckets` buckets and segment `i > 0` the buckets
+ * `[min_buckets << (i - 1), min_buckets << i)`. Segments are allocated on
+ * demand with the given vmem_lib_t. The number of buckets never shrinks.
+ *
+ * Unlike vsync/map/hashtable_standard.h users do not pick the bucket, they pass
+ * the full hash of the key instead. Only the lower 63 bits of the hash are
+ * used. Detached entries are handed to the retire callback, which is expected
+ * to retire them to an SMR scheme.
+ *
+ * @note not compatible with `VLISTSET_NO_FUN_POINTER`.
+ *
+ * @example
+ * @include eg_hashtable_split.c
+ *
+ * @cite
+ * Ori Shalev, Nir Shavit - [Split-Ordered Lists: Lock-Free Extensible Hash
+ * Tables](https://dl.acm.org/doi/10.1145/1147954.1147958)
+ ******************************************************************************/
+#include <vsync/vtypes.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/common/compiler.h>
+#include <vsync/map/listset_lf.h>
+#include <vsync/utils/alloc.h>
+#include <vsync/utils/math.h>
+
+#if defined(VLISTSET_NO_FUN_POINTER)
+    #error "hashtable_split.h cannot be used with VLISTSET_NO_FUN_POINTER"
+#endif
+
+/**
+ * @def VHASHTABLE_SPLIT_LOAD_FACTOR
+ * @brief Average number of entries per bucket above which the number of
+ * buckets is doubled.
+ */
+#if !defined(VHASHTABLE_SPLIT_LOAD_FACTOR)
+    #define VHASHTABLE_SPLIT_LOAD_FACTOR 4U
+#endif
+
+/**
+ * @def VHASHTABLE_SPLIT_SEGMENT_COUNT
+ * @brief Number of segments of the bucket directory. The table can grow up to
+ * `min_buckets << (VHASHTABLE_SPLIT_SEGMENT_COUNT - 1)` buckets.
+ */
+#if !defined(VHASHTABLE_SPLIT_SEGMENT_COUNT)
+    #define VHASHTABLE_SPLIT_SEGMENT_COUNT 24U
+#endif
+
+typedef vlistset_key_t vhashtable_split_key_t;
+
+typedef struct vhashtable_split_entry_s {
+    vlistset_node_t lst_node;
+    vuint64_t so_key; /* split-order key, odd for entries, even for dummies */
+} vhashtable_split_entry_t;
+
+/**
+ * The function is expected to return
+ * 0 if container(entry)->key == key
+ * -1 if container(entry)->key < key
+ * 1 if container(entry)->key > key
+ */
+typedef int (*vhashtable_split_cmp_key_t)(vhashtable_split_entry_t *entry,
+                                          vhashtable_split_key_t key);
+/**
+ * Called on every entry detached from the hashtable, and on the remaining
+ * entries by `vhashtable_split_destroy`.
+ */
+typedef void (*vhashtable_split_entry_retire_t)(vhashtable_split_entry_t *entry,
+                                                void *arg);
+
+typedef struct vhashtable_split_bucket_s {
+    vatomicptr(vhashtable_split_entry_t *) dummy;
+} vhashtable_split_bucket_t;
+
+typedef struct vhashtable_split_s {
+    vlistset_t lst;
+    vatomicptr(vhashtable_split_bucket_t *)
+        segments[VHASHTABLE_SPLIT_SEGMENT_COUNT];
+    vatomicsz_t bucket_count;
+    vatomicsz_t num_entries;
+    vsize_t min_buckets;
+    vuint32_t min_buckets_log2;
+    vhashtable_split_cmp_key_t cmp_fun;
+    vhashtable_split_entry_retire_t retire_fun;
+    void *retire_fun_arg;
+    vmem_lib_t mem_lib;
+} vhashtable_split_t;
+
+/* the key passed down to the listset */
+typedef struct vhashtable_split_query_s {
+    vhashtable_split_t *table;
+    vhashtable_split_key_t key;
+    vuint64_t so_key;
+} vhashtable_split_query_t;
+
+static inline vlistset_node_t *
+_vhashtable_split_bucket_init(vhashtable_split_t *table, vsize_t bucket);
+static inline vhashtable_split_bucket_t *
+_vhashtable_split_bucket_get(vhashtable_split_t *table, vsize_t bucket,
+                             vbool_t alloc);
+static inline vuint64_t _vhashtable_split_reverse(vuint64_t v);
+static inline vuint32_t _vhashtable_split_log2(vsize_t v);
+static inline vsize_t _vhashtable_split_parent(vsize_t bucket);
+static inline int _vhashtable_split_cmp(vlistset_node_t *node,
+                                        vlistset_key_t key);
+static inline void _vhashtable_split_retire(vlistset_node_t *node, void *arg);
+static inline void _vhashtable_split_visit(vlistset_node_t *node, void *arg);
+
+/**
+ * Initializes the hashtable.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param min_buckets initial number of buckets, must be a power of two.
+ * @param retire_cb address of a callback function of type
+ * `vhashtable_split_entry_retire_t`. The function is called whenever an entry
+ * is detached from the hashtable.
+ * @param retire_cb_arg address of an extra argument of `retire_cb`.
+ * @param cmp_cb address of callback function of type
+ * `vhashtable_split_cmp_key_t`. Used for comparing an entry key to a given key.
+ * @param mem_lib object of type `vmem_lib_t` containing malloc/free functions
+ * used to allocate the bucket directory and the dummy nodes.
+ * @note must be called before threads start accessing the hashtable.
+ */
+static inline void
+vhashtable_split_init(vhashtable_split_t *table, vsize_t min_buckets,
+                      vhashtable_split_entry_retire_t retire_cb,
+                      void *retire_cb_arg, vhashtable_split_cmp_key_t cmp_cb,
+                      vmem_lib_t mem_lib)
+{
+    vhashtable_split_bucket_t *bucket = NULL;
+    vhashtable_split_entry_t *dummy   = NULL;
+
+    ASSERT(table);
+    ASSERT(retire_cb);
+    ASSERT(cmp_cb);
+    ASSERT(vmem_lib_not_null(&mem_lib));
+    ASSERT(V_IS_POWER_OF_TWO(min_buckets) &&
+           "min_buckets must be a power of two");
+
+    vlistset_init(&table->lst, _vhashtable_split_retire, table,
+                  _vhashtable_split_cmp);
+    for (vsize_t i = 0; i < VHASHTABLE_SPLIT_SEGMENT_COUNT; i++) {
+        vatomicptr_write_rlx(&table->segments[i], NULL);
+    }
+    vatomicsz_write_rlx(&table->bucket_count, min_buckets);
+    vatomicsz_write_rlx(&table->num_entries, 0);
+    table->min_buckets      = min_buckets;
+    table->min_buckets_log2 = _vhashtable_split_log2(min_buckets);
+    table->cmp_fun          = cmp_cb;
+    table->retire_fun       = retire_cb;
+    table->retire_fun_arg   = retire_cb_arg;
+    table->mem_lib          = mem_lib;
+
+    /* bucket 0 is the parent of all buckets and is initialized right away */
+    bucket = _vhashtable_split_bucket_get(table, 0, true);
+    dummy  = mem_lib.malloc_fun(sizeof(vhashtable_split_entry_t), mem_lib.arg);
+    ASSERT(dummy && "allocation of the dummy node failed");
+    dummy->so_key = 0;
+    vatomicptr_markable_set_rlx(&dummy->lst_node.next,
+                                &table->lst.tail_sentinel, false);
+    vatomicptr_markable_set_rlx(&table->lst.head_sentinel.next,
+                                &dummy->lst_node, false);
+    vatomicptr_write_rlx(&bucket->dummy, dummy);
+}
+/**
+ * Retires all entries in the hashtable and frees the internal memory.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @note this function is not thread-safe, can be called iff all threads are
+ * done accessing the hashtable.
+ */
+static inline void
+vhashtable_split_destroy(vhashtable_split_t *table)
+{
+    vhashtable_split_bucket_t *segment = NULL;
+
+    ASSERT(table);
+    _vlistset_visit(&table->lst, _vhashtable_split_visit, table, true);
+    for (vsize_t i = 0; i < VHASHTABLE_SPLIT_SEGMENT_COUNT; i++) {
+        segment = vatomicptr_read_rlx(&table->segments[i]);
+        if (segment) {
+            table->mem_lib.free_fun(segment, table->mem_lib.arg);
+        }
+    }
+}
+/**
+ * Inserts the given `entry` into the hashtable.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param key value of the key object.
+ * @param entry address of vhashtable_split_entry_t object.
+ * @param hash hash value of the key.
+ * @return true successful insertion.
+ * @return false failed insertion, an entry associated with the given `key`
+ * already exists.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vbool_t
+vhashtable_split_insert(vhashtable_split_t *table, vhashtable_split_key_t key,
+                        vhashtable_split_entry_t *entry, vuint64_t hash)
+{
+    vhashtable_split_query_t query;
+    vlistset_node_t *start = NULL;
+    vsize_t count          = 0;
+    vsize_t buckets        = 0;
+    vsize_t max_buckets    = 0;
+
+    ASSERT(table);
+    ASSERT(entry);
+    buckets       = vatomicsz_read(&table->bucket_count);
+    start         = _vhashtable_split_bucket_init(table, hash & (buckets - 1));
+    entry->so_key = _vhashtable_split_reverse(hash) | 1U;
+    query.table   = table;
+    query.key     = key;
+    query.so_key  = entry->so_key;
+    if (!_vlistset_add_from(&table->lst, start, (vlistset_key_t)&query,
+                            &entry->lst_node)) {
+        return false;
+    }
+    count       = vatomicsz_inc_get_rlx(&table->num_entries);
+    max_buckets = table->min_buckets << (VHASHTABLE_SPLIT_SEGMENT_COUNT - 1U);
+    if (count > buckets * VHASHTABLE_SPLIT_LOAD_FACTOR &&
+        buckets < max_buckets) {
+        /* only one of the threads that observed the same count doubles it */
+        (void)vatomicsz_cmpxchg(&table->bucket_count, buckets, buckets << 1U);
+    }
+    return true;
+}
+/**
+ * Looks for the entry associated with the given `key`.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param key value of the key object.
+ * @param hash hash value of the key.
+ * @return vhashtable_split_entry_t* address of the
+ * `vhashtable_split_entry_t` object associated with the given key, if found.
+ * @return `NULL` if key is not found.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vhashtable_split_entry_t *
+vhashtable_split_get(vhashtable_split_t *table, vhashtable_split_key_t key,
+                     vuint64_t hash)
+{
+    vhashtable_split_query_t query;
+    vhashtable_split_bucket_t *bucket = NULL;
+    vhashtable_split_entry_t *dummy   = NULL;
+    vlistset_node_t *node             = NULL;
+    vsize_t idx                       = 0;
+
+    ASSERT(table);
+    idx = hash & (vatomicsz_read(&table->bucket_count) - 1);
+    /* start at the closest initialized ancestor, lookups never initialize
+     * buckets */
+    while (true) {
+        bucket = _vhashtable_split_bucket_get(table, idx, false);
+        dummy  = bucket ? vatomicptr_read_acq(&bucket->dummy) : NULL;
+        if (dummy) {
+            break;
+        }
+        ASSERT(idx != 0);
+        idx = _vhashtable_split_parent(idx);
+    }
+    query.table  = table;
+    query.key    = key;
+    query.so_key = _vhashtable_split_reverse(hash) | 1U;
+    node = _vlistset_get_from(&table->lst, &dummy->lst_node,
+                              (vlistset_key_t)&query);
+    return node ? V_CONTAINER_OF(node, vhashtable_split_entry_t, lst_node) :
+                  NULL;
+}
+/**
+ * Removes the entry associated with the given key from the the hashtable.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param key value of the key object.
+ * @param hash hash value of the key.
+ * @return true successful remove, the entry associated with the given key was
+ * removed.
+ * @return false failed remove, no entry associated with the given key exists.
+ * @note this function must be called inside an SMR critical section.
+ */
+static inline vbool_t
+vhashtable_split_remove(vhashtable_split_t *table, vhashtable_split_key_t key,
+                        vuint64_t hash)
+{
+    vhashtable_split_query_t query;
+    vlistset_node_t *start = NULL;
+    vsize_t buckets        = 0;
+
+    ASSERT(table);
+    buckets      = vatomicsz_read(&table->bucket_count);
+    start        = _vhashtable_split_bucket_init(table, hash & (buckets - 1));
+    query.table  = table;
+    query.key    = key;
+    query.so_key = _vhashtable_split_reverse(hash) | 1U;
+    if (!_vlistset_remove_from(&table->lst, start, (vlistset_key_t)&query)) {
+        return false;
+    }
+    vatomicsz_dec_rlx(&table->num_entries);
+    return true;
+}
+/**
+ * Returns the count of entries currently available in the hashtable.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @return vsize_t an approximate count of the entries available in the
+ * hashtable.
+ */
+static inline vsize_t
+vhashtable_split_get_entries_count(vhashtable_split_t *table)
+{
+    ASSERT(table);
+    return vatomicsz_read_rlx(&table->num_entries);
+}
+/**
+ * Returns the current number of buckets.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @return vsize_t number of buckets, including the ones that are not yet
+ * initialized.
+ */
+static inline vsize_t
+vhashtable_split_get_bucket_count(vhashtable_split_t *table)
+{
+    ASSERT(table);
+    return vatomicsz_read_rlx(&table->bucket_count);
+}
+/**
+ * Returns the address of the given bucket in the directory.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param bucket index of the bucket.
+ * @param alloc true allocates the segment of the bucket if missing.
+ * @return vhashtable_split_bucket_t* address of the bucket.
+ * @return NULL if the segment of the bucket is missing and alloc is false.
+ */
+static inline vhashtable_split_bucket_t *
+_vhashtable_split_bucket_get(vhashtable_split_t *table, vsize_t bucket,
+                             vbool_t alloc)
+{
+    vhashtable_split_bucket_t *segment  = NULL;
+    vhashtable_split_bucket_t *existing = NULL;
+    vsize_t seg                         = 0;
+    vsize_t first                       = 0;
+    vsize_t len                         = table->min_buckets;
+
+    if (bucket >= table->min_buckets) {
+        seg   = _vhashtable_split_log2(bucket >> table->min_buckets_log2) + 1U;
+        first = table->min_buckets << (seg - 1U);
+        len   = first;
+    }
+    ASSERT(seg < VHASHTABLE_SPLIT_SEGMENT_COUNT);
+    segment = vatomicptr_read_acq(&table->segments[seg]);
+    if (segment == NULL) {
+        if (!alloc) {
+            return NULL;
+        }
+        segment = table->mem_lib.malloc_fun(
+            sizeof(vhashtable_split_bucket_t) * len, table->mem_lib.arg);
+        ASSERT(segment && "allocation of the segment failed");
+        for (vsize_t i = 0; i < len; i++) {
+            vatomicptr_write_rlx(&segment[i].dummy, NULL);
+        }
+        existing = vatomicptr_cmpxchg(&table->segments[seg], NULL, segment);
+        if (existing) {
+            /* another thread installed the segment first */
+            table->mem_lib.free_fun(segment, table->mem_lib.arg);
+            segment = existing;
+        }
+    }
+    return &segment[bucket - first];
+}
+/**
+ * Initializes the given bucket and its ancestors if needed.
+ *
+ * The dummy node of the bucket is inserted into the list starting from the
+ * dummy of the parent bucket, i.e., the bucket index with the most significant
+ * bit cleared.
+ *
+ * @param table address of vhashtable_split_t object.
+ * @param bucket index of the bucket.
+ * @return vlistset_node_t* address of the list node of the bucket dummy.
+ */
+static inline vlistset_node_t *
+_vhashtable_split_bucket_init(vhashtable_split_t *table, vsize_t bucket)
+{
+    vhashtable_split_query_t query;
+    vhashtable_split_bucket_t *slot  = NULL;
+    vhashtable_split_entry_t *dummy  = NULL;
+    vhashtable_split_entry_t *winner = NULL;
+    vlistset_node_t *parent          = NULL;
+    vlistset_node_t *node            = NULL;
+
+    slot  = _vhashtable_split_bucket_get(table, bucket, true);
+    dummy = vatomicptr_read_acq(&slot->dummy);
+    if (dummy) {
+        return &dummy->lst_node;
+    }
+    ASSERT(bucket != 0);
+    parent =
+        _vhashtable_split_bucket_init(table, _vhashtable_split_parent(bucket));
+
+    dummy = table->mem_lib.malloc_fun(sizeof(vhashtable_split_entry_t),
+                                      table->mem_lib.arg);
+    ASSERT(dummy && "allocation of the dummy node failed");
+    dummy->so_key = _vhashtable_split_reverse(bucket);
+    query.table   = table;
+    query.key     = 0;
+    query.so_key  = dummy->so_key;
+    if (!_vlistset_add_from(&table->lst, parent, (vlistset_key_t)&query,
+                            &dummy->lst_node)) {
+        /* another thread inserted the dummy, ours was never visible */
+        table->mem_lib.free_fun(dummy, table->mem_lib.arg);
+        node = _vlistset_get_from(&table->lst, parent, (vlistset_key_t)&query);
+        ASSERT(node && "dummy nodes are never removed");
+        dummy = V_CONTAINER_OF(node, vhashtable_split_entry_t, lst_node);
+    }
+    winner = vatomicptr_cmpxchg(&slot->dummy, NULL, dummy);
+    ASSERT(winner == NULL || winner == dummy);
+    V_UNUSED(winner);
+    return &dummy->lst_node;
+}
+/**
+ * Reverses the bits of the given value.
+ *
+ * @param v value to reverse.
+ * @return vuint64_t v with reversed bits.
+ */
+static inline vuint64_t
+_vhashtable_split_reverse(vuint64_t v)
+{
+    v = ((v >> 1U) & 0x5555555555555555ULL) |
+        ((v & 0x5555555555555555ULL) << 1U);
+    v = ((v >> 2U) & 0x3333333333333333ULL) |
+        ((v & 0x3333333333333333ULL) << 2U);
+    v = ((v >> 4U) & 0x0F0F0F0F0F0F0F0FULL) |
+        ((v & 0x0F0F0F0F0F0F0F0FULL) << 4U);
+    v = ((v >> 8U) & 0x00FF00FF00FF00FFULL) |
+        ((v & 0x00FF00FF00FF00FFULL) << 8U);
+    v = ((v >> 16U) & 0x0000FFFF0000FFFFULL) |
+        ((v & 0x0000FFFF0000FFFFULL) << 16U);
+    return (v >> 32U) | (v << 32U);
+}
+/**
+ * Returns the index of the most significant set bit.
+ *
+ * @param v non-zero value.
+ * @return vuint32_t floor(log2(v)).
+ */
+static inline vuint32_t
+_vhashtable_split_log2(vsize_t v)
+{
+    ASSERT(v != 0);
+    return (vuint32_t)(63 - __builtin_clzll((unsigned long long)v));
+}
+/**
+ * Returns the parent of the given bucket, i.e., the bucket index with the
+ * most significant bit cleared.
+ *
+ * @param bucket non-zero bucket index.
+ * @return vsize_t index of the parent bucket.
+ */
+static inline vsize_t
+_vhashtable_split_parent(vsize_t bucket)
+{
+    return bucket & ~((vsize_t)1 << _vhashtable_split_log2(bucket));
+}
+/**
+ * Compares the given list node with the given query.
+ *
+ * Nodes are ordered by split-order key first. Entries with the same
+ * split-order key are ordered by the user compare callback.
+ *
+ * @param node address of vlistset_node_t object.
+ * @param key address of vhashtable_split_query_t object.
+ * @return int -1, 0 or 1 if node is smaller, equal or greater than the query.
+ */
+static inline int
+_vhashtable_split_cmp(vlistset_node_t *node, vlistset_key_t key)
+{
+    vhashtable_split_query_t *query = (vhashtable_split_query_t *)key;
+    vhashtable_split_entry_t *entry =
+        V_CONTAINER_OF(node, vhashtable_split_entry_t, lst_node);
+
+    if (entry->so_key < query->so_key) {
+        return -1;
+    } else if (entry->so_key > query->so_key) {
+        return 1;
+    } else if ((entry->so_key & 1U) == 0) {
+        /* dummy nodes have unique split-order keys */
+        return 0;
+    }
+    return query->table->cmp_fun(entry, query->key);
+}
+/**
+ * Forwards the detached entries to the user retire callback.
+ *
+ * @param node address of the detached vlistset_node_t object.
+ * @param arg address of vhashtable_split_t object.
+ */
+static inline void
+_vhashtable_split_retire(vlistset_node_t *node, void *arg)
+{
+    vhashtable_split_t *table = (vhashtable_split_t *)arg;
+    vhashtable_split_entry_t *entry =
+        V_CONTAINER_OF(node, vhashtable_split_entry_t, lst_node);
+
+    ASSERT((entry->so_key & 1U) && "dummy nodes are never removed");
+    table->retire_fun(entry, table->retire_fun_arg);
+}
+/**
+ * Frees the dummy nodes and retires the entries on destruction.
+ *
+ * @param node address of vlistset_node_t object.
+ * @param arg address of vhashtable_split_t object.
+ */
+static inline void
+_vhashtable_split_visit(vlistset_node_t *node, void *arg)
+{
+    vhashtable_split_t *table = (vhashtable_split_t *)arg;
+    vhashtable_split_entry_t *entry =
+        V_CONTAINER_OF(node, vhashtable_split_entry_t, lst_node);
+
+    if (entry->so_key & 1U) {
+        table->retire_fun(entry, table->retire_fun_arg);
+    } else {
+        table->mem_lib.free_fun(entry, table->mem_lib.arg);
+    }
+}
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2024. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -26,6 +26,8 @@
  * needs. listset_lf.h and listset_lazy.h can provide performance benefits under
  * high contention and oversubscription scenarios. If memory overhead is not an
  * issue and the buckets can grow long then skiplist_lf.h can be a better fit.
+ * If the number of entries is not known in advance, vsync/map/hashtable_split.h
+ * grows its number of buckets with the number of entries.
  *
  * @example
  * @include eg_hashtable_standard.c
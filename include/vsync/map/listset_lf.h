@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2024. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -47,9 +47,19 @@ typedef struct vlistset_s {
     vlistset_cmp_key_t cmp_fun;
 } vlistset_t;
 
-static inline vbool_t _vlistset_find(vlistset_t *lst, vlistset_key_t key,
+static inline vbool_t _vlistset_find(vlistset_t *lst, vlistset_node_t *start,
+                                     vlistset_key_t key,
                                      vlistset_node_t **out_pred,
                                      vlistset_node_t **out_curr);
+static inline vbool_t _vlistset_add_from(vlistset_t *lst,
+                                         vlistset_node_t *start,
+                                         vlistset_key_t key,
+                                         vlistset_node_t *node);
+static inline vbool_t _vlistset_remove_from(vlistset_t *lst,
+                                            vlistset_node_t *start,
+                                            vlistset_key_t key);
+static inline vlistset_node_t *
+_vlistset_get_from(vlistset_t *lst, vlistset_node_t *start, vlistset_key_t key);
 
 /**
  * Initializes the given vlistset_t object `lst`.
@@ -108,6 +118,58 @@ vlistset_destroy(vlistset_t *lst)
  */
 static inline vbool_t
 vlistset_add(vlistset_t *lst, vlistset_key_t key, vlistset_node_t *node)
+{
+    ASSERT(lst);
+    return _vlistset_add_from(lst, &lst->head_sentinel, key, node);
+}
+/**
+ * Removes the node associated with the given key from the listset.
+ *
+ * @note the registered retire callback will be called on the removed node.
+ * @param lst address of vlistset_t object.
+ * @param key the key identifying the node to remove.
+ * @return true the node associated with the given key was removed successfully.
+ * @return false could not find a node holding the given key to remove.
+ * @note must be called inside SMR critical section.
+ */
+static inline vbool_t
+vlistset_remove(vlistset_t *lst, vlistset_key_t key)
+{
+    ASSERT(lst);
+    return _vlistset_remove_from(lst, &lst->head_sentinel, key);
+}
+/**
+ * Looks for the listset node associated with the given key.
+ *
+ * @param lst address of vlistset_t object.
+ * @param key key value.
+ * @return vlistset_node_t* address of the listset node associated with the
+ * given key.
+ * @return NULL if no node associated with the given key was found.
+ * @note must be called inside SMR critical section.
+ */
+static inline vlistset_node_t *
+vlistset_get(vlistset_t *lst, vlistset_key_t key)
+{
+    ASSERT(lst);
+    return _vlistset_get_from(lst, &lst->head_sentinel, key);
+}
+/**
+ * Inserts the given node into the listset, starting the search at `start`.
+ *
+ * @param lst address of vlistset_t object.
+ * @param start address of a node that is never removed and precedes the
+ * position of key, e.g., the head sentinel.
+ * @param key the key value that is used to identify the node.
+ * @param node address of vlistset_node_t object.
+ * @return true operation succeeded, the given node has been added.
+ * @return false operation failed, there exists another node associated with
+ * the given key.
+ * @note must be called inside SMR critical section.
+ */
+static inline vbool_t
+_vlistset_add_from(vlistset_t *lst, vlistset_node_t *start, vlistset_key_t key,
+                   vlistset_node_t *node)
 {
     vlistset_node_t *pred     = NULL;
     vlistset_node_t *curr     = NULL;
@@ -118,7 +180,7 @@ vlistset_add(vlistset_t *lst, vlistset_key_t key, vlistset_node_t *node)
     ASSERT(node);
     tail = &lst->tail_sentinel;
     while (true) {
-        find_modified_mem = _vlistset_find(lst, key, &pred, &curr);
+        find_modified_mem = _vlistset_find(lst, start, key, &pred, &curr);
 
         if (tail != curr && VLISTSET_CMP(lst, curr, key) == 0) {
             return false;
@@ -140,17 +202,20 @@ vlistset_add(vlistset_t *lst, vlistset_key_t key, vlistset_node_t *node)
     }     // while
 }
 /**
- * Removes the node associated with the given key from the listset.
+ * Removes the node associated with the given key from the listset, starting
+ * the search at `start`.
  *
- * @note the registered retire callback will be called on the removed node.
  * @param lst address of vlistset_t object.
+ * @param start address of a node that is never removed and precedes the
+ * position of key, e.g., the head sentinel.
  * @param key the key identifying the node to remove.
  * @return true the node associated with the given key was removed successfully.
  * @return false could not find a node holding the given key to remove.
  * @note must be called inside SMR critical section.
  */
 static inline vbool_t
-vlistset_remove(vlistset_t *lst, vlistset_key_t key)
+_vlistset_remove_from(vlistset_t *lst, vlistset_node_t *start,
+                      vlistset_key_t key)
 {
     vlistset_node_t *pred     = NULL;
     vlistset_node_t *curr     = NULL;
@@ -163,7 +228,7 @@ vlistset_remove(vlistset_t *lst, vlistset_key_t key)
     ASSERT(lst);
     tail = &lst->tail_sentinel;
     while (true) {
-        find_modified_mem = _vlistset_find(lst, key, &pred, &curr);
+        find_modified_mem = _vlistset_find(lst, start, key, &pred, &curr);
         if (tail == curr || VLISTSET_CMP(lst, curr, key) != 0) {
             // key does not exit, fail.
             return false;
@@ -200,9 +265,12 @@ vlistset_remove(vlistset_t *lst, vlistset_key_t key)
     } // while
 }
 /**
- * Looks for the listset node associated with the given key.
+ * Looks for the listset node associated with the given key, starting the
+ * search at `start`.
  *
  * @param lst address of vlistset_t object.
+ * @param start address of a node that is never removed and precedes the
+ * position of key, e.g., the head sentinel.
  * @param key key value.
  * @return vlistset_node_t* address of the listset node associated with the
  * given key.
@@ -210,7 +278,7 @@ vlistset_remove(vlistset_t *lst, vlistset_key_t key)
  * @note must be called inside SMR critical section.
  */
 static inline vlistset_node_t *
-vlistset_get(vlistset_t *lst, vlistset_key_t key)
+_vlistset_get_from(vlistset_t *lst, vlistset_node_t *start, vlistset_key_t key)
 {
     vlistset_node_t *curr = NULL;
     vlistset_node_t *tail = NULL;
@@ -219,7 +287,7 @@ vlistset_get(vlistset_t *lst, vlistset_key_t key)
 
     ASSERT(lst);
     tail = &lst->tail_sentinel;
-    curr = vatomicptr_markable_get_pointer(&lst->head_sentinel.next);
+    curr = vatomicptr_markable_get_pointer(&start->next);
 
     while (tail != curr && VLISTSET_CMP(lst, curr, key) < 0) {
         curr = vatomicptr_markable_get_pointer(&curr->next);
@@ -273,6 +341,7 @@ _vlistset_visit(vlistset_t *lst, vlistset_handle_node_t visitor, void *arg,
  * key `key`. All marked nodes on the search path will be physically detached.
  *
  * @param lst address of vlistset_t object.
+ * @param start address of the node where the traversal starts.
  * @param key key value.
  * @param out_pred output parameter (`*out_pred->next = *out_curr`).
  * @param out_curr output parameter with (`*out_curr->key >= key`).
@@ -285,9 +354,9 @@ _vlistset_visit(vlistset_t *lst, vlistset_handle_node_t visitor, void *arg,
  * changed.
  */
 static inline vbool_t
-_vlistset_find_loop(vlistset_t *lst, vlistset_key_t key,
-                    vlistset_node_t **out_pred, vlistset_node_t **out_curr,
-                    vbool_t *out_snipped)
+_vlistset_find_loop(vlistset_t *lst, vlistset_node_t *start,
+                    vlistset_key_t key, vlistset_node_t **out_pred,
+                    vlistset_node_t **out_curr, vbool_t *out_snipped)
 {
     vlistset_node_t *pred = NULL;
     vlistset_node_t *curr = NULL;
@@ -297,7 +366,7 @@ _vlistset_find_loop(vlistset_t *lst, vlistset_key_t key,
     vbool_t snip          = false;
 
     tail = &lst->tail_sentinel;
-    pred = &lst->head_sentinel;
+    pred = start;
     curr = vatomicptr_markable_get_pointer(&pred->next);
 
     while (curr != tail) {
@@ -348,6 +417,7 @@ _vlistset_find_loop(vlistset_t *lst, vlistset_key_t key,
  * key `key`. All marked nodes on the search path will be physically detached.
  *
  * @param lst address of vlistset_t object.
+ * @param start address of the node where the traversal starts.
  * @param key key value.
  * @param out_pred output parameter (`*out_pred->next = *out_curr`).
  * @param out_curr output parameter with (`*out_curr->key >= key`).
@@ -355,11 +425,12 @@ _vlistset_find_loop(vlistset_t *lst, vlistset_key_t key,
  * @return false did not modify anything.
  */
 static inline vbool_t
-_vlistset_find(vlistset_t *lst, vlistset_key_t key, vlistset_node_t **out_pred,
-               vlistset_node_t **out_curr)
+_vlistset_find(vlistset_t *lst, vlistset_node_t *start, vlistset_key_t key,
+               vlistset_node_t **out_pred, vlistset_node_t **out_curr)
 {
     vbool_t ever_snipped = false;
-    while (_vlistset_find_loop(lst, key, out_pred, out_curr, &ever_snipped)) {}
+    while (_vlistset_find_loop(lst, start, key, out_pred, out_curr,
+                               &ever_snipped)) {}
     return ever_snipped;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2024. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2024-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -22,6 +22,24 @@
  * `-DVSIMPLEHT_DISABLE_REMOVE`. Or keep it, and make sure remove is rarely
  * called.
  *
+ * If removes are frequent, compile with `-DVSIMPLEHT_REMOVE_LF`. In this mode
+ * there is no rebalancing and no lock. Every slot carries a versioned state and
+ * every home slot the bound of its probe sequence, as in the second reference.
+ * A removed slot becomes empty right away and can be reused by any key, and
+ * the probe bound of its home slot is lowered if the slot was the last one in
+ * the sequence. All operations are lock-free. Note that in this mode the
+ * destroy callback is called on the removed value while other threads might
+ * still access it, i.e., it should retire the value to an SMR scheme rather
+ * than free it.
+ *
+ * Lookups of absent keys have to walk the whole probe sequence. Compile with
+ * `-DVSIMPLEHT_METADATA` to keep a one-byte fingerprint of the hash of every
+ * slot in a separate array. Probes then scan the fingerprints, a group of
+ * 16 or 32 slots at a time with vector compares if SSE2, AVX2 or NEON
+ * (AArch64) is available and one slot at a time otherwise, and only read the
+ * slots whose fingerprint matches. This mode cannot be combined with
+ * `VSIMPLEHT_REMOVE_LF`.
+ *
  * # Operating Conditions
  *
  * The hashtable is supposed to keep gaps for optimal performance. Users
@@ -43,16 +61,56 @@
  * [The World's Simplest Lock-Free Hash Table]
  * (https://preshing.com/20130605/the-worlds-simplest-lock-free-hash-table/)
  *
+ * @cite
+ * Chris Purcell, Tim Harris - Non-blocking Hashtables with Open Addressing
+ *
  *****************************************************************************/
 #include <vsync/atomic.h>
 #include <vsync/common/dbg.h>
 #include <vsync/common/assert.h>
+#include <vsync/common/compiler.h>
+#include <vsync/utils/math.h>
 /**
  * @def VSIMPLEHT_DISABLE_REMOVE
  * @brief defines VSIMPLEHT_DISABLE_REMOVE to use the simple hashtable without
  * entry removal support. This makes the insert and get operations faster
  */
-#if !defined(VSIMPLEHT_DISABLE_REMOVE)
+/**
+ * @def VSIMPLEHT_REMOVE_LF
+ * @brief defines VSIMPLEHT_REMOVE_LF to support lock-free removal. Removed
+ * slots are reclaimed immediately instead of rebalancing the table under a
+ * lock. Has no effect if VSIMPLEHT_DISABLE_REMOVE is defined.
+ */
+#if defined(VSIMPLEHT_DISABLE_REMOVE) && defined(VSIMPLEHT_REMOVE_LF)
+    #undef VSIMPLEHT_REMOVE_LF
+#endif
+
+/**
+ * @def VSIMPLEHT_METADATA
+ * @brief defines VSIMPLEHT_METADATA to keep the fingerprints of the slots in a
+ * separate byte array, which is scanned by lookups and insertions before the
+ * slots themselves. Has no effect if VSIMPLEHT_REMOVE_LF is defined.
+ */
+#if defined(VSIMPLEHT_REMOVE_LF) && defined(VSIMPLEHT_METADATA)
+    #undef VSIMPLEHT_METADATA
+#endif
+
+/* number of fingerprints compared at once, undefined if there is no vector
+ * support, in which case the fingerprints are compared one by one */
+#if defined(VSIMPLEHT_METADATA) && !defined(VSYNC_VERIFICATION)
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+        #define V_SIMPLEHT_GROUP_SIZE 32U
+    #elif defined(__SSE2__)
+        #include <emmintrin.h>
+        #define V_SIMPLEHT_GROUP_SIZE 16U
+    #elif defined(__ARM_NEON) && defined(__aarch64__)
+        #include <arm_neon.h>
+        #define V_SIMPLEHT_GROUP_SIZE 16U
+    #endif
+#endif
+
+#if !defined(VSIMPLEHT_DISABLE_REMOVE) && !defined(VSIMPLEHT_REMOVE_LF)
     #if defined(VSYNC_VERIFICATION)
         #include <verify/rwlock.h>
     #else
@@ -71,6 +129,15 @@
     #define VSIMPLEHT_RELATIVE_THRESHOLD 4U
 #endif
 
+/**
+ * @def VSIMPLEHT_BATCH_SIZE
+ * @brief Number of keys whose slots are prefetched together by the batch
+ * operations, e.g., `vsimpleht_get_batch`.
+ */
+#if !defined(VSIMPLEHT_BATCH_SIZE)
+    #define VSIMPLEHT_BATCH_SIZE 16U
+#endif
+
 typedef vint8_t (*vsimpleht_cmp_key_t)(vuintptr_t key_a, vuintptr_t key_b);
 typedef vuint64_t (*vsimpleht_hash_key_t)(vuintptr_t key);
 typedef void (*vsimpleht_destroy_entry_t)(void *entry);
@@ -78,15 +145,22 @@ typedef void (*vsimpleht_destroy_entry_t)(void *entry);
 typedef struct vsimpleht_entry_s {
     vatomicptr(vuintptr_t) key;
     vatomicptr(void *) value;
+#if defined(VSIMPLEHT_REMOVE_LF)
+    vatomic32_t state; /* version and state of the slot */
+    vatomic32_t bound; /* probe bound of the keys whose home is this slot */
+#endif
 } vsimpleht_entry_t;
 
 typedef struct vsimpleht_s {
     vsize_t capacity;
     vsimpleht_entry_t *entries;
+#if defined(VSIMPLEHT_METADATA)
+    vatomic8_t *meta; /* fingerprints of the slots, 0 if the slot is empty */
+#endif
     vsimpleht_cmp_key_t cmp_key;
     vsimpleht_hash_key_t hash_key;
     vsimpleht_destroy_entry_t cb_destroy;
-#if !defined(VSIMPLEHT_DISABLE_REMOVE)
+#if !defined(VSIMPLEHT_DISABLE_REMOVE) && !defined(VSIMPLEHT_REMOVE_LF)
     vsize_t cleaning_threshold;
     vatomicsz_t deleted_count;
     rwlock_t lock;
@@ -112,6 +186,30 @@ static inline void _vsimpleht_trigger_cleanup(vsimpleht_t *tbl, void *val);
 static inline void _vsimpleht_give_cleanup_a_chance(vsimpleht_t *tbl);
 static inline vsimpleht_ret_t _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key,
                                              void *value);
+static inline vsimpleht_ret_t _vsimpleht_add_at(vsimpleht_t *tbl,
+                                                vuintptr_t key, void *value,
+                                                vuint64_t hash);
+static inline void *_vsimpleht_get_at(vsimpleht_t *tbl, vuintptr_t key,
+                                      vuint64_t hash);
+static inline vsize_t _vsimpleht_index(vsimpleht_t *tbl, vuint64_t hash);
+static inline vsize_t _vsimpleht_home(vsimpleht_t *tbl, vuintptr_t key);
+#if defined(VSIMPLEHT_METADATA)
+static inline vsimpleht_ret_t _vsimpleht_meta_add(vsimpleht_t *tbl,
+                                                  vuintptr_t key, void *value,
+                                                  vuint64_t hash);
+static inline void *_vsimpleht_meta_get(vsimpleht_t *tbl, vuintptr_t key,
+                                        vuint64_t hash);
+#endif
+#if defined(VSIMPLEHT_REMOVE_LF)
+static inline vsimpleht_ret_t
+_vsimpleht_lf_add(vsimpleht_t *tbl, vuintptr_t key, void *value, vsize_t h);
+static inline void *_vsimpleht_lf_get(vsimpleht_t *tbl, vuintptr_t key,
+                                      vsize_t h);
+static inline vsimpleht_ret_t _vsimpleht_lf_remove(vsimpleht_t *tbl,
+                                                   vuintptr_t key);
+static inline vbool_t _vsimpleht_lf_read_member(vsimpleht_entry_t *entry,
+                                                vuintptr_t *key, void **val);
+#endif
 
 /**
  * Calculates the size of the buffer needed by the hashtable.
@@ -121,13 +219,19 @@ static inline vsimpleht_ret_t _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key,
  * @return vsize_t required buffer size to fit `len` items.
  *
  * @note capacity must be power of two.
+ * @note with VSIMPLEHT_METADATA the buffer holds a fingerprint byte per slot
+ * in addition to the slots.
  */
 static inline vsize_t
 vsimpleht_buff_size(vsize_t capacity)
 {
     ASSERT(capacity > 0);
     ASSERT((capacity & (capacity - 1)) == 0 && "capacity must be power of 2");
+#if defined(VSIMPLEHT_METADATA)
+    return (sizeof(vsimpleht_entry_t) + sizeof(vatomic8_t)) * capacity;
+#else
     return sizeof(vsimpleht_entry_t) * capacity;
+#endif
 }
 /**
  * Initializes the hashtable.
@@ -161,8 +265,21 @@ vsimpleht_init(vsimpleht_t *tbl, void *buff, vsize_t capacity,
     for (vsize_t i = 0; i < tbl->capacity; i++) {
         vatomicptr_init(&tbl->entries[i].key, NULL);
         vatomicptr_init(&tbl->entries[i].value, NULL);
+#if defined(VSIMPLEHT_REMOVE_LF)
+        vatomic32_init(&tbl->entries[i].state, 0);
+        vatomic32_init(&tbl->entries[i].bound, 0);
+#endif
     }
-#if !defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_METADATA)
+    /* the fingerprints are placed after the slots */
+    tbl->meta = (vatomic8_t *)&tbl->entries[capacity];
+    for (vsize_t i = 0; i < tbl->capacity; i++) {
+        vatomic8_init(&tbl->meta[i], 0);
+    }
+#endif
+#if defined(VSIMPLEHT_REMOVE_LF)
+    ASSERT(capacity <= (VUINT32_MAX >> 1U) && "capacity is too big");
+#elif !defined(VSIMPLEHT_DISABLE_REMOVE)
     tbl->cleaning_threshold = (capacity / VSIMPLEHT_RELATIVE_THRESHOLD);
     vatomicsz_write_rlx(&tbl->deleted_count, 0);
     rwlock_init(&tbl->lock);
@@ -182,7 +299,14 @@ vsimpleht_destroy(vsimpleht_t *tbl)
     ASSERT(tbl);
     for (vsize_t i = 0; i < tbl->capacity; i++) {
         entry = &tbl->entries[i];
-        obj   = vatomicptr_read_rlx(&entry->value);
+#if defined(VSIMPLEHT_REMOVE_LF)
+        vuintptr_t key = 0;
+        if (!_vsimpleht_lf_read_member(entry, &key, &obj)) {
+            continue;
+        }
+#else
+        obj = vatomicptr_read_rlx(&entry->value);
+#endif
         if (obj) {
             tbl->cb_destroy(obj);
         }
@@ -199,7 +323,7 @@ vsimpleht_destroy(vsimpleht_t *tbl)
 static inline void
 vsimpleht_thread_register(vsimpleht_t *tbl)
 {
-#if defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_DISABLE_REMOVE) || defined(VSIMPLEHT_REMOVE_LF)
     V_UNUSED(tbl);
 #else
     rwlock_read_acquire(&tbl->lock);
@@ -216,7 +340,7 @@ vsimpleht_thread_register(vsimpleht_t *tbl)
 static inline void
 vsimpleht_thread_deregister(vsimpleht_t *tbl)
 {
-#if defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_DISABLE_REMOVE) || defined(VSIMPLEHT_REMOVE_LF)
     V_UNUSED(tbl);
 #else
     rwlock_read_release(&tbl->lock);
@@ -242,8 +366,12 @@ vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
 {
     ASSERT(key != 0);
     ASSERT(value != NULL);
+#if defined(VSIMPLEHT_REMOVE_LF)
+    return _vsimpleht_lf_add(tbl, key, value, _vsimpleht_home(tbl, key));
+#else
     _vsimpleht_give_cleanup_a_chance(tbl);
     return _vsimpleht_add(tbl, key, value);
+#endif
 }
 /**
  * Searches the hashtable for a value associated with the given key.
@@ -256,19 +384,106 @@ vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
 static inline void *
 vsimpleht_get(vsimpleht_t *tbl, vuintptr_t key)
 {
-    vsize_t index         = 0;
-    vuintptr_t probed_key = 0;
     _vsimpleht_give_cleanup_a_chance(tbl);
-    for (index = tbl->hash_key(key);; index++) {
-        index &= tbl->capacity - 1;
-        ASSERT(index < tbl->capacity);
-        probed_key = (vuintptr_t)vatomicptr_read(&tbl->entries[index].key);
-        if (probed_key == 0) {
-            return NULL;
-        } else if (tbl->cmp_key(key, probed_key) == 0) {
-            return vatomicptr_read_acq(&tbl->entries[index].value);
+    return _vsimpleht_get_at(tbl, key, tbl->hash_key(key));
+}
+/**
+ * Searches the hashtable for the values associated with the given keys.
+ *
+ * Hashes the keys and prefetches their slots before probing, such that the
+ * cache misses of different keys overlap.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param keys array of `count` keys to search for.
+ * @param values output array of `count` entries. `values[i]` is set to the
+ * address of the object associated with `keys[i]`, or NULL if there is none.
+ * @param count number of keys.
+ */
+static inline void
+vsimpleht_get_batch(vsimpleht_t *tbl, const vuintptr_t *keys, void **values,
+                    vsize_t count)
+{
+    vuint64_t hash[VSIMPLEHT_BATCH_SIZE];
+    vsize_t len = 0;
+
+    ASSERT(tbl);
+    ASSERT(keys || count == 0);
+    ASSERT(values || count == 0);
+
+    for (vsize_t i = 0; i < count; i += len) {
+        len = VMIN(count - i, (vsize_t)VSIMPLEHT_BATCH_SIZE);
+        for (vsize_t j = 0; j < len; j++) {
+            hash[j] = tbl->hash_key(keys[i + j]);
+#if defined(VSIMPLEHT_METADATA)
+            /* the slot is only read if the fingerprint matches */
+            V_PREFETCH(&tbl->meta[_vsimpleht_index(tbl, hash[j])]);
+#else
+            V_PREFETCH(&tbl->entries[_vsimpleht_index(tbl, hash[j])]);
+#endif
+        }
+        for (vsize_t j = 0; j < len; j++) {
+            /* as often as `count` single gets would */
+            _vsimpleht_give_cleanup_a_chance(tbl);
+            values[i + j] = _vsimpleht_get_at(tbl, keys[i + j], hash[j]);
+        }
+    }
+}
+/**
+ * Inserts the given values into the hashtable.
+ *
+ * Hashes the keys and prefetches their slots before probing, such that the
+ * cache misses of different keys overlap.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param keys array of `count` keys of the values to add.
+ * @param values array of `count` addresses of the objects to insert.
+ * @param rets output array of `count` entries. `rets[i]` is set to the result
+ * of inserting `values[i]`, see `vsimpleht_add`.
+ * @param count number of values.
+ * @return vsize_t number of values that were added.
+ *
+ * @note neither key can be 0 nor value can be NULL.
+ */
+static inline vsize_t
+vsimpleht_add_batch(vsimpleht_t *tbl, const vuintptr_t *keys,
+                    void *const *values, vsimpleht_ret_t *rets, vsize_t count)
+{
+    vuint64_t hash[VSIMPLEHT_BATCH_SIZE];
+    vsize_t len   = 0;
+    vsize_t added = 0;
+
+    ASSERT(tbl);
+    ASSERT(keys || count == 0);
+    ASSERT(values || count == 0);
+    ASSERT(rets || count == 0);
+
+    for (vsize_t i = 0; i < count; i += len) {
+        len = VMIN(count - i, (vsize_t)VSIMPLEHT_BATCH_SIZE);
+        for (vsize_t j = 0; j < len; j++) {
+            ASSERT(keys[i + j] != 0);
+            ASSERT(values[i + j] != NULL);
+            hash[j] = tbl->hash_key(keys[i + j]);
+#if defined(VSIMPLEHT_METADATA)
+            V_PREFETCH_W(&tbl->meta[_vsimpleht_index(tbl, hash[j])]);
+#endif
+            V_PREFETCH_W(&tbl->entries[_vsimpleht_index(tbl, hash[j])]);
+        }
+        for (vsize_t j = 0; j < len; j++) {
+#if defined(VSIMPLEHT_REMOVE_LF)
+            rets[i + j] = _vsimpleht_lf_add(tbl, keys[i + j], values[i + j],
+                                            _vsimpleht_index(tbl, hash[j]));
+#else
+            /* as often as `count` single adds would */
+            _vsimpleht_give_cleanup_a_chance(tbl);
+            rets[i + j] =
+                _vsimpleht_add_at(tbl, keys[i + j], values[i + j], hash[j]);
+#endif
+            if (rets[i + j] == VSIMPLEHT_RET_OK) {
+                added++;
+            }
         }
     }
+    return added;
 }
 /**
  * Initializes the given iterator object `iter` for operating `tbl` object.
@@ -326,8 +541,14 @@ vsimpleht_iter_next(vsimpleht_iter_t *iter, vuintptr_t *key, void **val)
     entries = iter->tbl->entries;
     ASSERT(entries);
     for (vsize_t i = iter->idx; i < iter->tbl->capacity; i++) {
+#if defined(VSIMPLEHT_REMOVE_LF)
+        if (!_vsimpleht_lf_read_member(&entries[i], &k, &v)) {
+            continue;
+        }
+#else
         k = (vuintptr_t)vatomicptr_read(&entries[i].key);
         v = vatomicptr_read(&entries[i].value);
+#endif
         if (k && v) {
             iter->idx = i + 1;
             *key      = k;
@@ -349,6 +570,8 @@ vsimpleht_iter_next(vsimpleht_iter_t *iter, vuintptr_t *key, void **val)
  * can be super-slow, and the associated value can be freed via the destroy
  * callback registered at `vsimpleht_init`.
  *
+ * @note with VSIMPLEHT_REMOVE_LF this operation is lock-free, and the destroy
+ * callback is called while other threads might still access the value.
  */
 static inline vsimpleht_ret_t
 vsimpleht_remove(vsimpleht_t *tbl, vuintptr_t key)
@@ -359,6 +582,8 @@ vsimpleht_remove(vsimpleht_t *tbl, vuintptr_t key)
            "defined.");
     V_UNUSED(tbl, key);
     return VSIMPLEHT_RET_KEY_DNE;
+#elif defined(VSIMPLEHT_REMOVE_LF)
+    return _vsimpleht_lf_remove(tbl, key);
 #else
     vsize_t index         = 0;
     vuintptr_t probed_key = 0;
@@ -415,6 +640,25 @@ vsimpleht_remove(vsimpleht_t *tbl, vuintptr_t key)
 static inline vsimpleht_ret_t
 _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
 {
+    return _vsimpleht_add_at(tbl, key, value, tbl->hash_key(key));
+}
+/**
+ * Inserts the given value into the hashtable.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @param hash hash of key.
+ * @return VSIMPLEHT_RET_OK key does not exist, value was added.
+ * @return VSIMPLEHT_RET_KEY_EXISTS key exists, value was not added.
+ * @return VSIMPLEHT_RET_TBL_FULL table is full.
+ */
+static inline vsimpleht_ret_t
+_vsimpleht_add_at(vsimpleht_t *tbl, vuintptr_t key, void *value, vuint64_t hash)
+{
+#if defined(VSIMPLEHT_METADATA)
+    return _vsimpleht_meta_add(tbl, key, value, hash);
+#else
     vsize_t index         = 0;
     vuintptr_t probed_key = 0;
     void *val             = NULL;
@@ -425,7 +669,8 @@ _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
     // linear search at an index determined by hashing the key.
     // scan the array and store the item in the first entry whose
     // existing key is either 0, or matches the desired key
-    for (index = tbl->hash_key(key); cnt < tbl->capacity; cnt++, index++) {
+    for (index = _vsimpleht_index(tbl, hash); cnt < tbl->capacity;
+         cnt++, index++) {
         // keep the index within the array boundaries
         index &= tbl->capacity - 1;
         ASSERT(index < tbl->capacity);
@@ -466,6 +711,62 @@ _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
         return (val == NULL) ? VSIMPLEHT_RET_OK : VSIMPLEHT_RET_KEY_EXISTS;
     }
     return VSIMPLEHT_RET_TBL_FULL;
+#endif
+}
+/**
+ * Searches the hashtable for the given key.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key to search for.
+ * @param hash hash of key.
+ * @return void* address of the object associated with the given key if exists.
+ * @return NULL if there is no value found associated with given key.
+ */
+static inline void *
+_vsimpleht_get_at(vsimpleht_t *tbl, vuintptr_t key, vuint64_t hash)
+{
+#if defined(VSIMPLEHT_REMOVE_LF)
+    return _vsimpleht_lf_get(tbl, key, _vsimpleht_index(tbl, hash));
+#elif defined(VSIMPLEHT_METADATA)
+    return _vsimpleht_meta_get(tbl, key, hash);
+#else
+    vsize_t index         = 0;
+    vuintptr_t probed_key = 0;
+    for (index = _vsimpleht_index(tbl, hash);; index++) {
+        index &= tbl->capacity - 1;
+        ASSERT(index < tbl->capacity);
+        probed_key = (vuintptr_t)vatomicptr_read(&tbl->entries[index].key);
+        if (probed_key == 0) {
+            return NULL;
+        } else if (tbl->cmp_key(key, probed_key) == 0) {
+            return vatomicptr_read_acq(&tbl->entries[index].value);
+        }
+    }
+#endif
+}
+/**
+ * Returns the index of the slot where probing for the given hash starts.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param hash hash of a key.
+ * @return vsize_t index of the home slot.
+ */
+static inline vsize_t
+_vsimpleht_index(vsimpleht_t *tbl, vuint64_t hash)
+{
+    return (vsize_t)(hash & (tbl->capacity - 1));
+}
+/**
+ * Returns the index of the home slot of the given key.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key the key.
+ * @return vsize_t index of the slot where probing for key starts.
+ */
+static inline vsize_t
+_vsimpleht_home(vsimpleht_t *tbl, vuintptr_t key)
+{
+    return _vsimpleht_index(tbl, tbl->hash_key(key));
 }
 /**
  * Releases the reader lock briefly if there is a writer waiting to acquire it.
@@ -478,7 +779,7 @@ _vsimpleht_add(vsimpleht_t *tbl, vuintptr_t key, void *value)
 static inline void
 _vsimpleht_give_cleanup_a_chance(vsimpleht_t *tbl)
 {
-#if defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_DISABLE_REMOVE) || defined(VSIMPLEHT_REMOVE_LF)
     V_UNUSED(tbl);
 #else
     if (rwlock_acquired_by_writer(&tbl->lock)) {
@@ -500,7 +801,7 @@ _vsimpleht_give_cleanup_a_chance(vsimpleht_t *tbl)
 static inline void
 _vsimpleht_trigger_cleanup(vsimpleht_t *tbl, void *val)
 {
-#if defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_DISABLE_REMOVE) || defined(VSIMPLEHT_REMOVE_LF)
     V_UNUSED(tbl, val);
 #else
     ASSERT(rwlock_acquired_by_readers(&tbl->lock) &&
@@ -511,7 +812,7 @@ _vsimpleht_trigger_cleanup(vsimpleht_t *tbl, void *val)
     rwlock_read_acquire(&tbl->lock);
 #endif
 }
-#if defined(VSIMPLEHT_DISABLE_REMOVE)
+#if defined(VSIMPLEHT_DISABLE_REMOVE) || defined(VSIMPLEHT_REMOVE_LF)
 static inline void
 _vsimpleht_cleanup(vsimpleht_t *tbl, void *val)
 {
@@ -580,12 +881,18 @@ _vsimpleht_cleanup(vsimpleht_t *tbl, void *val)
             if (ret == VSIMPLEHT_RET_OK) {
                 vatomicptr_write_rlx(&entries[i].key, NULL);
                 vatomicptr_write_rlx(&entries[i].value, NULL);
+    #if defined(VSIMPLEHT_METADATA)
+                vatomic8_write_rlx(&tbl->meta[i], 0);
+    #endif
             }
             ASSERT(ret != VSIMPLEHT_RET_TBL_FULL &&
                    "since we are inserting what is already in the table, "
                    "this should never happen");
         } else if (key != 0 && value == NULL) {
             vatomicptr_write_rlx(&entries[i].key, NULL);
+    #if defined(VSIMPLEHT_METADATA)
+            vatomic8_write_rlx(&tbl->meta[i], 0);
+    #endif
         }
     }
     vatomicsz_write_rlx(&tbl->deleted_count, 0);
@@ -596,4 +903,628 @@ CLEANUP_EXIT:
 }
 #endif
 
+#if defined(VSIMPLEHT_METADATA)
+/**
+ * Returns the fingerprint of the given hash.
+ *
+ * The top bit is always set to distinguish occupied slots from empty ones.
+ *
+ * @param hash hash of a key.
+ * @return vuint8_t fingerprint stored in the metadata of the key slot.
+ */
+static inline vuint8_t
+_vsimpleht_fingerprint(vuint64_t hash)
+{
+    /* the low bits select the home slot, fold all bits in */
+    hash ^= hash >> 32U;
+    hash ^= hash >> 16U;
+    hash ^= hash >> 8U;
+    return (vuint8_t)(0x80U | (hash & 0x7FU));
+}
+/**
+ * Publishes the fingerprint of the key stored in the given slot.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param index index of the slot.
+ * @param fp fingerprint of the key stored in the slot.
+ *
+ * @note the key of a slot does not change while there are registered threads,
+ * so several threads may publish the same fingerprint.
+ */
+static inline void
+_vsimpleht_meta_set(vsimpleht_t *tbl, vsize_t index, vuint8_t fp)
+{
+    if (vatomic8_read_rlx(&tbl->meta[index]) != fp) {
+        vatomic8_write_rel(&tbl->meta[index], fp);
+    }
+}
+    #if defined(V_SIMPLEHT_GROUP_SIZE)
+        #if defined(__ARM_NEON)
+/**
+ * Converts the result of a NEON byte compare into a bitmask.
+ *
+ * @param cmp result of the compare, every byte is either 0 or 0xFF.
+ * @return vuint32_t bitmask with bit i set if byte i of cmp is set.
+ */
+static inline vuint32_t
+_vsimpleht_neon_mask(uint8x16_t cmp)
+{
+    static const vuint8_t bits[16] = {1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U,
+                                      1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U};
+    uint8x16_t m = vandq_u8(cmp, vld1q_u8(bits));
+    return (vuint32_t)vaddv_u8(vget_low_u8(m)) |
+           ((vuint32_t)vaddv_u8(vget_high_u8(m)) << 8U);
+}
+        #endif
+/**
+ * Compares the fingerprints of a group of V_SIMPLEHT_GROUP_SIZE slots with the
+ * given fingerprint.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param index index of the first slot of the group.
+ * @param fp fingerprint to look for.
+ * @param empty output parameter. Bitmask of the empty slots of the group.
+ * @return vuint32_t bitmask of the slots of the group whose fingerprint is fp.
+ *
+ * @note the group must not wrap around the end of the table. The group is
+ * read with a single vector load, which is not atomic as a whole, but every
+ * byte of it is.
+ */
+static inline vuint32_t
+_vsimpleht_group_match(vsimpleht_t *tbl, vsize_t index, vuint8_t fp,
+                       vuint32_t *empty)
+{
+    const void *group = &tbl->meta[index];
+    ASSERT(index + V_SIMPLEHT_GROUP_SIZE <= tbl->capacity);
+        #if defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i *)group);
+    *empty    = (vuint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return (vuint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)fp)));
+        #elif defined(__SSE2__)
+    __m128i v = _mm_loadu_si128((const __m128i *)group);
+    *empty =
+        (vuint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    return (vuint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(v, _mm_set1_epi8((char)fp)));
+        #else
+    uint8x16_t v = vld1q_u8((const vuint8_t *)group);
+    *empty       = _vsimpleht_neon_mask(vceqq_u8(v, vdupq_n_u8(0)));
+    return _vsimpleht_neon_mask(vceqq_u8(v, vdupq_n_u8(fp)));
+        #endif
+}
+    #endif
+/**
+ * Tries to insert the given value into the given slot.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param index index of the slot.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @param fp fingerprint of key.
+ * @param ret output parameter. Result of the insertion if the slot is taken by
+ * key.
+ * @return true the slot is taken by key, ret is set.
+ * @return false the slot is taken by another key, probing must continue.
+ */
+static inline vbool_t
+_vsimpleht_meta_add_slot(vsimpleht_t *tbl, vsize_t index, vuintptr_t key,
+                         void *value, vuint8_t fp, vsimpleht_ret_t *ret)
+{
+    vuintptr_t probed_key = 0;
+    void *val             = NULL;
+
+    probed_key = (vuintptr_t)vatomicptr_read(&tbl->entries[index].key);
+    if (probed_key == 0) {
+        probed_key = (vuintptr_t)vatomicptr_cmpxchg(&tbl->entries[index].key,
+                                                    NULL, (void *)key);
+        if (probed_key == 0) {
+            probed_key = key;
+        }
+    }
+    if (tbl->cmp_key(key, probed_key) != 0) {
+        /* The owner of the slot might not have published the fingerprint
+         * yet. Lookups stop at slots without fingerprint, so we publish it
+         * before moving on to insert our key behind it. */
+        if (vatomic8_read_rlx(&tbl->meta[index]) == 0U) {
+            _vsimpleht_meta_set(tbl, index,
+                                _vsimpleht_fingerprint(
+                                    tbl->hash_key(probed_key)));
+        }
+        return false;
+    }
+    /* the fingerprint must be visible before the value */
+    _vsimpleht_meta_set(tbl, index, fp);
+    val  = vatomicptr_cmpxchg(&tbl->entries[index].value, NULL, value);
+    *ret = (val == NULL) ? VSIMPLEHT_RET_OK : VSIMPLEHT_RET_KEY_EXISTS;
+    return true;
+}
+/**
+ * Inserts the given value into the hashtable, skipping the slots whose
+ * fingerprint does not match.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @param hash hash of key.
+ * @return VSIMPLEHT_RET_OK key does not exist, value was added.
+ * @return VSIMPLEHT_RET_KEY_EXISTS key exists, value was not added.
+ * @return VSIMPLEHT_RET_TBL_FULL table is full.
+ */
+static inline vsimpleht_ret_t
+_vsimpleht_meta_add(vsimpleht_t *tbl, vuintptr_t key, void *value,
+                    vuint64_t hash)
+{
+    vsize_t index       = _vsimpleht_index(tbl, hash);
+    vuint8_t fp         = _vsimpleht_fingerprint(hash);
+    vuint8_t m          = 0;
+    vsize_t cnt         = 0;
+    vsimpleht_ret_t ret = VSIMPLEHT_RET_TBL_FULL;
+
+    ASSERT(key && "NULL key is not allowed!");
+    ASSERT(value && "NULL value is not allowed!");
+    while (cnt < tbl->capacity) {
+    #if defined(V_SIMPLEHT_GROUP_SIZE)
+        if (index + V_SIMPLEHT_GROUP_SIZE <= tbl->capacity) {
+            vuint32_t empty = 0;
+            vuint32_t cand  = _vsimpleht_group_match(tbl, index, fp, &empty);
+            /* slots of other keys are skipped, the empty ones are candidates
+             * because they might be taken by now */
+            for (cand |= empty; cand != 0U; cand &= cand - 1U) {
+                if (_vsimpleht_meta_add_slot(
+                        tbl, index + (vsize_t)__builtin_ctz(cand), key, value,
+                        fp, &ret)) {
+                    return ret;
+                }
+            }
+            index = (index + V_SIMPLEHT_GROUP_SIZE) & (tbl->capacity - 1);
+            cnt += V_SIMPLEHT_GROUP_SIZE;
+            continue;
+        }
+    #endif
+        m = vatomic8_read_rlx(&tbl->meta[index]);
+        if ((m == 0U || m == fp) &&
+            _vsimpleht_meta_add_slot(tbl, index, key, value, fp, &ret)) {
+            return ret;
+        }
+        index = (index + 1U) & (tbl->capacity - 1);
+        cnt++;
+    }
+    return VSIMPLEHT_RET_TBL_FULL;
+}
+/**
+ * Searches the hashtable for the given key, reading only the slots whose
+ * fingerprint matches.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key to search for.
+ * @param hash hash of key.
+ * @return void* address of the object associated with the given key if exists.
+ * @return NULL if there is no value found associated with given key.
+ */
+static inline void *
+_vsimpleht_meta_get(vsimpleht_t *tbl, vuintptr_t key, vuint64_t hash)
+{
+    vsize_t index         = _vsimpleht_index(tbl, hash);
+    vuint8_t fp           = _vsimpleht_fingerprint(hash);
+    vuint8_t m            = 0;
+    vuintptr_t probed_key = 0;
+
+    while (true) {
+    #if defined(V_SIMPLEHT_GROUP_SIZE)
+        if (index + V_SIMPLEHT_GROUP_SIZE <= tbl->capacity) {
+            vuint32_t empty = 0;
+            vuint32_t match = _vsimpleht_group_match(tbl, index, fp, &empty);
+            /* the probe sequence ends at the first empty slot */
+            if (empty != 0U) {
+                match &= (empty & (0U - empty)) - 1U;
+            }
+            if (match != 0U) {
+                /* pairs with the release of _vsimpleht_meta_set */
+                vatomic_fence_acq();
+            }
+            for (; match != 0U; match &= match - 1U) {
+                vsize_t i  = index + (vsize_t)__builtin_ctz(match);
+                probed_key = (vuintptr_t)vatomicptr_read(&tbl->entries[i].key);
+                if (tbl->cmp_key(key, probed_key) == 0) {
+                    return vatomicptr_read_acq(&tbl->entries[i].value);
+                }
+            }
+            if (empty != 0U) {
+                return NULL;
+            }
+            index = (index + V_SIMPLEHT_GROUP_SIZE) & (tbl->capacity - 1);
+            continue;
+        }
+    #endif
+        m = vatomic8_read_acq(&tbl->meta[index]);
+        if (m == 0U) {
+            return NULL;
+        } else if (m == fp) {
+            probed_key = (vuintptr_t)vatomicptr_read(&tbl->entries[index].key);
+            if (tbl->cmp_key(key, probed_key) == 0) {
+                return vatomicptr_read_acq(&tbl->entries[index].value);
+            }
+        }
+        index = (index + 1U) & (tbl->capacity - 1);
+    }
+}
+#endif
+
+#if defined(VSIMPLEHT_REMOVE_LF)
+/* states of a slot, the slot is owned by a single thread while BUSY, VISIBLE
+ * or COLLIDED */
+    #define V_SIMPLEHT_EMPTY     0U
+    #define V_SIMPLEHT_BUSY      1U
+    #define V_SIMPLEHT_COLLIDED  2U
+    #define V_SIMPLEHT_VISIBLE   3U
+    #define V_SIMPLEHT_INSERTING 4U
+    #define V_SIMPLEHT_MEMBER    5U
+
+    #define V_SIMPLEHT_STATE_BITS 3U
+    #define V_SIMPLEHT_STATE_MASK ((1U << V_SIMPLEHT_STATE_BITS) - 1U)
+    /* the version avoids ABA when a slot is reused */
+    #define V_SIMPLEHT_VS(_ver_, _state_)                                      \
+        (((_ver_) << V_SIMPLEHT_STATE_BITS) | (_state_))
+    #define V_SIMPLEHT_VS_VER(_vs_)   ((_vs_) >> V_SIMPLEHT_STATE_BITS)
+    #define V_SIMPLEHT_VS_STATE(_vs_) ((_vs_)&V_SIMPLEHT_STATE_MASK)
+
+    #define V_SIMPLEHT_SCANNING 1U
+    #define V_SIMPLEHT_BOUND(_bound_, _scanning_)                              \
+        (((_bound_) << 1U) | ((_scanning_) ? V_SIMPLEHT_SCANNING : 0U))
+
+/**
+ * Returns the slot at the given offset of the probe sequence of home `h`.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param h index of the home slot.
+ * @param i offset in the probe sequence.
+ * @return vsimpleht_entry_t* address of the slot.
+ */
+static inline vsimpleht_entry_t *
+_vsimpleht_lf_bucket(vsimpleht_t *tbl, vsize_t h, vsize_t i)
+{
+    return &tbl->entries[(h + i) & (tbl->capacity - 1)];
+}
+/**
+ * Returns the probe bound of home `h`.
+ *
+ * Keys whose home is `h` can only be found in the offsets [0, bound].
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param h index of the home slot.
+ * @return vsize_t the probe bound.
+ */
+static inline vsize_t
+_vsimpleht_lf_get_bound(vsimpleht_t *tbl, vsize_t h)
+{
+    return vatomic32_read(&tbl->entries[h].bound) >> 1U;
+}
+/**
+ * Raises the probe bound of home `h` to `index` if it is lower.
+ *
+ * Cancels any ongoing attempt to lower the bound.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param h index of the home slot.
+ * @param index offset of a slot that holds a key of home `h`.
+ */
+static inline void
+_vsimpleht_lf_raise_bound(vsimpleht_t *tbl, vsize_t h, vsize_t index)
+{
+    vatomic32_t *bound = &tbl->entries[h].bound;
+    vuint32_t old      = vatomic32_read(bound);
+    vuint32_t exp      = 0;
+    vuint32_t max      = 0;
+
+    do {
+        exp = old;
+        max = VMAX(exp >> 1U, (vuint32_t)index);
+        old = vatomic32_cmpxchg(bound, exp, V_SIMPLEHT_BOUND(max, false));
+    } while (old != exp);
+}
+/**
+ * Checks if the slot at offset `index` holds a key of home `h`.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param h index of the home slot.
+ * @param index offset in the probe sequence of `h`.
+ * @return true the slot holds or is about to hold a key of home `h`.
+ * @return false the slot holds no key of home `h`.
+ */
+static inline vbool_t
+_vsimpleht_lf_has_collision(vsimpleht_t *tbl, vsize_t h, vsize_t index)
+{
+    vsimpleht_entry_t *entry = _vsimpleht_lf_bucket(tbl, h, index);
+    vuint32_t vs             = vatomic32_read(&entry->state);
+    vuint32_t vs2            = 0;
+    vuintptr_t key           = 0;
+
+    if (V_SIMPLEHT_VS_STATE(vs) < V_SIMPLEHT_VISIBLE) {
+        return false;
+    }
+    key = (vuintptr_t)vatomicptr_read(&entry->key);
+    if (_vsimpleht_home(tbl, key) != h) {
+        return false;
+    }
+    /* the key must belong to the version we have seen */
+    vs2 = vatomic32_read(&entry->state);
+    return V_SIMPLEHT_VS_VER(vs2) == V_SIMPLEHT_VS_VER(vs) &&
+           V_SIMPLEHT_VS_STATE(vs2) >= V_SIMPLEHT_VISIBLE;
+}
+/**
+ * Lowers the probe bound of home `h`, if `index` is the bound.
+ *
+ * The new bound is found by scanning backwards for the last slot that holds a
+ * key of home `h`. Raising the bound in the meantime cancels the attempt.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param h index of the home slot.
+ * @param index offset of a slot that is being emptied.
+ */
+static inline void
+_vsimpleht_lf_lower_bound(vsimpleht_t *tbl, vsize_t h, vsize_t index)
+{
+    vatomic32_t *bound = &tbl->entries[h].bound;
+    vuint32_t cur      = vatomic32_read(bound);
+    vuint32_t exp      = V_SIMPLEHT_BOUND((vuint32_t)index, false);
+    vuint32_t scanning = V_SIMPLEHT_BOUND((vuint32_t)index, true);
+    vsize_t i          = 0;
+
+    /* cancel scans that might not have seen the slot we are emptying */
+    if (cur & V_SIMPLEHT_SCANNING) {
+        (void)vatomic32_cmpxchg(bound, cur, cur & ~V_SIMPLEHT_SCANNING);
+    }
+    if (index == 0) {
+        return;
+    }
+    while (vatomic32_cmpxchg(bound, exp, scanning) == exp) {
+        i = index - 1;
+        while (i > 0 && !_vsimpleht_lf_has_collision(tbl, h, i)) {
+            i--;
+        }
+        (void)vatomic32_cmpxchg(bound, scanning,
+                                V_SIMPLEHT_BOUND((vuint32_t)i, false));
+    }
+}
+/**
+ * Reads key and value of the given slot if it holds a member.
+ *
+ * @param entry address of the slot.
+ * @param key output parameter for the key.
+ * @param val output parameter for the value.
+ * @return true the slot holds a member, key and val are valid.
+ * @return false the slot holds no member.
+ */
+static inline vbool_t
+_vsimpleht_lf_read_member(vsimpleht_entry_t *entry, vuintptr_t *key,
+                          void **val)
+{
+    vuint32_t vs = vatomic32_read(&entry->state);
+
+    if (V_SIMPLEHT_VS_STATE(vs) != V_SIMPLEHT_MEMBER) {
+        return false;
+    }
+    *key = (vuintptr_t)vatomicptr_read(&entry->key);
+    *val = vatomicptr_read(&entry->value);
+    /* the slot was not emptied and reused while we read it */
+    return vatomic32_read(&entry->state) == vs;
+}
+/**
+ * Searches the hashtable for a value associated with the given key.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key to search for.
+ * @param h index of the home slot of key.
+ * @return void* address of the object associated with the given key if exists.
+ * @return NULL if there is no value found associated with given key.
+ */
+static inline void *
+_vsimpleht_lf_get(vsimpleht_t *tbl, vuintptr_t key, vsize_t h)
+{
+    vsize_t max           = _vsimpleht_lf_get_bound(tbl, h);
+    vuintptr_t probed_key = 0;
+    void *val             = NULL;
+
+    for (vsize_t i = 0; i <= max; i++) {
+        if (_vsimpleht_lf_read_member(_vsimpleht_lf_bucket(tbl, h, i),
+                                      &probed_key, &val) &&
+            tbl->cmp_key(key, probed_key) == 0) {
+            return val;
+        }
+    }
+    return NULL;
+}
+/**
+ * Decides the fate of the insertion at offset `i`.
+ *
+ * Concurrent insertions of the same key are resolved in favor of the lowest
+ * offset. Insertions with a higher offset are marked as collided, if the
+ * insertion at `i` sees one with a lower offset, it marks itself as collided
+ * and assists the lower one instead.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key the key being inserted.
+ * @param h index of the home slot of key.
+ * @param i offset of the slot of the insertion.
+ * @param ver version of the slot of the insertion.
+ * @return true no member with the same key was found.
+ * @return false a member with the same key exists.
+ */
+static inline vbool_t
+_vsimpleht_lf_assist(vsimpleht_t *tbl, vuintptr_t key, vsize_t h, vsize_t i,
+                     vuint32_t ver)
+{
+    vsimpleht_entry_t *mine  = NULL;
+    vsimpleht_entry_t *entry = NULL;
+    vuint32_t inserting      = 0;
+    vuint32_t vs             = 0;
+    vsize_t max              = 0;
+
+RETRY:
+    mine      = _vsimpleht_lf_bucket(tbl, h, i);
+    inserting = V_SIMPLEHT_VS(ver, V_SIMPLEHT_INSERTING);
+    max       = _vsimpleht_lf_get_bound(tbl, h);
+    for (vsize_t j = 0; j <= max; j++) {
+        if (j == i) {
+            continue;
+        }
+        entry = _vsimpleht_lf_bucket(tbl, h, j);
+        vs    = vatomic32_read(&entry->state);
+        if (V_SIMPLEHT_VS_STATE(vs) == V_SIMPLEHT_INSERTING &&
+            tbl->cmp_key(key, (vuintptr_t)vatomicptr_read(&entry->key)) ==
+                0) {
+            if (j < i) {
+                if (vatomic32_read(&entry->state) == vs) {
+                    /* the lower insertion wins, help it finish */
+                    (void)vatomic32_cmpxchg(
+                        &mine->state, inserting,
+                        V_SIMPLEHT_VS(ver, V_SIMPLEHT_COLLIDED));
+                    i   = j;
+                    ver = V_SIMPLEHT_VS_VER(vs);
+                    goto RETRY;
+                }
+            } else if (vatomic32_read(&mine->state) == inserting) {
+                (void)vatomic32_cmpxchg(
+                    &entry->state, vs,
+                    V_SIMPLEHT_VS(V_SIMPLEHT_VS_VER(vs), V_SIMPLEHT_COLLIDED));
+            }
+        }
+        vs = vatomic32_read(&entry->state);
+        if (V_SIMPLEHT_VS_STATE(vs) == V_SIMPLEHT_MEMBER &&
+            tbl->cmp_key(key, (vuintptr_t)vatomicptr_read(&entry->key)) ==
+                0 &&
+            vatomic32_read(&entry->state) == vs) {
+            (void)vatomic32_cmpxchg(&mine->state, inserting,
+                                    V_SIMPLEHT_VS(ver, V_SIMPLEHT_COLLIDED));
+            return false;
+        }
+    }
+    (void)vatomic32_cmpxchg(&mine->state, inserting,
+                            V_SIMPLEHT_VS(ver, V_SIMPLEHT_MEMBER));
+    return true;
+}
+/**
+ * Inserts the given value into the hashtable.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @param h index of the home slot of key.
+ * @return VSIMPLEHT_RET_OK key does not exist, value was added.
+ * @return VSIMPLEHT_RET_KEY_EXISTS key exists, value was not added.
+ * @return VSIMPLEHT_RET_TBL_FULL table is full.
+ */
+static inline vsimpleht_ret_t
+_vsimpleht_lf_add(vsimpleht_t *tbl, vuintptr_t key, void *value, vsize_t h)
+{
+    vsimpleht_entry_t *entry = NULL;
+    vuint32_t vs             = 0;
+    vuint32_t ver            = 0;
+    vsize_t i                = 0;
+    vbool_t unique           = false;
+
+    /* spare claiming a slot if the key is there already */
+    if (_vsimpleht_lf_get(tbl, key, h) != NULL) {
+        return VSIMPLEHT_RET_KEY_EXISTS;
+    }
+    for (i = 0;; i++) {
+        if (i == tbl->capacity) {
+            return VSIMPLEHT_RET_TBL_FULL;
+        }
+        entry = _vsimpleht_lf_bucket(tbl, h, i);
+        vs    = vatomic32_read(&entry->state);
+        if (V_SIMPLEHT_VS_STATE(vs) == V_SIMPLEHT_EMPTY &&
+            vatomic32_cmpxchg(&entry->state, vs,
+                              V_SIMPLEHT_VS(V_SIMPLEHT_VS_VER(vs),
+                                            V_SIMPLEHT_BUSY)) == vs) {
+            break;
+        }
+    }
+    /* the slot is ours until it becomes a member */
+    ver = V_SIMPLEHT_VS_VER(vs);
+    vatomicptr_write(&entry->key, (void *)key);
+    vatomicptr_write(&entry->value, value);
+    while (true) {
+        vatomic32_write(&entry->state, V_SIMPLEHT_VS(ver, V_SIMPLEHT_VISIBLE));
+        _vsimpleht_lf_raise_bound(tbl, h, i);
+        vatomic32_write(&entry->state,
+                        V_SIMPLEHT_VS(ver, V_SIMPLEHT_INSERTING));
+        unique = _vsimpleht_lf_assist(tbl, key, h, i, ver);
+        if (vatomic32_read(&entry->state) !=
+            V_SIMPLEHT_VS(ver, V_SIMPLEHT_COLLIDED)) {
+            return VSIMPLEHT_RET_OK;
+        }
+        if (!unique) {
+            _vsimpleht_lf_lower_bound(tbl, h, i);
+            vatomic32_write(&entry->state,
+                            V_SIMPLEHT_VS(ver + 1U, V_SIMPLEHT_EMPTY));
+            return VSIMPLEHT_RET_KEY_EXISTS;
+        }
+        /* we lost against an insertion that might fail itself, retry */
+        ver++;
+    }
+}
+/**
+ * Removes the node associated with the given key from the hashtable.
+ *
+ * The slot becomes empty immediately and can be reused by any key.
+ *
+ * @param tbl address of vsimpleht_t object.
+ * @param key key to remove the value associated with.
+ * @return VSIMPLEHT_RET_OK key exists, node was removed.
+ * @return VSIMPLEHT_RET_KEY_DNE key does not exist.
+ */
+static inline vsimpleht_ret_t
+_vsimpleht_lf_remove(vsimpleht_t *tbl, vuintptr_t key)
+{
+    vsimpleht_entry_t *entry = NULL;
+    vsize_t h                = _vsimpleht_home(tbl, key);
+    vsize_t max              = _vsimpleht_lf_get_bound(tbl, h);
+    vuintptr_t probed_key    = 0;
+    void *val                = NULL;
+    vuint32_t vs             = 0;
+
+    for (vsize_t i = 0; i <= max; i++) {
+        entry = _vsimpleht_lf_bucket(tbl, h, i);
+        vs    = vatomic32_read(&entry->state);
+        if (V_SIMPLEHT_VS_STATE(vs) != V_SIMPLEHT_MEMBER) {
+            continue;
+        }
+        probed_key = (vuintptr_t)vatomicptr_read(&entry->key);
+        if (tbl->cmp_key(key, probed_key) != 0) {
+            continue;
+        }
+        if (vatomic32_cmpxchg(&entry->state, vs,
+                              V_SIMPLEHT_VS(V_SIMPLEHT_VS_VER(vs),
+                                            V_SIMPLEHT_BUSY)) == vs) {
+            val = vatomicptr_read(&entry->value);
+            _vsimpleht_lf_lower_bound(tbl, h, i);
+            vatomic32_write(&entry->state,
+                            V_SIMPLEHT_VS(V_SIMPLEHT_VS_VER(vs) + 1U,
+                                          V_SIMPLEHT_EMPTY));
+            tbl->cb_destroy(val);
+            return VSIMPLEHT_RET_OK;
+        }
+    }
+    return VSIMPLEHT_RET_KEY_DNE;
+}
+
+    #undef V_SIMPLEHT_EMPTY
+    #undef V_SIMPLEHT_BUSY
+    #undef V_SIMPLEHT_COLLIDED
+    #undef V_SIMPLEHT_VISIBLE
+    #undef V_SIMPLEHT_INSERTING
+    #undef V_SIMPLEHT_MEMBER
+    #undef V_SIMPLEHT_STATE_BITS
+    #undef V_SIMPLEHT_STATE_MASK
+    #undef V_SIMPLEHT_VS
+    #undef V_SIMPLEHT_VS_VER
+    #undef V_SIMPLEHT_VS_STATE
+    #undef V_SIMPLEHT_SCANNING
+    #undef V_SIMPLEHT_BOUND
+#endif
+#undef V_SIMPLEHT_GROUP_SIZE
+
 #endif
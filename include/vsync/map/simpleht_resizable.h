@@ -0,0 +1,859 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VSIMPLEHT_RESIZABLE_H
+#define VSIMPLEHT_RESIZABLE_H
+
+/******************************************************************************
+ * @file simpleht_resizable.h
+ * @brief Resizable lock-free hashtable
+ * @ingroup requires_smr lock_free linearizable
+ *
+ * This is a variant of simpleht.h that does not require the capacity to be
+ * known upfront. The table starts with `min_capacity` slots and grows (or
+ * shrinks) online depending on the number of entries it holds.
+ *
+ * Resizing is incremental and cooperative. Once the number of occupied slots
+ * of the current table reaches half of its capacity, a new table is allocated
+ * via the `vmem_lib_t` given at init and linked to the current one. From then
+ * on, every operation (`add`, `get` and `remove`) migrates up to
+ * `VSIMPLEHT_RSZ_MIGRATION_CHUNK` slots before doing its own work. There is no
+ * stop-the-world rehash.
+ *
+ * A slot is migrated by first freezing its key and value, so that no writer
+ * can update it in the old table anymore, and then copying the entry into the
+ * new table. A writer that hits a frozen slot helps copying it and retries in
+ * the new table. Once all slots are migrated the new table replaces the old
+ * one, and the old one is handed to the `retire_tbl` callback.
+ *
+ * # Operating Conditions
+ *
+ * - keys `0` and `VUINTPTR_MAX` are reserved and cannot be used.
+ * - values must be addresses aligned to at least 4 bytes. The two least
+ *   significant bits are used internally.
+ * - all operations must be called inside an SMR critical section. Removed
+ *   values and migrated tables are handed to the retire callbacks while other
+ *   threads might still be accessing them.
+ *
+ * @example
+ * @include eg_simpleht_resizable.c
+ *
+ * @cite
+ * Cliff Click - [A Lock-Free Wait-Free Hash Table]
+ * (https://web.stanford.edu/class/ee380/Abstracts/070221_LockFreeHash.pdf)
+ *
+ *****************************************************************************/
+#include <vsync/atomic.h>
+#include <vsync/common/dbg.h>
+#include <vsync/common/assert.h>
+#include <vsync/utils/alloc.h>
+#include <vsync/utils/math.h>
+#include <vsync/smr/internal/smr_node.h>
+
+/**
+ * @def VSIMPLEHT_RSZ_MIGRATION_CHUNK
+ * @brief Number of slots every operation migrates while a resize is in
+ * progress.
+ */
+#if !defined(VSIMPLEHT_RSZ_MIGRATION_CHUNK)
+    #define VSIMPLEHT_RSZ_MIGRATION_CHUNK 16U
+#endif
+
+/**
+ * @def VSIMPLEHT_RSZ_SHRINK_RATIO
+ * @brief The table shrinks when the number of entries drops below
+ * `capacity/VSIMPLEHT_RSZ_SHRINK_RATIO`.
+ */
+#if !defined(VSIMPLEHT_RSZ_SHRINK_RATIO)
+    #define VSIMPLEHT_RSZ_SHRINK_RATIO 16U
+#endif
+
+/* key of a free slot that was closed by the migration */
+#define V_SIMPLEHT_RSZ_KEY_MOVED   ((vuintptr_t)VUINTPTR_MAX)
+/* value of an entry that was removed */
+#define V_SIMPLEHT_RSZ_TOMBSTONE   ((vuintptr_t)2U)
+/* marks a value that belongs to an entry under migration */
+#define V_SIMPLEHT_RSZ_FROZEN_BIT  ((vuintptr_t)1U)
+/* value of a migrated slot that never had a value, i.e. frozen NULL */
+#define V_SIMPLEHT_RSZ_MIGRATED_EMPTY V_SIMPLEHT_RSZ_FROZEN_BIT
+/* value of a migrated slot that had a value, i.e. frozen tombstone. Late
+ * copies of the same key must not land in the successor tables. */
+#define V_SIMPLEHT_RSZ_MIGRATED                                               \
+    (V_SIMPLEHT_RSZ_TOMBSTONE | V_SIMPLEHT_RSZ_FROZEN_BIT)
+/* a new table is sized to be at most 1/V_SIMPLEHT_RSZ_GROWTH full */
+#define V_SIMPLEHT_RSZ_GROWTH      4U
+
+typedef vint8_t (*vsimpleht_rsz_cmp_key_t)(vuintptr_t key_a, vuintptr_t key_b);
+typedef vuint64_t (*vsimpleht_rsz_hash_key_t)(vuintptr_t key);
+
+typedef struct vsimpleht_rsz_entry_s {
+    vatomicptr(vuintptr_t) key;
+    vatomicptr(void *) value;
+} vsimpleht_rsz_entry_t;
+
+typedef struct vsimpleht_rsz_tbl_s {
+    smr_node_t smr_node; /* used to retire the table once migrated */
+    vsize_t capacity;
+    vsize_t threshold;
+    vatomicsz_t used;      /* number of occupied slots */
+    vatomicsz_t copy_idx;  /* next slot to migrate */
+    vatomicsz_t copy_done; /* number of migrated slots */
+    vatomic32_t resizing;
+    vatomicptr(struct vsimpleht_rsz_tbl_s *) next;
+    vsimpleht_rsz_entry_t entries[];
+} vsimpleht_rsz_tbl_t;
+
+/**
+ * Retires a removed value.
+ *
+ * @param val address of the removed value.
+ * @param arg extra argument given at init.
+ */
+typedef void (*vsimpleht_rsz_retire_val_t)(void *val, void *arg);
+/**
+ * Retires a table that has been fully migrated.
+ *
+ * The table can be freed via `vsimpleht_rsz_tbl_free` once no thread can
+ * access it anymore, e.g., by retiring `tbl->smr_node` to an SMR scheme.
+ *
+ * @param tbl address of the migrated vsimpleht_rsz_tbl_t object.
+ * @param arg extra argument given at init.
+ */
+typedef void (*vsimpleht_rsz_retire_tbl_t)(vsimpleht_rsz_tbl_t *tbl,
+                                           void *arg);
+
+typedef struct vsimpleht_rsz_s {
+    vatomicptr(vsimpleht_rsz_tbl_t *) tbl;
+    vatomicsz_t count;
+    vsize_t min_capacity;
+    vsimpleht_rsz_cmp_key_t cmp_key;
+    vsimpleht_rsz_hash_key_t hash_key;
+    vsimpleht_rsz_retire_val_t retire_val;
+    vsimpleht_rsz_retire_tbl_t retire_tbl;
+    void *retire_arg;
+    vmem_lib_t mem_lib;
+} vsimpleht_rsz_t;
+
+typedef struct vsimpleht_rsz_iter_s {
+    vsimpleht_rsz_tbl_t *tbl;
+    vsize_t idx;
+} vsimpleht_rsz_iter_t;
+
+typedef enum vsimpleht_rsz_ret_e {
+    VSIMPLEHT_RSZ_RET_OK,
+    VSIMPLEHT_RSZ_RET_TBL_FULL,
+    VSIMPLEHT_RSZ_RET_KEY_EXISTS,
+    VSIMPLEHT_RSZ_RET_KEY_DNE,
+} vsimpleht_rsz_ret_t;
+/******************************************************************************
+ * Prototypes - internal functions
+ *****************************************************************************/
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_tbl_alloc(vsimpleht_rsz_t *ht, vsize_t capacity);
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_resize(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                      vbool_t force);
+static inline void _vsimpleht_rsz_help(vsimpleht_rsz_t *ht);
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_migrate_slot(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                            vsize_t idx);
+static inline vsimpleht_rsz_ret_t _vsimpleht_rsz_put(vsimpleht_rsz_t *ht,
+                                                     vsimpleht_rsz_tbl_t *tbl,
+                                                     vuintptr_t key,
+                                                     void *value,
+                                                     vbool_t copy);
+static inline vbool_t _vsimpleht_rsz_is_live(void *val);
+
+/**
+ * Initializes the hashtable.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param min_capacity initial capacity of the hashtable. The table never
+ * shrinks below it. Must be a power of two.
+ * @param cmp_fun compare key callback function address.
+ * @param hash_fun address of callback function. Used to hash the key.
+ * @param retire_val address of callback function. Called on removed values
+ * via `vsimpleht_rsz_remove` and on remaining values in
+ * `vsimpleht_rsz_destroy`.
+ * @param retire_tbl address of callback function. Called on tables that have
+ * been fully migrated.
+ * @param retire_arg extra argument passed to `retire_val` and `retire_tbl`.
+ * @param mem_lib object of type `vmem_lib_t` used to allocate/free tables.
+ */
+static inline void
+vsimpleht_rsz_init(vsimpleht_rsz_t *ht, vsize_t min_capacity,
+                   vsimpleht_rsz_cmp_key_t cmp_fun,
+                   vsimpleht_rsz_hash_key_t hash_fun,
+                   vsimpleht_rsz_retire_val_t retire_val,
+                   vsimpleht_rsz_retire_tbl_t retire_tbl, void *retire_arg,
+                   vmem_lib_t mem_lib)
+{
+    vsimpleht_rsz_tbl_t *tbl = NULL;
+
+    ASSERT(ht);
+    ASSERT(min_capacity > 1U);
+    ASSERT(V_IS_POWER_OF_TWO(min_capacity) && "capacity must be power of 2");
+    ASSERT(vmem_lib_not_null(&mem_lib));
+    ASSERT(retire_val);
+    ASSERT(retire_tbl);
+
+    ht->min_capacity = min_capacity;
+    ht->cmp_key      = cmp_fun;
+    ht->hash_key     = hash_fun;
+    ht->retire_val   = retire_val;
+    ht->retire_tbl   = retire_tbl;
+    ht->retire_arg   = retire_arg;
+    vmem_lib_copy(&ht->mem_lib, &mem_lib);
+    vatomicsz_init(&ht->count, 0);
+
+    tbl = _vsimpleht_rsz_tbl_alloc(ht, min_capacity);
+    ASSERT(tbl && "allocation of the table failed");
+    vatomicptr_init(&ht->tbl, tbl);
+}
+/**
+ * Frees the given table.
+ *
+ * Meant to be called from the SMR callback of tables passed to `retire_tbl`.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of vsimpleht_rsz_tbl_t object.
+ */
+static inline void
+vsimpleht_rsz_tbl_free(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl)
+{
+    ASSERT(ht);
+    ASSERT(tbl);
+    ht->mem_lib.free_fun(tbl, ht->mem_lib.arg);
+}
+/**
+ * Destroys the hashtable.
+ *
+ * Calls `retire_val` on all remaining values and frees all tables that were
+ * not retired yet.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ *
+ * @note call only after all threads are done accessing the hashtable.
+ */
+static inline void
+vsimpleht_rsz_destroy(vsimpleht_rsz_t *ht)
+{
+    vsimpleht_rsz_tbl_t *tbl  = NULL;
+    vsimpleht_rsz_tbl_t *next = NULL;
+    void *val                 = NULL;
+
+    ASSERT(ht);
+    tbl = vatomicptr_read_rlx(&ht->tbl);
+    while (tbl) {
+        for (vsize_t i = 0; i < tbl->capacity; i++) {
+            val = vatomicptr_read_rlx(&tbl->entries[i].value);
+            if (_vsimpleht_rsz_is_live(val)) {
+                ht->retire_val(val, ht->retire_arg);
+            }
+        }
+        next = vatomicptr_read_rlx(&tbl->next);
+        vsimpleht_rsz_tbl_free(ht, tbl);
+        tbl = next;
+    }
+    vatomicptr_write_rlx(&ht->tbl, NULL);
+}
+/**
+ * Inserts the given value into the hashtable.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @return VSIMPLEHT_RSZ_RET_OK key does not exist, value was added.
+ * @return VSIMPLEHT_RSZ_RET_KEY_EXISTS key exists, value was not added.
+ * @return VSIMPLEHT_RSZ_RET_TBL_FULL table is full and a bigger table could
+ * not be allocated.
+ *
+ * @note must be called inside an SMR critical section.
+ */
+static inline vsimpleht_rsz_ret_t
+vsimpleht_rsz_add(vsimpleht_rsz_t *ht, vuintptr_t key, void *value)
+{
+    vsimpleht_rsz_ret_t ret = VSIMPLEHT_RSZ_RET_OK;
+
+    ASSERT(key != 0 && key != V_SIMPLEHT_RSZ_KEY_MOVED && "reserved key");
+    ASSERT(value && "NULL value is not allowed!");
+    ASSERT((((vuintptr_t)value) & 3U) == 0U && "value must be 4B aligned");
+
+    _vsimpleht_rsz_help(ht);
+    ret = _vsimpleht_rsz_put(ht, vatomicptr_read(&ht->tbl), key, value, false);
+    if (ret == VSIMPLEHT_RSZ_RET_OK) {
+        vatomicsz_inc_rlx(&ht->count);
+    }
+    return ret;
+}
+/**
+ * Searches the hashtable for a value associated with the given key.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param key key to search for.
+ * @return void* address of the object associated with the given key if exists.
+ * @return NULL if there is no value found associated with given key.
+ *
+ * @note must be called inside an SMR critical section.
+ */
+static inline void *
+vsimpleht_rsz_get(vsimpleht_rsz_t *ht, vuintptr_t key)
+{
+    vsimpleht_rsz_tbl_t *tbl     = NULL;
+    vsimpleht_rsz_entry_t *entry = NULL;
+    vuintptr_t probed_key        = 0;
+    void *val                    = NULL;
+    vsize_t index                = 0;
+    vsize_t cnt                  = 0;
+
+    _vsimpleht_rsz_help(ht);
+    tbl = vatomicptr_read(&ht->tbl);
+RETRY:
+    for (cnt = 0, index = ht->hash_key(key); cnt < tbl->capacity;
+         cnt++, index++) {
+        index &= tbl->capacity - 1;
+        entry      = &tbl->entries[index];
+        probed_key = (vuintptr_t)vatomicptr_read(&entry->key);
+        if (probed_key == 0) {
+            return NULL;
+        } else if (probed_key == V_SIMPLEHT_RSZ_KEY_MOVED) {
+            /* the key cannot be in this table anymore */
+            tbl = vatomicptr_read(&tbl->next);
+            ASSERT(tbl);
+            goto RETRY;
+        } else if (ht->cmp_key(key, probed_key) == 0) {
+            val = vatomicptr_read_acq(&entry->value);
+            if ((vuintptr_t)val & V_SIMPLEHT_RSZ_FROZEN_BIT) {
+                tbl = _vsimpleht_rsz_migrate_slot(ht, tbl, index);
+                goto RETRY;
+            }
+            return _vsimpleht_rsz_is_live(val) ? val : NULL;
+        }
+    }
+    /* we probed the whole table */
+    tbl = vatomicptr_read(&tbl->next);
+    if (tbl) {
+        goto RETRY;
+    }
+    return NULL;
+}
+/**
+ * Removes the node associated with the given key from the hashtable.
+ *
+ * The removed value is passed to the `retire_val` callback.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param key key to remove the value associated with.
+ * @return VSIMPLEHT_RSZ_RET_OK key exists, node was removed.
+ * @return VSIMPLEHT_RSZ_RET_KEY_DNE key does not exist.
+ *
+ * @note must be called inside an SMR critical section.
+ */
+static inline vsimpleht_rsz_ret_t
+vsimpleht_rsz_remove(vsimpleht_rsz_t *ht, vuintptr_t key)
+{
+    vsimpleht_rsz_tbl_t *tbl     = NULL;
+    vsimpleht_rsz_entry_t *entry = NULL;
+    vuintptr_t probed_key        = 0;
+    void *val                    = NULL;
+    void *exp                    = NULL;
+    vsize_t index                = 0;
+    vsize_t cnt                  = 0;
+
+    _vsimpleht_rsz_help(ht);
+    tbl = vatomicptr_read(&ht->tbl);
+RETRY:
+    for (cnt = 0, index = ht->hash_key(key); cnt < tbl->capacity;
+         cnt++, index++) {
+        index &= tbl->capacity - 1;
+        entry      = &tbl->entries[index];
+        probed_key = (vuintptr_t)vatomicptr_read(&entry->key);
+        if (probed_key == 0) {
+            return VSIMPLEHT_RSZ_RET_KEY_DNE;
+        } else if (probed_key == V_SIMPLEHT_RSZ_KEY_MOVED) {
+            tbl = vatomicptr_read(&tbl->next);
+            ASSERT(tbl);
+            goto RETRY;
+        } else if (ht->cmp_key(key, probed_key) != 0) {
+            continue;
+        }
+        /* writers never update slots of a table that is being migrated */
+        if (vatomicptr_read(&tbl->next)) {
+            tbl = _vsimpleht_rsz_migrate_slot(ht, tbl, index);
+            goto RETRY;
+        }
+        val = vatomicptr_read(&entry->value);
+        do {
+            if ((vuintptr_t)val & V_SIMPLEHT_RSZ_FROZEN_BIT) {
+                tbl = _vsimpleht_rsz_migrate_slot(ht, tbl, index);
+                goto RETRY;
+            }
+            if (!_vsimpleht_rsz_is_live(val)) {
+                return VSIMPLEHT_RSZ_RET_KEY_DNE;
+            }
+            exp = val;
+            val = vatomicptr_cmpxchg(&entry->value, exp,
+                                     (void *)V_SIMPLEHT_RSZ_TOMBSTONE);
+        } while (val != exp);
+
+        vatomicsz_dec_rlx(&ht->count);
+        ht->retire_val(val, ht->retire_arg);
+
+        /* shrink if the table became too sparse */
+        if (tbl->capacity > ht->min_capacity &&
+            vatomicsz_read_rlx(&ht->count) * VSIMPLEHT_RSZ_SHRINK_RATIO <
+                tbl->capacity) {
+            (void)_vsimpleht_rsz_resize(ht, tbl, false);
+        }
+        return VSIMPLEHT_RSZ_RET_OK;
+    }
+    tbl = vatomicptr_read(&tbl->next);
+    if (tbl) {
+        goto RETRY;
+    }
+    return VSIMPLEHT_RSZ_RET_KEY_DNE;
+}
+/**
+ * Returns the approximate number of entries in the hashtable.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @return vsize_t number of entries.
+ */
+static inline vsize_t
+vsimpleht_rsz_get_entries_count(vsimpleht_rsz_t *ht)
+{
+    ASSERT(ht);
+    return vatomicsz_read_rlx(&ht->count);
+}
+/**
+ * Returns the capacity of the current table.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @return vsize_t capacity of the current table.
+ *
+ * @note must be called inside an SMR critical section.
+ */
+static inline vsize_t
+vsimpleht_rsz_get_capacity(vsimpleht_rsz_t *ht)
+{
+    vsimpleht_rsz_tbl_t *tbl = NULL;
+    ASSERT(ht);
+    tbl = vatomicptr_read(&ht->tbl);
+    return tbl->capacity;
+}
+/**
+ * Initializes the given iterator object `iter` for operating `ht` object.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param iter address of vsimpleht_rsz_iter_t object to initialize.
+ */
+static inline void
+vsimpleht_rsz_iter_init(vsimpleht_rsz_t *ht, vsimpleht_rsz_iter_t *iter)
+{
+    ASSERT(ht);
+    ASSERT(iter);
+    iter->tbl = vatomicptr_read(&ht->tbl);
+    iter->idx = 0;
+}
+/**
+ * Reads the current entry (key/value) the iterator has reached.
+ *
+ * After the values are read, the iterator advances to the next entry.
+ *
+ * @param iter address of vsimpleht_rsz_iter_t object.
+ * @param key output parameter where the current key value is stored.
+ * @param val output parameter where the current object value is stored.
+ * @return true the current output of key and val is valid.
+ * @return false there are no more objects to iterate.
+ *
+ * @pre iter must be initalized via vsimpleht_rsz_iter_init.
+ *
+ * @note the iterator is mainly meant for sequential setting. When called in
+ * parallel the results might not be consistent.
+ */
+static inline vbool_t
+vsimpleht_rsz_iter_next(vsimpleht_rsz_iter_t *iter, vuintptr_t *key,
+                        void **val)
+{
+    vsimpleht_rsz_entry_t *entry = NULL;
+    vuintptr_t k                 = 0;
+    void *v                      = NULL;
+
+    ASSERT(iter);
+    ASSERT(key);
+    ASSERT(val);
+    while (iter->tbl) {
+        for (vsize_t i = iter->idx; i < iter->tbl->capacity; i++) {
+            entry = &iter->tbl->entries[i];
+            k     = (vuintptr_t)vatomicptr_read(&entry->key);
+            v     = vatomicptr_read(&entry->value);
+            if (_vsimpleht_rsz_is_live(v)) {
+                iter->idx = i + 1;
+                *key      = k;
+                *val      = v;
+                return true;
+            }
+        }
+        /* values not migrated yet are still live in the old table, migrated
+         * ones are in the next */
+        iter->tbl = vatomicptr_read(&iter->tbl->next);
+        iter->idx = 0;
+    }
+    return false;
+}
+/**
+ * Checks if the given value is a user value, i.e., neither empty, removed nor
+ * frozen.
+ *
+ * @param val value read from an entry.
+ * @return true val is a live user value.
+ * @return false val is empty, removed or frozen.
+ */
+static inline vbool_t
+_vsimpleht_rsz_is_live(void *val)
+{
+    vuintptr_t v = (vuintptr_t)val;
+    return v != 0 && v != V_SIMPLEHT_RSZ_TOMBSTONE &&
+           (v & V_SIMPLEHT_RSZ_FROZEN_BIT) == 0;
+}
+/**
+ * Checks if the migration of the slot holding `val` is complete.
+ *
+ * @param val value read from an entry.
+ * @return true val is one of the final values of a migrated slot.
+ * @return false val is not frozen or its copy is pending.
+ */
+static inline vbool_t
+_vsimpleht_rsz_is_migrated(void *val)
+{
+    vuintptr_t v = (vuintptr_t)val;
+    return v == V_SIMPLEHT_RSZ_MIGRATED_EMPTY || v == V_SIMPLEHT_RSZ_MIGRATED;
+}
+/**
+ * Allocates and initializes a table of the given capacity.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param capacity capacity of the table, power of two.
+ * @return vsimpleht_rsz_tbl_t* address of the allocated table, NULL if the
+ * allocation failed.
+ */
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_tbl_alloc(vsimpleht_rsz_t *ht, vsize_t capacity)
+{
+    vsimpleht_rsz_tbl_t *tbl = NULL;
+    vsize_t sz               = sizeof(vsimpleht_rsz_tbl_t) +
+                 (sizeof(vsimpleht_rsz_entry_t) * capacity);
+
+    ASSERT(V_IS_POWER_OF_TWO(capacity));
+    tbl = ht->mem_lib.malloc_fun(sz, ht->mem_lib.arg);
+    if (tbl == NULL) {
+        return NULL;
+    }
+    tbl->capacity  = capacity;
+    tbl->threshold = capacity / 2U;
+    vatomicsz_init(&tbl->used, 0);
+    vatomicsz_init(&tbl->copy_idx, 0);
+    vatomicsz_init(&tbl->copy_done, 0);
+    vatomic32_init(&tbl->resizing, 0);
+    vatomicptr_init(&tbl->next, NULL);
+    for (vsize_t i = 0; i < capacity; i++) {
+        vatomicptr_init(&tbl->entries[i].key, NULL);
+        vatomicptr_init(&tbl->entries[i].value, NULL);
+    }
+    return tbl;
+}
+/**
+ * Links a new table to `tbl`, if none is linked yet.
+ *
+ * The capacity of the new table is determined by the number of entries in the
+ * hashtable, it can be bigger, smaller or equal to the capacity of `tbl`.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of the table to resize.
+ * @param force if false, the caller gives up if another thread is already
+ * allocating a new table.
+ * @return vsimpleht_rsz_tbl_t* address of the table linked to `tbl`, NULL if
+ * there is none.
+ */
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_resize(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                      vbool_t force)
+{
+    vsimpleht_rsz_tbl_t *next    = NULL;
+    vsimpleht_rsz_tbl_t *new_tbl = NULL;
+    vsize_t live                 = 0;
+    vsize_t capacity             = ht->min_capacity;
+
+    next = vatomicptr_read(&tbl->next);
+    if (next) {
+        return next;
+    }
+    /* avoid that all threads allocate a table at the same time, if the table
+     * is not full, the others just keep using it */
+    if (vatomic32_xchg(&tbl->resizing, 1U) != 0U && !force) {
+        return NULL;
+    }
+    /* count can temporarily be off, it is bound by the occupied slots */
+    live = VMIN(vatomicsz_read_rlx(&ht->count), vatomicsz_read(&tbl->used));
+    while (capacity < live * V_SIMPLEHT_RSZ_GROWTH) {
+        capacity <<= 1U;
+    }
+    new_tbl = _vsimpleht_rsz_tbl_alloc(ht, capacity);
+    if (new_tbl == NULL) {
+        vatomic32_write(&tbl->resizing, 0U);
+        return vatomicptr_read(&tbl->next);
+    }
+    next = vatomicptr_cmpxchg(&tbl->next, NULL, new_tbl);
+    if (next != NULL) {
+        /* someone else was faster, ours was never published */
+        vsimpleht_rsz_tbl_free(ht, new_tbl);
+        return next;
+    }
+    DBG_BLUE("resizing %zu -> %zu", tbl->capacity, capacity);
+    return new_tbl;
+}
+/**
+ * Replaces the current table with its successor if `tbl` is the current table
+ * and it is fully migrated.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of a fully migrated table.
+ */
+static inline void
+_vsimpleht_rsz_promote(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl)
+{
+    vsimpleht_rsz_tbl_t *next = vatomicptr_read(&tbl->next);
+
+    ASSERT(next);
+    if (vatomicptr_cmpxchg(&ht->tbl, tbl, next) == tbl) {
+        /* only the winner retires the old table */
+        ht->retire_tbl(tbl, ht->retire_arg);
+    }
+}
+/**
+ * Accounts `count` migrated slots of `tbl` and promotes its successor once
+ * all slots are migrated.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of vsimpleht_rsz_tbl_t object.
+ * @param count number of slots the caller has migrated.
+ */
+static inline void
+_vsimpleht_rsz_copy_done(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                         vsize_t count)
+{
+    vsize_t done = 0;
+
+    if (count > 0) {
+        done = vatomicsz_add_get(&tbl->copy_done, count);
+    } else {
+        done = vatomicsz_read(&tbl->copy_done);
+    }
+    ASSERT(done <= tbl->capacity);
+    if (done == tbl->capacity) {
+        _vsimpleht_rsz_promote(ht, tbl);
+    }
+}
+/**
+ * Migrates the slot at `idx` of `tbl` into the successor of `tbl`.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of the table under migration.
+ * @param idx index of the slot to migrate.
+ * @return true the calling thread completed the migration of the slot.
+ * @return false the slot was already migrated by another thread.
+ */
+static inline vbool_t
+_vsimpleht_rsz_copy_slot(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                         vsize_t idx)
+{
+    vsimpleht_rsz_entry_t *entry = &tbl->entries[idx];
+    vsimpleht_rsz_tbl_t *next    = vatomicptr_read(&tbl->next);
+    vuintptr_t key               = 0;
+    void *val                    = NULL;
+    void *exp                    = NULL;
+    void *raw                    = NULL;
+
+    ASSERT(next);
+    /* close free slots, such that new keys cannot appear in this table */
+    key = (vuintptr_t)vatomicptr_read(&entry->key);
+    if (key == 0) {
+        key = (vuintptr_t)vatomicptr_cmpxchg(
+            &entry->key, NULL, (void *)V_SIMPLEHT_RSZ_KEY_MOVED);
+        if (key == 0) {
+            return true;
+        }
+    }
+    if (key == V_SIMPLEHT_RSZ_KEY_MOVED) {
+        return false;
+    }
+    /* freeze the value, writers cannot update it in this table anymore */
+    val = vatomicptr_read(&entry->value);
+    while (((vuintptr_t)val & V_SIMPLEHT_RSZ_FROZEN_BIT) == 0U) {
+        exp = val;
+        val = vatomicptr_cmpxchg(
+            &entry->value, exp,
+            (void *)((vuintptr_t)exp | V_SIMPLEHT_RSZ_FROZEN_BIT));
+        if (val == exp) {
+            val = (void *)((vuintptr_t)exp | V_SIMPLEHT_RSZ_FROZEN_BIT);
+            if (_vsimpleht_rsz_is_migrated(val)) {
+                /* empty and removed entries need no copy */
+                return true;
+            }
+        }
+    }
+    if (_vsimpleht_rsz_is_migrated(val)) {
+        return false;
+    }
+    /* only lands if the key has no value in the new table yet, i.e., if no
+     * other thread copied it before */
+    raw = (void *)((vuintptr_t)val & ~V_SIMPLEHT_RSZ_FROZEN_BIT);
+    (void)_vsimpleht_rsz_put(ht, next, key, raw, true);
+    return vatomicptr_cmpxchg(&entry->value, val,
+                              (void *)V_SIMPLEHT_RSZ_MIGRATED) == val;
+}
+/**
+ * Migrates the slot at `idx` of `tbl` and returns the successor of `tbl`.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of the table under migration.
+ * @param idx index of the slot to migrate.
+ * @return vsimpleht_rsz_tbl_t* address of the successor of `tbl`.
+ */
+static inline vsimpleht_rsz_tbl_t *
+_vsimpleht_rsz_migrate_slot(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                            vsize_t idx)
+{
+    if (_vsimpleht_rsz_copy_slot(ht, tbl, idx)) {
+        _vsimpleht_rsz_copy_done(ht, tbl, 1U);
+    }
+    return vatomicptr_read(&tbl->next);
+}
+/**
+ * Migrates a chunk of the current table if it is being resized.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ */
+static inline void
+_vsimpleht_rsz_help(vsimpleht_rsz_t *ht)
+{
+    vsimpleht_rsz_tbl_t *tbl = vatomicptr_read(&ht->tbl);
+    vsize_t chunk            = VMIN(tbl->capacity,
+                                    (vsize_t)VSIMPLEHT_RSZ_MIGRATION_CHUNK);
+    vsize_t start            = 0;
+    vsize_t count            = 0;
+
+    if (vatomicptr_read(&tbl->next) == NULL) {
+        return;
+    }
+    /* claimed chunks wrap around, in case a thread that claimed a chunk
+     * stalls, others will eventually migrate its slots */
+    start = vatomicsz_get_add(&tbl->copy_idx, chunk);
+    for (vsize_t i = 0; i < chunk; i++) {
+        if (_vsimpleht_rsz_copy_slot(ht, tbl,
+                                     (start + i) & (tbl->capacity - 1))) {
+            count++;
+        }
+    }
+    _vsimpleht_rsz_copy_done(ht, tbl, count);
+}
+/**
+ * Inserts the given value into `tbl` or its successors.
+ *
+ * @param ht address of vsimpleht_rsz_t object.
+ * @param tbl address of the table to start in.
+ * @param key key of the value to add.
+ * @param value address of the object to insert.
+ * @param copy true if called for migrating an entry. Then the value is only
+ * written if the key has no value, i.e., a removed entry is not revived.
+ * @return VSIMPLEHT_RSZ_RET_OK value was added.
+ * @return VSIMPLEHT_RSZ_RET_KEY_EXISTS key exists, value was not added.
+ * @return VSIMPLEHT_RSZ_RET_TBL_FULL table is full.
+ */
+static inline vsimpleht_rsz_ret_t
+_vsimpleht_rsz_put(vsimpleht_rsz_t *ht, vsimpleht_rsz_tbl_t *tbl,
+                   vuintptr_t key, void *value, vbool_t copy)
+{
+    vsimpleht_rsz_entry_t *entry = NULL;
+    vsimpleht_rsz_tbl_t *next    = NULL;
+    vuintptr_t probed_key        = 0;
+    void *val                    = NULL;
+    void *exp                    = NULL;
+    vsize_t index                = 0;
+    vsize_t cnt                  = 0;
+
+RETRY:
+    for (cnt = 0, index = ht->hash_key(key); cnt < tbl->capacity;
+         cnt++, index++) {
+        index &= tbl->capacity - 1;
+        entry      = &tbl->entries[index];
+        probed_key = (vuintptr_t)vatomicptr_read(&entry->key);
+        if (probed_key == 0) {
+            next = vatomicptr_read(&tbl->next);
+            if (next == NULL &&
+                vatomicsz_read(&tbl->used) >= tbl->threshold) {
+                next = _vsimpleht_rsz_resize(ht, tbl, false);
+            }
+            if (next) {
+                /* no new keys in a table that is being migrated */
+                (void)_vsimpleht_rsz_migrate_slot(ht, tbl, index);
+                probed_key = (vuintptr_t)vatomicptr_read(&entry->key);
+            } else {
+                probed_key = (vuintptr_t)vatomicptr_cmpxchg(
+                    &entry->key, NULL, (void *)key);
+                if (probed_key == 0) {
+                    vatomicsz_inc(&tbl->used);
+                    probed_key = key;
+                }
+            }
+        }
+        if (probed_key == V_SIMPLEHT_RSZ_KEY_MOVED) {
+            tbl = vatomicptr_read(&tbl->next);
+            ASSERT(tbl);
+            goto RETRY;
+        } else if (ht->cmp_key(key, probed_key) != 0) {
+            continue;
+        }
+        /* writers never update slots of a table that is being migrated */
+        if (vatomicptr_read(&tbl->next)) {
+            (void)_vsimpleht_rsz_migrate_slot(ht, tbl, index);
+        }
+        val = vatomicptr_read(&entry->value);
+        do {
+            /* a copy must not land once the key had a value in this table,
+             * the value might have been removed in the meantime */
+            if (copy && val != NULL &&
+                (vuintptr_t)val != V_SIMPLEHT_RSZ_MIGRATED_EMPTY) {
+                return VSIMPLEHT_RSZ_RET_KEY_EXISTS;
+            }
+            if ((vuintptr_t)val & V_SIMPLEHT_RSZ_FROZEN_BIT) {
+                tbl = _vsimpleht_rsz_migrate_slot(ht, tbl, index);
+                goto RETRY;
+            }
+            if (_vsimpleht_rsz_is_live(val)) {
+                return VSIMPLEHT_RSZ_RET_KEY_EXISTS;
+            }
+            exp = val;
+            val = vatomicptr_cmpxchg(&entry->value, exp, value);
+        } while (val != exp);
+        return VSIMPLEHT_RSZ_RET_OK;
+    }
+    /* we probed the whole table without finding a slot */
+    next = _vsimpleht_rsz_resize(ht, tbl, true);
+    if (next) {
+        tbl = next;
+        goto RETRY;
+    }
+    ASSERT(!copy && "migration requires a new table");
+    return VSIMPLEHT_RSZ_RET_TBL_FULL;
+}
+
+#undef V_SIMPLEHT_RSZ_KEY_MOVED
+#undef V_SIMPLEHT_RSZ_TOMBSTONE
+#undef V_SIMPLEHT_RSZ_FROZEN_BIT
+#undef V_SIMPLEHT_RSZ_MIGRATED_EMPTY
+#undef V_SIMPLEHT_RSZ_MIGRATED
+#undef V_SIMPLEHT_RSZ_GROWTH
+#endif
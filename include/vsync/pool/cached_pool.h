@@ -13,6 +13,38 @@
  * ### Performance:
  *  - No atomic operations in the fast path of alloc/free
  *  - Increasing number of entries may have a better performance
+ *  - The shared buffer is a ring with a sequence number per slot: a thread
+ *    preempted while spilling or refilling delays only the slot it claimed.
+ *    Other threads only wait for it in a fixed pool, when a spill wraps
+ *    around the ring to that slot
+ *
+ * ### Elastic mode:
+ * A pool created with `cached_pool_create` has no fixed capacity. When a
+ * thread misses in its vunit and the shared buffer is empty, the pool takes
+ * memory for `thread_num` batches of entries (a slab) from the given
+ * `vmem_lib_t`. The shared buffer keeps at most `max_free` free entries (the
+ * high-water mark). Batches spilled beyond it go back to their slabs, and a
+ * slab is released as soon as all of its entries are back. Slabs are managed
+ * under a lock on the slow path only, alloc/free in the vunits are unchanged.
+ *
+ * ### Remote free:
+ * By default, an entry freed by a thread other than the one that allocated
+ * it migrates into the vunit of the freeing thread. In producer/consumer
+ * setups this sends every entry through the shared buffer. Compile with
+ * `-DCACHED_POOL_REMOTE_FREE` to give every vunit a remote-free list: an
+ * allocated entry records its owner, a free by another thread pushes the
+ * entry onto the list of the owner with a single CAS, and the owner takes
+ * the whole list on its next miss, before it refills from the shared buffer.
+ * The list of a thread that stopped allocating is not lost: a thread that
+ * finds the shared buffers empty adopts the lists of the other vunits before
+ * it takes a new slab or fails.
+ *
+ * ### NUMA:
+ * Pools created with `cached_pool_init_numa` or `cached_pool_create_numa`
+ * have one shared buffer per NUMA node. Every thread spills to and refills
+ * from the buffer of its node, given with `cached_pool_set_node` like the
+ * `numa_node` of `cnalock_acquire`. Only when the buffer of its node is empty
+ * a thread steals a batch from the buffers of the other nodes.
  *
  * @example
  * @include eg_cached_pool.c
@@ -21,11 +53,18 @@
 #include <vsync/atomic.h>
 #include <vsync/common/cache.h>
 #include <vsync/common/compiler.h>
+#include <vsync/spinlock/caslock.h>
+#include <vsync/stack/quack.h>
+#include <vsync/utils/alloc.h>
 #include <vsync/utils/math.h>
 
 typedef struct cached_pool_config_s {
     vsize_t entry_space;
     vuint32_t buffer_mask;
+    vuint32_t buffer_max; /* maximum number of batches in the buffer */
+    vuint32_t numa_num;   /* number of buffers, one per NUMA node */
+    vuint32_t thread_num; /* number of vunits */
+    vsize_t buffer_stride;
     vuint32_t threshold_init;
     vuint32_t threshold_link;
     vuint32_t threshold_max;
@@ -33,12 +72,16 @@ typedef struct cached_pool_config_s {
 
 typedef vuintptr_t cached_pool_entry_t;
 
+typedef struct cached_pool_slot_s {
+    /* position + 1 if the slot is full, position if it is free for it */
+    vatomic64_t seq;
+    cached_pool_entry_t *es;
+} cached_pool_slot_t;
+
 typedef struct cached_pool_buffer_s {
     vatomic64_t phead VSYNC_CACHEALIGN;
-    vatomic64_t ptail VSYNC_CACHEALIGN;
     vatomic64_t chead VSYNC_CACHEALIGN;
-    vatomic64_t ctail VSYNC_CACHEALIGN;
-    cached_pool_entry_t *nodes[] VSYNC_CACHEALIGN;
+    cached_pool_slot_t slots[] VSYNC_CACHEALIGN;
 } VSYNC_CACHEALIGN cached_pool_buffer_t;
 
 typedef struct cached_pool_vunit_s {
@@ -46,17 +89,53 @@ typedef struct cached_pool_vunit_s {
     cached_pool_buffer_t *buf;
     cached_pool_entry_t *top;
     cached_pool_entry_t *mid;
+    vuint32_t node;
+#if defined(CACHED_POOL_REMOTE_FREE)
+    vuint32_t id;
+    /* entries of this vunit freed by other threads */
+    quack_t remote VSYNC_CACHEALIGN;
+#endif
 } VSYNC_CACHEALIGN cached_pool_vunit_t;
 
+typedef struct cached_pool_slab_s {
+    struct cached_pool_slab_s *prev;
+    struct cached_pool_slab_s *next;
+    cached_pool_entry_t *free; /* entries returned to the slab */
+    vuint32_t nfree;
+    vuint32_t num;
+} VSYNC_CACHEALIGN cached_pool_slab_t;
+
+typedef struct cached_pool_elastic_s {
+    caslock_t lock;
+    /* slabs with free entries come first */
+    cached_pool_slab_t *head;
+    cached_pool_slab_t *tail;
+    vuint32_t slab_entries;
+    vmem_lib_t mem_lib;
+} VSYNC_CACHEALIGN cached_pool_elastic_t;
+
 typedef struct cached_pool_s {
     cached_pool_config_t conf VSYNC_CACHEALIGN;
     cached_pool_buffer_t *buf VSYNC_CACHEALIGN;
     cached_pool_entry_t *entries VSYNC_CACHEALIGN;
+    cached_pool_elastic_t elastic VSYNC_CACHEALIGN;
     cached_pool_vunit_t vunits[] VSYNC_CACHEALIGN;
 } VSYNC_CACHEALIGN cached_pool_t;
 
 #define CACHED_POOL_MAX_THRESHOLD_FACTOR 2U
 
+/* size of a shared buffer with `slot_num` slots, padded to a cache line */
+#define CACHED_POOL_BUFFER_STRIDE(slot_num)                                    \
+    v_least_containing_multiple(sizeof(cached_pool_buffer_t) +                 \
+                                    sizeof(cached_pool_slot_t) * (slot_num),   \
+                                VSYNC_CACHELINE_SIZE)
+
+static inline void *_cached_pool_vunit_refill(cached_pool_t *a,
+                                              cached_pool_vunit_t *u);
+static inline void _cached_pool_vunit_spill(cached_pool_t *a,
+                                            cached_pool_vunit_t *u,
+                                            cached_pool_entry_t *es);
+
 /******************************** entry ***************************************/
 static inline cached_pool_entry_t *
 _cached_pool_entry_get_next(cached_pool_entry_t *e)
@@ -89,64 +168,156 @@ _cached_pool_entry_from_addr(void *p)
     return (cached_pool_entry_t *)(((vuintptr_t)p) - sizeof(void *));
 }
 
+/* in elastic mode, the last word of every entry points to its slab */
+static inline cached_pool_slab_t *
+_cached_pool_entry_get_slab(cached_pool_t *a, cached_pool_entry_t *e)
+{
+    return *(cached_pool_slab_t **)(((vuintptr_t)e) + a->conf.entry_space -
+                                    sizeof(void *));
+}
+
+static inline void
+_cached_pool_entry_set_slab(cached_pool_t *a, cached_pool_entry_t *e,
+                            cached_pool_slab_t *s)
+{
+    *(cached_pool_slab_t **)(((vuintptr_t)e) + a->conf.entry_space -
+                             sizeof(void *)) = s;
+}
+
+#if defined(CACHED_POOL_REMOTE_FREE)
+/* the link word of an allocated entry records the vunit it belongs to */
+static inline vuint32_t
+_cached_pool_entry_get_owner(cached_pool_entry_t *e)
+{
+    return (vuint32_t)(*e);
+}
+
+static inline void
+_cached_pool_entry_set_owner(cached_pool_entry_t *e, vuint32_t id)
+{
+    *e = (cached_pool_entry_t)id;
+}
+#endif
+
 /******************************* buffer ***************************************/
-static void
-_cached_pool_buffer_init(cached_pool_buffer_t *buf)
+static inline void
+_cached_pool_buffer_init(cached_pool_buffer_t *buf, vuint32_t slot_num)
 {
     vatomic64_init(&buf->phead, 0);
-    vatomic64_init(&buf->ptail, 0);
     vatomic64_init(&buf->chead, 0);
-    vatomic64_init(&buf->ctail, 0);
+    for (vuint32_t idx = 0; idx < slot_num; idx++) {
+        vatomic64_init(&buf->slots[idx].seq, idx);
+        buf->slots[idx].es = NULL;
+    }
+}
+
+static inline cached_pool_buffer_t *
+_cached_pool_buffer_find(cached_pool_t *a, vuint32_t node)
+{
+    return (cached_pool_buffer_t *)(((vuintptr_t)a->buf) +
+                                    a->conf.buffer_stride * node);
+}
+
+static inline void
+_cached_pool_buffers_init(cached_pool_t *a, vuint32_t slot_num)
+{
+    for (vuint32_t node = 0; node < a->conf.numa_num; node++) {
+        _cached_pool_buffer_init(_cached_pool_buffer_find(a, node), slot_num);
+    }
 }
 
 static inline cached_pool_entry_t *
 _cached_pool_buffer_alloc(cached_pool_t *a, cached_pool_buffer_t *buf)
 {
-    vuint64_t ch = 0;
-    vuint64_t pt = 0;
+    cached_pool_slot_t *slot = NULL;
+    vuint64_t ch             = 0;
+    vuint64_t seq            = 0;
     ASSERT(a);
     ASSERT(buf);
 
-    do {
-        ch = vatomic64_read_rlx(&buf->chead);
-        pt = vatomic64_read_acq(&buf->ptail);
-        if (ch == pt) {
+    ch = vatomic64_read_rlx(&buf->chead);
+    while (true) {
+        slot = &buf->slots[ch & a->conf.buffer_mask];
+        /* acquire: see the batch written by the producer */
+        seq = vatomic64_read_acq(&slot->seq);
+        if (seq == ch + 1) {
+            vuint64_t old = vatomic64_cmpxchg_rlx(&buf->chead, ch, ch + 1);
+            if (old == ch) {
+                break;
+            }
+            ch = old;
+        } else if ((vint64_t)(seq - (ch + 1)) < 0) {
+            /* empty, or the producer of this slot did not finish yet */
             return NULL;
+        } else {
+            ch = vatomic64_read_rlx(&buf->chead);
         }
-    } while (vatomic64_cmpxchg_rlx(&buf->chead, ch, ch + 1) != ch);
+    }
 
-    cached_pool_entry_t *es = buf->nodes[ch & a->conf.buffer_mask];
-    await_while (vatomic64_read_rlx(&buf->ctail) != ch) {}
-    vatomic64_write_rel(&buf->ctail, ch + 1);
+    cached_pool_entry_t *es = slot->es;
+    /* release: the next producer of the slot overwrites es after our read */
+    vatomic64_write_rel(&slot->seq, ch + a->conf.buffer_mask + 1U);
     return es;
 }
 
-static inline void
+static inline vbool_t
 _cached_pool_buffer_free(cached_pool_t *a, cached_pool_buffer_t *buf,
                          cached_pool_entry_t *es)
 {
-    vuint64_t ph = 0;
+    cached_pool_slot_t *slot = NULL;
+    vuint64_t ph             = 0;
+    vuint64_t seq            = 0;
     ASSERT(a);
     ASSERT(buf);
 
-    do {
-        ph = vatomic64_read_rlx(&buf->phead);
-    } while (vatomic64_cmpxchg_rlx(&buf->phead, ph, ph + 1) != ph);
+    ph = vatomic64_read_rlx(&buf->phead);
+    while (true) {
+        if (ph - vatomic64_read_rlx(&buf->chead) >= a->conf.buffer_max) {
+            return false;
+        }
+        slot = &buf->slots[ph & a->conf.buffer_mask];
+        /* acquire: the consumer of the previous round is done with es */
+        seq = vatomic64_read_acq(&slot->seq);
+        if (seq == ph) {
+            vuint64_t old = vatomic64_cmpxchg_rlx(&buf->phead, ph, ph + 1);
+            if (old == ph) {
+                break;
+            }
+            ph = old;
+        } else if ((vint64_t)(seq - ph) < 0) {
+            /* the consumer of the previous round did not finish yet */
+            if (vmem_lib_not_null(&a->elastic.mem_lib)) {
+                return false;
+            }
+            /* a fixed pool has no other place for the batch, and the ring
+             * has room for all of them: the slot frees up shortly */
+            vatomic_cpu_pause();
+            ph = vatomic64_read_rlx(&buf->phead);
+        } else {
+            ph = vatomic64_read_rlx(&buf->phead);
+        }
+    }
 
-    buf->nodes[ph & a->conf.buffer_mask] = es;
-    await_while (vatomic64_read_rlx(&buf->ptail) != ph) {}
-    vatomic64_write_rel(&buf->ptail, ph + 1);
+    slot->es = es;
+    vatomic64_write_rel(&slot->seq, ph + 1);
+    return true;
 }
 
 /********************************* vunit **************************************/
-static void
+static inline void
 _cached_pool_vunit_init(cached_pool_t *a, cached_pool_vunit_t *u,
                         cached_pool_buffer_t *b, cached_pool_entry_t *es)
 {
-    u->cnt = a->conf.threshold_init;
-    u->buf = b;
-    u->top = es;
-    u->mid = es;
+    u->cnt  = a->conf.threshold_init;
+    u->buf  = b;
+    u->top  = es;
+    u->mid  = es;
+    u->node = (vuint32_t)(((vuintptr_t)b - (vuintptr_t)a->buf) /
+                          a->conf.buffer_stride);
+#if defined(CACHED_POOL_REMOTE_FREE)
+    u->id = (vuint32_t)(u - a->vunits);
+    quack_init(&u->remote);
+#endif
 }
 
 static inline void *
@@ -154,14 +325,16 @@ _cached_pool_vunit_alloc(cached_pool_t *a, cached_pool_vunit_t *u)
 {
     cached_pool_entry_t *es = u->top;
     if (unlikely(!es)) {
-        es = _cached_pool_buffer_alloc(a, u->buf);
+        es = _cached_pool_vunit_refill(a, u);
         if (unlikely(!es)) {
             return NULL;
         }
-        u->cnt = a->conf.threshold_init;
     }
     u->top = _cached_pool_entry_get_next(es);
     u->cnt--;
+#if defined(CACHED_POOL_REMOTE_FREE)
+    _cached_pool_entry_set_owner(es, u->id);
+#endif
     return _cached_pool_entry_to_addr(es);
 }
 
@@ -179,7 +352,7 @@ _cached_pool_vunit_free(cached_pool_t *a, cached_pool_vunit_t *u, void *p)
         u->cnt                  = a->conf.threshold_init;
         cached_pool_entry_t *es = _cached_pool_entry_get_next(u->mid);
         _cached_pool_entry_set_next(u->mid, NULL);
-        _cached_pool_buffer_free(a, u->buf, es);
+        _cached_pool_vunit_spill(a, u, es);
     }
 }
 
@@ -200,31 +373,49 @@ _cached_pool_vunit_find(cached_pool_t *a, vuint32_t id)
  * @return needed memory space (in bytes)
  */
 #define cached_pool_memsize(thread_num, entry_num, entry_size)                 \
+    cached_pool_memsize_numa(thread_num, entry_num, entry_size, 1U)
+
+/**
+ * Calculate the needed memory space for creating a NUMA-aware pool
+ *
+ * @param thread_num    maximum thread number
+ * @param entry_num     minimal number of entires
+ * @param entry_size    size of each entry
+ * @param numa_num      number of NUMA nodes
+ *
+ * @return needed memory space (in bytes)
+ */
+#define cached_pool_memsize_numa(thread_num, entry_num, entry_size, numa_num)  \
     (sizeof(cached_pool_t) + sizeof(cached_pool_vunit_t) * (thread_num) +      \
-     sizeof(cached_pool_buffer_t) + sizeof(void *) * (thread_num)*2 +          \
+     (numa_num) * (sizeof(cached_pool_buffer_t) +                              \
+                   sizeof(cached_pool_slot_t) * (thread_num)*4 +               \
+                   VSYNC_CACHELINE_SIZE) +                                     \
      (thread_num) * ((((entry_num)-1U) / (thread_num) + 1U) << 1U) *           \
          ((entry_size) + sizeof(void *)))
 
 /**
- * Initialize the pool
+ * Initialize a NUMA-aware pool
  *
- * Make sure the buffer has enough size (calculated by cached_pool_memsize)
+ * Make sure the buffer has enough size (calculated by
+ * cached_pool_memsize_numa). Thread `id` starts on node `id % numa_num`.
  *
  * @param buf           pointer to the buffer
  * @param thread_num    maximum thread number
  * @param entry_num     minimal number of entires
  * @param entry_size    size of each entry
+ * @param numa_num      number of NUMA nodes
  *
  * @return a pointer of the pool structure
  */
-static cached_pool_t *
-cached_pool_init(void *buf, vuint32_t thread_num, vuint32_t entry_num,
-                 vsize_t entry_size)
+static inline cached_pool_t *
+cached_pool_init_numa(void *buf, vuint32_t thread_num, vuint32_t entry_num,
+                      vsize_t entry_size, vuint32_t numa_num)
 {
     vsize_t cached_pool_head  = sizeof(cached_pool_t);
-    vsize_t buffer_head       = sizeof(cached_pool_buffer_t);
-    vsize_t buffer_size       = buffer_head + (sizeof(void *) * thread_num * 2);
-    vuint32_t node_num        = (v_pow2_round_up(thread_num * 2));
+    /* every buffer can hold all batches */
+    vuint32_t slot_num        = (v_pow2_round_up(thread_num * 2));
+    vsize_t buffer_stride     = CACHED_POOL_BUFFER_STRIDE(slot_num);
+    vsize_t buffer_size       = buffer_stride * numa_num;
     vuint32_t threshold       = ((entry_num - 1) / thread_num + 1);
     vsize_t vunit_size        = sizeof(cached_pool_vunit_t);
     vsize_t vunits_size       = vunit_size * thread_num;
@@ -236,20 +427,32 @@ cached_pool_init(void *buf, vuint32_t thread_num, vuint32_t entry_num,
     a->buf     = (cached_pool_buffer_t *)(((vuintptr_t)a) + buf_addr_offset);
     a->entries = (cached_pool_entry_t *)(((vuintptr_t)a) + entry_addr_offset);
     a->conf.entry_space    = entry_size + sizeof(void *);
-    a->conf.buffer_mask    = node_num - 1;
+    a->conf.buffer_mask    = slot_num - 1;
+    a->conf.buffer_max     = slot_num;
+    a->conf.numa_num       = numa_num;
+    a->conf.thread_num     = thread_num;
+    a->conf.buffer_stride  = buffer_stride;
     a->conf.threshold_init = threshold;
     a->conf.threshold_link = threshold + 1;
     a->conf.threshold_max  = threshold * CACHED_POOL_MAX_THRESHOLD_FACTOR;
 
-    _cached_pool_buffer_init(a->buf);
+    _cached_pool_buffers_init(a, slot_num);
+    caslock_init(&a->elastic.lock);
+    a->elastic.head               = NULL;
+    a->elastic.tail               = NULL;
+    a->elastic.slab_entries       = 0;
+    a->elastic.mem_lib.free_fun   = NULL;
+    a->elastic.mem_lib.malloc_fun = NULL;
+    a->elastic.mem_lib.arg        = NULL;
 
     for (vuint32_t id = 0; id < thread_num; id++) {
-        vuint32_t start  = id * a->conf.threshold_max;
-        vuint32_t middle = start + a->conf.threshold_init;
-        vuint32_t end    = middle + a->conf.threshold_init;
+        vuint32_t start          = id * a->conf.threshold_max;
+        vuint32_t middle         = start + a->conf.threshold_init;
+        vuint32_t end            = middle + a->conf.threshold_init;
+        cached_pool_buffer_t *nb = _cached_pool_buffer_find(a, id % numa_num);
 
         _cached_pool_vunit_init(
-            a, &a->vunits[id], a->buf,
+            a, &a->vunits[id], nb,
             _cached_pool_entry_find(a->entries, a->conf.entry_space, start));
         for (vuint32_t idx = start; idx < middle - 1; idx++) {
             cached_pool_entry_t *curr =
@@ -264,7 +467,7 @@ cached_pool_init(void *buf, vuint32_t thread_num, vuint32_t entry_num,
                                     NULL);
 
         _cached_pool_buffer_free(
-            a, a->buf,
+            a, nb,
             _cached_pool_entry_find(a->entries, a->conf.entry_space, middle));
         for (vuint32_t idx = middle; idx < end - 1; idx++) {
             cached_pool_entry_t *curr =
@@ -280,6 +483,46 @@ cached_pool_init(void *buf, vuint32_t thread_num, vuint32_t entry_num,
     return a;
 }
 
+/**
+ * Initialize the pool
+ *
+ * Make sure the buffer has enough size (calculated by cached_pool_memsize)
+ *
+ * @param buf           pointer to the buffer
+ * @param thread_num    maximum thread number
+ * @param entry_num     minimal number of entires
+ * @param entry_size    size of each entry
+ *
+ * @return a pointer of the pool structure
+ */
+static inline cached_pool_t *
+cached_pool_init(void *buf, vuint32_t thread_num, vuint32_t entry_num,
+                 vsize_t entry_size)
+{
+    return cached_pool_init_numa(buf, thread_num, entry_num, entry_size, 1U);
+}
+
+/**
+ * Set the NUMA node of a thread
+ *
+ * The thread spills to and refills from the shared buffer of `node`.
+ *
+ * Cannot be called from different threads with the same id
+ *
+ * @param a     pointer to the pool data structure
+ * @param id    thread ID
+ * @param node  NUMA node where the thread is hosted, `< numa_num`
+ */
+static inline void
+cached_pool_set_node(cached_pool_t *a, vuint32_t id, vuint32_t node)
+{
+    cached_pool_vunit_t *u = _cached_pool_vunit_find(a, id);
+
+    ASSERT(node < a->conf.numa_num);
+    u->node = node;
+    u->buf  = _cached_pool_buffer_find(a, node);
+}
+
 /**
  * Allocate an entry
  *
@@ -301,6 +544,9 @@ cached_pool_alloc(cached_pool_t *a, vuint32_t id)
  *
  * Cannot be called from different threads with the same id
  *
+ * With `CACHED_POOL_REMOTE_FREE`, an entry allocated with another id is
+ * pushed onto the remote-free list of that id.
+ *
  * @param a         pointer to the pool data structure
  * @param id        thread ID
  * @param p         address of the allocated entry
@@ -309,7 +555,373 @@ cached_pool_alloc(cached_pool_t *a, vuint32_t id)
 static inline void
 cached_pool_free(cached_pool_t *a, vuint32_t id, void *p)
 {
+#if defined(CACHED_POOL_REMOTE_FREE)
+    cached_pool_entry_t *e = _cached_pool_entry_from_addr(p);
+    vuint32_t owner        = _cached_pool_entry_get_owner(e);
+    if (unlikely(owner != id)) {
+        quack_push(&_cached_pool_vunit_find(a, owner)->remote,
+                   (quack_node_t *)e);
+        return;
+    }
+#endif
     _cached_pool_vunit_free(a, _cached_pool_vunit_find(a, id), p);
 }
+
+/**
+ * Create an elastic NUMA-aware pool
+ *
+ * Same as `cached_pool_create` with one shared buffer per NUMA node, each
+ * holding at most `max_free` free entries. Thread `id` starts on node
+ * `id % numa_num`.
+ *
+ * @param thread_num    maximum thread number
+ * @param slab_entries  minimal number of entries per slab
+ * @param entry_size    size of each entry
+ * @param max_free      high-water mark of free entries in each shared buffer
+ * @param numa_num      number of NUMA nodes
+ * @param mem_lib       object of type `vmem_lib_t`
+ *
+ * @return a pointer of the pool structure (NULL if out of memory)
+ */
+static inline cached_pool_t *
+cached_pool_create_numa(vuint32_t thread_num, vuint32_t slab_entries,
+                        vsize_t entry_size, vuint32_t max_free,
+                        vuint32_t numa_num, vmem_lib_t mem_lib)
+{
+    ASSERT(thread_num != 0);
+    ASSERT(slab_entries != 0);
+    ASSERT(numa_num != 0);
+    ASSERT(vmem_lib_not_null(&mem_lib));
+
+    vuint32_t threshold   = ((slab_entries - 1) / thread_num + 1);
+    vuint32_t batch_max   = max_free / threshold;
+    vuint32_t slot_num    = v_pow2_round_up(batch_max == 0 ? 1U : batch_max);
+    vsize_t buffer_stride = CACHED_POOL_BUFFER_STRIDE(slot_num);
+    vsize_t vunits_size   = sizeof(cached_pool_vunit_t) * thread_num;
+    vsize_t buf_offset    = sizeof(cached_pool_t) + vunits_size;
+    vsize_t size          = buf_offset + buffer_stride * numa_num;
+
+    cached_pool_t *a = (cached_pool_t *)mem_lib.malloc_fun(size, mem_lib.arg);
+    if (a == NULL) {
+        return NULL;
+    }
+    a->buf     = (cached_pool_buffer_t *)(((vuintptr_t)a) + buf_offset);
+    a->entries = NULL;
+    /* room for the slab pointer at the end of each entry */
+    a->conf.entry_space =
+        v_least_containing_multiple(entry_size, sizeof(void *)) +
+        sizeof(void *) * 2U;
+    a->conf.buffer_mask    = slot_num - 1;
+    a->conf.buffer_max     = batch_max;
+    a->conf.numa_num       = numa_num;
+    a->conf.thread_num     = thread_num;
+    a->conf.buffer_stride  = buffer_stride;
+    a->conf.threshold_init = threshold;
+    a->conf.threshold_link = threshold + 1;
+    a->conf.threshold_max  = threshold * CACHED_POOL_MAX_THRESHOLD_FACTOR;
+
+    _cached_pool_buffers_init(a, slot_num);
+    caslock_init(&a->elastic.lock);
+    a->elastic.head         = NULL;
+    a->elastic.tail         = NULL;
+    a->elastic.slab_entries = threshold * thread_num;
+    vmem_lib_copy(&a->elastic.mem_lib, &mem_lib);
+
+    for (vuint32_t id = 0; id < thread_num; id++) {
+        _cached_pool_vunit_init(a, &a->vunits[id],
+                                _cached_pool_buffer_find(a, id % numa_num),
+                                NULL);
+        a->vunits[id].cnt = 0;
+    }
+    return a;
+}
+
+/**
+ * Create an elastic pool
+ *
+ * The pool starts without entries and takes slabs of `thread_num` batches
+ * from `mem_lib` whenever the vunit of a thread and the shared buffer are
+ * empty. Free entries beyond `max_free` are returned to their slabs, fully
+ * free slabs are returned to `mem_lib`.
+ *
+ * @param thread_num    maximum thread number
+ * @param slab_entries  minimal number of entries per slab
+ * @param entry_size    size of each entry
+ * @param max_free      high-water mark of free entries in the shared buffer
+ * @param mem_lib       object of type `vmem_lib_t`
+ *
+ * @return a pointer of the pool structure (NULL if out of memory)
+ */
+static inline cached_pool_t *
+cached_pool_create(vuint32_t thread_num, vuint32_t slab_entries,
+                   vsize_t entry_size, vuint32_t max_free, vmem_lib_t mem_lib)
+{
+    return cached_pool_create_numa(thread_num, slab_entries, entry_size,
+                                   max_free, 1U, mem_lib);
+}
+
+/**
+ * Destroy an elastic pool
+ *
+ * Returns all slabs and the pool structure to the `vmem_lib_t` given to
+ * `cached_pool_create`.
+ *
+ * @param a     pointer to the pool data structure
+ *
+ * @note call only when no thread uses the pool anymore, entries that are
+ * still allocated become invalid.
+ */
+static inline void
+cached_pool_destroy(cached_pool_t *a)
+{
+    cached_pool_slab_t *s    = NULL;
+    cached_pool_slab_t *next = NULL;
+    vmem_lib_t mem_lib;
+
+    ASSERT(a);
+    ASSERT(vmem_lib_not_null(&a->elastic.mem_lib));
+
+    vmem_lib_copy(&mem_lib, &a->elastic.mem_lib);
+    for (s = a->elastic.head; s != NULL; s = next) {
+        next = s->next;
+        mem_lib.free_fun(s, mem_lib.arg);
+    }
+    mem_lib.free_fun(a, mem_lib.arg);
+}
+
+/********************************* slab ***************************************/
+/* pops up to `max` entries of `s` into `list`, returns how many */
+static inline vuint32_t
+_cached_pool_slab_pop(cached_pool_slab_t *s, cached_pool_entry_t **list,
+                      vuint32_t max)
+{
+    cached_pool_entry_t *e = NULL;
+    vuint32_t n            = 0;
+
+    while (n < max && s->nfree != 0) {
+        e       = s->free;
+        s->free = _cached_pool_entry_get_next(e);
+        s->nfree--;
+        _cached_pool_entry_set_next(e, *list);
+        *list = e;
+        n++;
+    }
+    return n;
+}
+
+static inline void
+_cached_pool_slab_unlink(cached_pool_elastic_t *el, cached_pool_slab_t *s)
+{
+    if (s->prev != NULL) {
+        s->prev->next = s->next;
+    } else {
+        el->head = s->next;
+    }
+    if (s->next != NULL) {
+        s->next->prev = s->prev;
+    } else {
+        el->tail = s->prev;
+    }
+}
+
+static inline void
+_cached_pool_slab_push_head(cached_pool_elastic_t *el, cached_pool_slab_t *s)
+{
+    s->prev = NULL;
+    s->next = el->head;
+    if (el->head != NULL) {
+        el->head->prev = s;
+    } else {
+        el->tail = s;
+    }
+    el->head = s;
+}
+
+static inline void
+_cached_pool_slab_push_tail(cached_pool_elastic_t *el, cached_pool_slab_t *s)
+{
+    s->next = NULL;
+    s->prev = el->tail;
+    if (el->tail != NULL) {
+        el->tail->next = s;
+    } else {
+        el->head = s;
+    }
+    el->tail = s;
+}
+
+/* allocates a slab and pops up to `max` of its entries into `list` */
+static inline vuint32_t
+_cached_pool_slab_grow(cached_pool_t *a, cached_pool_entry_t **list,
+                       vuint32_t max)
+{
+    cached_pool_elastic_t *el = &a->elastic;
+    cached_pool_slab_t *s     = NULL;
+    cached_pool_entry_t *e    = NULL;
+    vuint32_t n               = 0;
+    vsize_t size = sizeof(cached_pool_slab_t) +
+                   (vsize_t)el->slab_entries * a->conf.entry_space;
+
+    s = (cached_pool_slab_t *)el->mem_lib.malloc_fun(size, el->mem_lib.arg);
+    if (s == NULL) {
+        return 0;
+    }
+    s->free  = NULL;
+    s->nfree = el->slab_entries;
+    s->num   = el->slab_entries;
+    for (vuint32_t idx = 0; idx < s->num; idx++) {
+        e = _cached_pool_entry_find(s + 1, a->conf.entry_space, idx);
+        _cached_pool_entry_set_slab(a, e, s);
+        _cached_pool_entry_set_next(e, s->free);
+        s->free = e;
+    }
+    /* the slab is private until linked */
+    n = _cached_pool_slab_pop(s, list, max);
+
+    caslock_acquire(&el->lock);
+    if (s->nfree != 0) {
+        _cached_pool_slab_push_head(el, s);
+    } else {
+        _cached_pool_slab_push_tail(el, s);
+    }
+    caslock_release(&el->lock);
+    return n;
+}
+
+/* takes a batch from the slabs, allocating a new slab if none has free
+ * entries */
+static inline cached_pool_entry_t *
+_cached_pool_slab_alloc(cached_pool_t *a, cached_pool_vunit_t *u)
+{
+    cached_pool_elastic_t *el = &a->elastic;
+    cached_pool_entry_t *list = NULL;
+    cached_pool_slab_t *s     = NULL;
+    vuint32_t n               = 0;
+
+    caslock_acquire(&el->lock);
+    while (n < a->conf.threshold_init && (s = el->head) != NULL &&
+           s->nfree != 0) {
+        n += _cached_pool_slab_pop(s, &list, a->conf.threshold_init - n);
+        if (s->nfree == 0) {
+            _cached_pool_slab_unlink(el, s);
+            _cached_pool_slab_push_tail(el, s);
+        }
+    }
+    caslock_release(&el->lock);
+
+    if (n == 0) {
+        n = _cached_pool_slab_grow(a, &list, a->conf.threshold_init);
+    }
+    u->cnt = n;
+    return list;
+}
+
+/* returns a batch to its slabs, releasing slabs that become fully free */
+static inline void
+_cached_pool_slab_free(cached_pool_t *a, cached_pool_entry_t *es)
+{
+    cached_pool_elastic_t *el    = &a->elastic;
+    cached_pool_slab_t *released = NULL;
+    cached_pool_slab_t *s        = NULL;
+    cached_pool_entry_t *e       = NULL;
+
+    caslock_acquire(&el->lock);
+    while (es != NULL) {
+        e  = es;
+        es = _cached_pool_entry_get_next(e);
+        s  = _cached_pool_entry_get_slab(a, e);
+        _cached_pool_entry_set_next(e, s->free);
+        s->free = e;
+        s->nfree++;
+        if (s->nfree == 1U || s->nfree == s->num) {
+            _cached_pool_slab_unlink(el, s);
+        }
+        if (s->nfree == s->num) {
+            s->next  = released;
+            released = s;
+        } else if (s->nfree == 1U) {
+            _cached_pool_slab_push_head(el, s);
+        }
+    }
+    caslock_release(&el->lock);
+
+    while (released != NULL) {
+        s        = released;
+        released = s->next;
+        el->mem_lib.free_fun(s, el->mem_lib.arg);
+    }
+}
+
+/************************** vunit slow path ***********************************/
+#if defined(CACHED_POOL_REMOTE_FREE)
+/*
+ * takes the entries freed by other threads to the vunit `from` into `u`,
+ * returns the top of `u`, NULL if it is still empty
+ */
+static inline cached_pool_entry_t *
+_cached_pool_vunit_drain(cached_pool_t *a, cached_pool_vunit_t *u,
+                         cached_pool_vunit_t *from)
+{
+    quack_node_t *n    = quack_popall(&from->remote);
+    quack_node_t *next = NULL;
+
+    /* push one by one, spilling batches if the list is long */
+    for (; n != NULL; n = next) {
+        next = n->next;
+        _cached_pool_vunit_free(
+            a, u, _cached_pool_entry_to_addr((cached_pool_entry_t *)n));
+    }
+    return u->top;
+}
+#endif
+
+static inline void *
+_cached_pool_vunit_refill(cached_pool_t *a, cached_pool_vunit_t *u)
+{
+    cached_pool_entry_t *es = NULL;
+#if defined(CACHED_POOL_REMOTE_FREE)
+    es = _cached_pool_vunit_drain(a, u, u);
+    if (es != NULL) {
+        return es;
+    }
+#endif
+    es = _cached_pool_buffer_alloc(a, u->buf);
+    /* steal from the other nodes only if the local one is empty */
+    for (vuint32_t i = 1; es == NULL && i < a->conf.numa_num; i++) {
+        es = _cached_pool_buffer_alloc(
+            a, _cached_pool_buffer_find(a, (u->node + i) % a->conf.numa_num));
+    }
+    if (es != NULL) {
+        u->cnt = a->conf.threshold_init;
+        return es;
+    }
+#if defined(CACHED_POOL_REMOTE_FREE)
+    /* adopt the lists of threads that stopped allocating */
+    for (vuint32_t i = 1; i < a->conf.thread_num; i++) {
+        es = _cached_pool_vunit_drain(
+            a, u, &a->vunits[(u->id + i) % a->conf.thread_num]);
+        if (es != NULL) {
+            return es;
+        }
+    }
+#endif
+    if (!vmem_lib_not_null(&a->elastic.mem_lib)) {
+        return NULL;
+    }
+    return _cached_pool_slab_alloc(a, u);
+}
+
+static inline void
+_cached_pool_vunit_spill(cached_pool_t *a, cached_pool_vunit_t *u,
+                         cached_pool_entry_t *es)
+{
+    if (!_cached_pool_buffer_free(a, u->buf, es)) {
+        /* only elastic pools give up, at the high-water mark or on a slot
+         * whose previous round is in progress */
+        ASSERT(vmem_lib_not_null(&a->elastic.mem_lib));
+        _cached_pool_slab_free(a, es);
+    }
+}
 #undef CACHED_POOL_MAX_THRESHOLD_FACTOR
+#undef CACHED_POOL_BUFFER_STRIDE
 #endif
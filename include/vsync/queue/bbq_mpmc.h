@@ -14,8 +14,33 @@
  * ### Remarks:
  *
  * In this implementation, values have the fixed size (pointer size).
- * This implementation does not support `DROP_OLD` mode as described in the
- * original paper.
+ *
+ * By default the queue runs in the `RETRY_NEW` mode of the original paper:
+ * enqueue fails (or waits) while the queue is full. A queue initialized with
+ * `bbq_mpmc_init_mode(q, size, BBQ_MODE_DROP_OLD)` instead overwrites the
+ * oldest block, so producers never wait for consumers. Consumers skip the
+ * overwritten entries, which are accounted by `bbq_mpmc_dropped_count`.
+ * `BBQ_MPMC_COUNT` is meaningless in `DROP_OLD` mode.
+ *
+ * Alternatively, the queue can carry variable-size records with
+ * `bbq_mpmc_enqueue_record` and `bbq_mpmc_dequeue_record`. Records are copied
+ * inline into the blocks, prefixed with their length, so no per-record
+ * allocation is needed. A record never spans two blocks, hence its length is
+ * bounded by `bbq_mpmc_record_max_len`. A queue must be used either with
+ * records or with fixed-size values, never with both.
+ *
+ * Both flavors have a zero-copy variant. `bbq_mpmc_reserve` and
+ * `bbq_mpmc_reserve_record` hand out a span of the ring to be written in place
+ * and published with `bbq_mpmc_commit`. `bbq_mpmc_peek` and
+ * `bbq_mpmc_peek_record` hand out a span to be read in place and returned with
+ * `bbq_mpmc_release`. In `DROP_OLD` mode a claimed span can be overwritten
+ * while it is read, which `bbq_mpmc_release` reports.
+ *
+ * With `wait` set, callers spin until space or entries are available.
+ * Define `BBQ_PARK` to park them on a futex once `VPARK_MAX_SPIN` retries
+ * failed. Producers and consumers then pay a full fence per commit and
+ * release, but only issue the wake syscall if somebody is parked.
+ * On linux compile with `-D_GNU_SOURCE`.
  *
  * @cite [BBQ: A Block-based Bounded Queue for Exchanging Data and
  * Profiling](https://www.usenix.org/conference/atc22/presentation/wang-jiawei)
@@ -69,8 +94,12 @@ typedef struct bbq_mpmc_block_s {
 
 typedef struct bbq_mpmc_s {
     bbq_config_t config VSYNC_CACHEALIGN;
+    vatomic64_t dropped; /* rarely written, only in DROP_OLD mode */
     vatomic64_t widx VSYNC_CACHEALIGN;
     vatomic64_t ridx VSYNC_CACHEALIGN;
+#if defined(BBQ_PARK)
+    vpark_t park VSYNC_CACHEALIGN;
+#endif
     vuint8_t blk[] VSYNC_CACHEALIGN;
 } bbq_mpmc_t;
 
@@ -91,6 +120,24 @@ static inline vbool_t _bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t **buf,
                                         vuint32_t *count);
 static inline void _bbq_mpmc_block_init(bbq_mpmc_block_t *blk, vsize_t idx,
                                         vuint16_t block_size);
+static inline vbool_t _bbq_mpmc_enqueue_record(bbq_mpmc_t *q, const void *data,
+                                               vuint32_t len, vbool_t *done);
+static inline vbool_t _bbq_mpmc_dequeue_record(bbq_mpmc_t *q, void *buf,
+                                               vuint32_t buf_len,
+                                               vuint32_t *len, vbool_t *done);
+static inline vbool_t _bbq_mpmc_reserve(bbq_mpmc_t *q, vsize_t size,
+                                        bbq_span_t *span);
+static inline vbool_t _bbq_mpmc_peek(bbq_mpmc_t *q, vsize_t size,
+                                     bbq_span_t *span);
+static inline vbool_t _bbq_mpmc_reserve_record(bbq_mpmc_t *q, vuint32_t len,
+                                               bbq_span_t *span);
+static inline vbool_t _bbq_mpmc_peek_record(bbq_mpmc_t *q, vuint32_t max_len,
+                                            bbq_span_t *span);
+static inline vbool_t _bbq_mpmc_advance_widx(bbq_mpmc_t *q, vuint64_t widx);
+static inline vbool_t _bbq_mpmc_advance_ridx(bbq_mpmc_t *q, vuint64_t ridx,
+                                             vuint64_t reserved);
+static inline vbool_t _bbq_mpmc_consume(bbq_mpmc_t *q, bbq_mpmc_block_t *blk,
+                                        vuint64_t reserved, vsize_t size);
 
 /**
  * Enqueues one or more entries.
@@ -126,7 +173,7 @@ bbq_mpmc_enqueue(bbq_mpmc_t *q, vuintptr_t *buf, vuint32_t count, vbool_t wait)
          * It is sufficient to observe retry only
          *
          */
-        await_while (!retry && wait && rest)
+        bbq_await_while (q, !retry && wait && rest)
             retry = _bbq_mpmc_enqueue(q, &rest_buf, &rest);
     } while (retry);
 
@@ -167,13 +214,256 @@ bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t *buf, vuint32_t count, vbool_t wait)
          * It is sufficient to observe retry only
          *
          */
-        await_while (!retry && wait && rest)
+        bbq_await_while (q, !retry && wait && rest)
             retry = _bbq_mpmc_dequeue(q, &rest_buf, &rest);
     } while (retry);
 
     return count - rest;
 }
 
+/**
+ * Returns the maximum payload length of a record.
+ *
+ * @param q address of `bbq_mpmc_t` object.
+ * @return maximum length in bytes accepted by `bbq_mpmc_enqueue_record`.
+ */
+static inline vuint32_t
+bbq_mpmc_record_max_len(bbq_mpmc_t *q)
+{
+    return BBQ_RECORD_MAX_LEN(q, bbq_mpmc_block_t);
+}
+
+/**
+ * Enqueues a variable-size record.
+ *
+ * The payload is copied into the queue after a length header. If the record
+ * does not fit in the rest of the current block, the rest is padded and the
+ * record goes into the next block.
+ *
+ * @param q    address of `bbq_mpmc_t` object.
+ * @param data address of the payload.
+ * @param len  length of the payload in bytes.
+ * @param wait should wait for space to be available.
+ *
+ * @return true the record was enqueued.
+ * @return false the queue is full, or `len > bbq_mpmc_record_max_len(q)`.
+ */
+static inline vbool_t
+bbq_mpmc_enqueue_record(bbq_mpmc_t *q, const void *data, vuint32_t len,
+                        vbool_t wait)
+{
+    vbool_t done = false;
+    vbool_t retry;
+
+    if (unlikely(len > bbq_mpmc_record_max_len(q))) {
+        return false;
+    }
+    do {
+        retry = _bbq_mpmc_enqueue_record(q, data, len, &done);
+        bbq_await_while (q, !retry && wait && !done)
+            retry = _bbq_mpmc_enqueue_record(q, data, len, &done);
+    } while (retry);
+
+    return done;
+}
+
+/**
+ * Dequeues a variable-size record.
+ *
+ * @param q       address of `bbq_mpmc_t` object.
+ * @param buf     address of the preallocated memory for the payload.
+ * @param buf_len size of `buf` in bytes.
+ * @param len     output parameter, length of the payload in bytes.
+ * @param wait    should wait for a record to be available.
+ *
+ * @return true a record was dequeued and copied into `buf`.
+ * @return false the queue is empty, or the next record does not fit in `buf`.
+ * In the latter case `*len > buf_len` holds the length of the record, which
+ * remains in the queue.
+ */
+static inline vbool_t
+bbq_mpmc_dequeue_record(bbq_mpmc_t *q, void *buf, vuint32_t buf_len,
+                        vuint32_t *len, vbool_t wait)
+{
+    vbool_t done = false;
+    vbool_t retry;
+
+    *len = 0;
+    do {
+        retry = _bbq_mpmc_dequeue_record(q, buf, buf_len, len, &done);
+        bbq_await_while (q, !retry && wait && !done && *len <= buf_len)
+            retry = _bbq_mpmc_dequeue_record(q, buf, buf_len, len, &done);
+    } while (retry);
+
+    return done;
+}
+
+/**
+ * Reserves space for up to `count` entries to be written in place.
+ *
+ * The span never crosses a block boundary, so fewer entries than requested
+ * might be reserved. The caller writes the entries at `span->data` and
+ * publishes them with `bbq_mpmc_commit`. Consumers cannot pass an uncommitted
+ * span, so the window between reserve and commit should be short.
+ *
+ * @param q     address of `bbq_mpmc_t` object.
+ * @param count number of entries to reserve.
+ * @param span  output parameter, the reserved span.
+ * @param wait  should wait for space to be available.
+ *
+ * @return number of reserved entries, `0` if the queue is full.
+ */
+static inline vuint32_t
+bbq_mpmc_reserve(bbq_mpmc_t *q, vuint32_t count, bbq_span_t *span,
+                 vbool_t wait)
+{
+    vsize_t size = (vsize_t)count << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry;
+
+    span->size = 0;
+    if (count == 0) {
+        return 0;
+    }
+    do {
+        retry = _bbq_mpmc_reserve(q, size, span);
+        bbq_await_while (q, !retry && wait && span->size == 0)
+            retry = _bbq_mpmc_reserve(q, size, span);
+    } while (retry && span->size == 0);
+
+    return span->size >> BBQ_ENTRY_SIZE_LOG;
+}
+
+/**
+ * Publishes a span obtained with `bbq_mpmc_reserve` or
+ * `bbq_mpmc_reserve_record`.
+ *
+ * @param q    address of `bbq_mpmc_t` object.
+ * @param span address of the reserved span.
+ */
+static inline void
+bbq_mpmc_commit(bbq_mpmc_t *q, bbq_span_t *span)
+{
+    bbq_mpmc_block_t *blk = span->blk;
+    ASSERT(span->size != 0);
+    vatomic64_add(&blk->committed, span->size);
+    BBQ_NOTIFY(q);
+    V_UNUSED(q);
+}
+
+/**
+ * Claims up to `count` entries to be read in place.
+ *
+ * The span never crosses a block boundary, so fewer entries than available
+ * might be claimed. The caller reads the entries at `span->data` and returns
+ * the space with `bbq_mpmc_release`.
+ *
+ * @param q     address of `bbq_mpmc_t` object.
+ * @param count number of entries to claim.
+ * @param span  output parameter, the claimed span.
+ * @param wait  should wait for entries to be available.
+ *
+ * @return number of claimed entries, `0` if the queue is empty.
+ */
+static inline vuint32_t
+bbq_mpmc_peek(bbq_mpmc_t *q, vuint32_t count, bbq_span_t *span, vbool_t wait)
+{
+    vsize_t size = (vsize_t)count << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry;
+
+    span->size = 0;
+    if (count == 0) {
+        return 0;
+    }
+    do {
+        retry = _bbq_mpmc_peek(q, size, span);
+        bbq_await_while (q, !retry && wait && span->size == 0)
+            retry = _bbq_mpmc_peek(q, size, span);
+    } while (retry && span->size == 0);
+
+    return span->size >> BBQ_ENTRY_SIZE_LOG;
+}
+
+/**
+ * Returns the space of a span obtained with `bbq_mpmc_peek` or
+ * `bbq_mpmc_peek_record` to the producers.
+ *
+ * @param q    address of `bbq_mpmc_t` object.
+ * @param span address of the claimed span.
+ *
+ * @return true the span was read intact.
+ * @return false the span was overwritten while it was read, which only
+ * happens in `BBQ_MODE_DROP_OLD` mode. The caller must discard what it read,
+ * the entries are accounted as dropped.
+ */
+static inline vbool_t
+bbq_mpmc_release(bbq_mpmc_t *q, bbq_span_t *span)
+{
+    ASSERT(span->size != 0);
+    return _bbq_mpmc_consume(q, span->blk, span->cursor, span->size);
+}
+
+/**
+ * Reserves space for a record of `len` bytes to be written in place.
+ *
+ * On success the caller writes the payload at `span->data` and publishes the
+ * record with `bbq_mpmc_commit`.
+ *
+ * @param q    address of `bbq_mpmc_t` object.
+ * @param len  length of the payload in bytes.
+ * @param span output parameter, the reserved payload.
+ * @param wait should wait for space to be available.
+ *
+ * @return true the record was reserved.
+ * @return false the queue is full, or `len > bbq_mpmc_record_max_len(q)`.
+ */
+static inline vbool_t
+bbq_mpmc_reserve_record(bbq_mpmc_t *q, vuint32_t len, bbq_span_t *span,
+                        vbool_t wait)
+{
+    vbool_t retry;
+
+    span->size = 0;
+    if (unlikely(len > bbq_mpmc_record_max_len(q))) {
+        return false;
+    }
+    do {
+        retry = _bbq_mpmc_reserve_record(q, len, span);
+        bbq_await_while (q, !retry && wait && span->size == 0)
+            retry = _bbq_mpmc_reserve_record(q, len, span);
+    } while (retry && span->size == 0);
+
+    return span->size != 0;
+}
+
+/**
+ * Claims the next record to be read in place.
+ *
+ * On success `span->data` and `span->len` hold the payload, the caller
+ * returns the space with `bbq_mpmc_release`.
+ *
+ * @param q    address of `bbq_mpmc_t` object.
+ * @param span output parameter, the claimed payload.
+ * @param wait should wait for a record to be available.
+ *
+ * @return true a record was claimed.
+ * @return false the queue is empty.
+ */
+static inline vbool_t
+bbq_mpmc_peek_record(bbq_mpmc_t *q, bbq_span_t *span, vbool_t wait)
+{
+    vbool_t retry;
+
+    span->size = 0;
+    do {
+        /* any length fits */
+        retry = _bbq_mpmc_peek_record(q, VUINT32_MAX, span);
+        bbq_await_while (q, !retry && wait && span->size == 0)
+            retry = _bbq_mpmc_peek_record(q, VUINT32_MAX, span);
+    } while (retry && span->size == 0);
+
+    return span->size != 0;
+}
+
 /**
  * Calculates the size of the bbq queue.
  *
@@ -196,15 +486,16 @@ bbq_mpmc_memsize(vsize_t capacity)
     return mem_buf;
 }
 /**
- * Initializes a bbq data structure.
+ * Initializes a bbq data structure in the given mode.
  *
  * @param q pointer to bbq data structure.
  * @param size number of bytes allocated for bbq data structure.
+ * @param mode `BBQ_MODE_RETRY_NEW` or `BBQ_MODE_DROP_OLD`.
  * @return true initialization succeeded.
  * @return false initialization failed.
  */
 static inline vbool_t
-bbq_mpmc_init(bbq_mpmc_t *q, vsize_t size)
+bbq_mpmc_init_mode(bbq_mpmc_t *q, vsize_t size, bbq_mode_t mode)
 {
     if (unlikely(q == NULL) || unlikely(BBQ_ENTRY_SIZE < BBQ_MIN_ENTRY_SIZE) ||
         unlikely(BBQ_ENTRY_SIZE > BBQ_MAX_ENTRY_SIZE) ||
@@ -226,14 +517,47 @@ bbq_mpmc_init(bbq_mpmc_t *q, vsize_t size)
     }
     (q)->config.blk_size     = blk_size;
     (q)->config.blk_size_log = blk_size_log;
+    (q)->config.mode         = mode;
     BBQ_MPMC_WRITE_PROD((q)->widx, 0);
     BBQ_MPMC_WRITE_CONS((q)->ridx, 0);
+    vatomic64_write(&(q)->dropped, 0);
+#if defined(BBQ_PARK)
+    vpark_init(&(q)->park);
+#endif
     for (vsize_t i = 0; i < (1UL << BBQ_BLOCK_NUM_LOG); i++) {
         _bbq_mpmc_block_init(
             (bbq_mpmc_block_t *)((q)->blk + (i << blk_size_log)), i, blk_size);
     }
     return true;
 }
+/**
+ * Initializes a bbq data structure in `BBQ_MODE_RETRY_NEW` mode.
+ *
+ * @param q pointer to bbq data structure.
+ * @param size number of bytes allocated for bbq data structure.
+ * @return true initialization succeeded.
+ * @return false initialization failed.
+ */
+static inline vbool_t
+bbq_mpmc_init(bbq_mpmc_t *q, vsize_t size)
+{
+    return bbq_mpmc_init_mode(q, size, BBQ_MODE_RETRY_NEW);
+}
+/**
+ * Returns the number of entries lost in `BBQ_MODE_DROP_OLD` mode.
+ *
+ * Counts the entries that were overwritten before a consumer dequeued them.
+ * Records are counted in entries of `BBQ_ENTRY_SIZE` bytes, including the
+ * padding at the end of blocks.
+ *
+ * @param q address of `bbq_mpmc_t` object.
+ * @return number of dropped entries.
+ */
+static inline vuint64_t
+bbq_mpmc_dropped_count(bbq_mpmc_t *q)
+{
+    return vatomic64_read(&q->dropped);
+}
 
 static inline void
 _bbq_mpmc_block_init(bbq_mpmc_block_t *blk, vsize_t idx, vuint16_t block_size)
@@ -246,13 +570,10 @@ _bbq_mpmc_block_init(bbq_mpmc_block_t *blk, vsize_t idx, vuint16_t block_size)
     vatomic64_write(&blk->consumed, init_value);
 }
 
-/* return means retry */
+/* return means retry, `span->size != 0` if space was reserved */
 static inline vbool_t
-_bbq_mpmc_enqueue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
+_bbq_mpmc_reserve(bbq_mpmc_t *q, vsize_t size, bbq_span_t *span)
 {
-    if (*count == 0) {
-        return false;
-    }
     /* get the address of the alloc block */
     vuint64_t widx        = vatomic64_read(&q->widx);
     vuint16_t block_idx   = BBQ_GLOBAL_IDX(widx);
@@ -261,49 +582,145 @@ _bbq_mpmc_enqueue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
     vuint16_t block_size      = q->config.blk_size;
     vuint64_t allocated       = vatomic64_read(&blk->allocated);
     vuint64_t allocated_space = BBQ_LOCAL_IDX(allocated);
-    vsize_t entry_total_size  = (*count) << BBQ_ENTRY_SIZE_LOG;
     /* if out of bound, we don't add the space, but help to move the block */
     if (likely(allocated_space < block_size)) {
         /* update the allocated index using FAA */
-        vuint64_t old_allocated =
-            vatomic64_get_add(&blk->allocated, entry_total_size);
+        vuint64_t old_allocated = vatomic64_get_add(&blk->allocated, size);
         /* we have some space */
         vuint64_t old_local_space = BBQ_LOCAL_IDX(old_allocated);
         if (likely(old_local_space < block_size)) {
-            vuint16_t space =
-                VMIN(entry_total_size, block_size - old_local_space);
-            void *entry = BBQ_GET_ENTRY(blk, old_local_space);
-            int r       = memcpy_s(entry, space, *buf, space);
-            BUG_ON(r != 0);
-            vatomic64_add(&blk->committed, space);
-            vuint16_t offset = space >> BBQ_ENTRY_SIZE_LOG;
-            *buf += offset;
-            *count -= offset;
+            vuint16_t space = VMIN(size, block_size - old_local_space);
+            void *entry     = BBQ_GET_ENTRY(blk, old_local_space);
+            if (q->config.mode == BBQ_MODE_DROP_OLD) {
+                /* consumers validate their copy with the allocated cursor */
+                vatomic_fence_rel();
+            }
+            BBQ_SPAN_SET(span, blk, old_allocated, entry, space, space);
             return true;
         }
     }
     /* slow path, all writers help to move to next block */
-    bbq_mpmc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
-    vuint64_t global_vsn   = BBQ_GLOBAL_VSN(widx);
-    if (unlikely(
-            !BBQ_BLOCK_FULLY_CONSUMED_WITH_VSN(nblk, block_size, global_vsn))) {
+    return _bbq_mpmc_advance_widx(q, widx);
+}
+/* return means retry, `span->size != 0` if entries were claimed */
+static inline vbool_t
+_bbq_mpmc_peek(bbq_mpmc_t *q, vsize_t size, bbq_span_t *span)
+{
+    /* get the address of the occupy block */
+    vuint64_t ridx        = vatomic64_read(&q->ridx);
+    vuint16_t block_idx   = BBQ_GLOBAL_IDX(ridx);
+    bbq_mpmc_block_t *blk = BBQ_GET_BLOCK(q, block_idx);
+    /* check if the block is fully reserved */
+    vuint16_t block_size     = q->config.blk_size;
+    vuint64_t reserved       = vatomic64_read(&blk->reserved);
+    vuint64_t reserved_space = BBQ_LOCAL_IDX(reserved);
+    if (likely(reserved_space < block_size)) {
+        vuint64_t committed = vatomic64_read(&blk->committed);
+        if (unlikely(BBQ_LOCAL_VSN(committed) != BBQ_LOCAL_VSN(reserved))) {
+            /* DROP_OLD: producers are reclaiming the block */
+            return true;
+        }
+        /* check if we have an entry to occupy */
+        vuint64_t committed_space = BBQ_LOCAL_IDX(committed);
+        if (unlikely(reserved_space >= committed_space)) {
+            /* Note: the version is strictly monotic and may not wrap. */
+            ASSERT(reserved <= committed && "reserved must be <= committed");
+            return false;
+        }
+        vuint16_t entry_total_size =
+            VMIN(size, committed_space - reserved_space);
+        if (unlikely(committed_space != block_size)) {
+            vuint64_t allocated       = vatomic64_read(&blk->allocated);
+            vuint64_t allocated_space = BBQ_LOCAL_IDX(allocated);
+            if (likely(allocated_space != committed_space)) {
+                return false;
+            }
+        }
+        if (vatomic64_cmpxchg(&blk->reserved, reserved,
+                              reserved + entry_total_size) != reserved) {
+            return true;
+        }
+        /* we got the entry */
+        void *entry = BBQ_GET_ENTRY(blk, reserved_space);
+        BBQ_SPAN_SET(span, blk, reserved, entry, entry_total_size,
+                     entry_total_size);
+        return true;
+    }
+    /* need to advance the block */
+    return _bbq_mpmc_advance_ridx(q, ridx, reserved);
+}
+/* return means retry */
+static inline vbool_t
+_bbq_mpmc_enqueue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
+{
+    bbq_span_t span = {.size = 0};
+
+    if (*count == 0) {
         return false;
     }
-    /* reset cursor and advance block */
-    bbq_reset_block_cursor_heavy(&nblk->committed, global_vsn + 1,
-                                 BBQ_BLOCK_MPMC_INIT_VALUE);
-    bbq_reset_block_cursor_heavy(&nblk->allocated, global_vsn + 1,
-                                 BBQ_BLOCK_MPMC_INIT_VALUE);
-    BBQ_ADVANCE_HEAD(&q->widx, widx, widx + 1);
+    vsize_t entry_total_size = (*count) << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry            = _bbq_mpmc_reserve(q, entry_total_size, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    int r = memcpy_s(span.data, span.size, *buf, span.size);
+    BUG_ON(r != 0);
+    bbq_mpmc_commit(q, &span);
+    vuint16_t offset = span.size >> BBQ_ENTRY_SIZE_LOG;
+    *buf += offset;
+    *count -= offset;
     return true;
 }
 /* return means retry */
 static inline vbool_t
 _bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
 {
+    bbq_span_t span = {.size = 0};
+
     if (*count == 0) {
         return false;
     }
+    vsize_t entry_total_size = (*count) << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry            = _bbq_mpmc_peek(q, entry_total_size, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    int r = memcpy_s(*buf, span.size, span.data, span.size);
+    BUG_ON(r != 0);
+    if (unlikely(!bbq_mpmc_release(q, &span))) {
+        return true;
+    }
+    vuint16_t offset = span.size >> BBQ_ENTRY_SIZE_LOG;
+    *buf += offset;
+    *count -= offset;
+    return true;
+}
+/* return means retry, `span->size != 0` if the record was reserved */
+static inline vbool_t
+_bbq_mpmc_reserve_record(bbq_mpmc_t *q, vuint32_t len, bbq_span_t *span)
+{
+    vsize_t record_size = BBQ_RECORD_SIZE(len);
+    vbool_t retry       = _bbq_mpmc_reserve(q, record_size, span);
+    if (span->size == 0) {
+        return retry;
+    }
+    if (unlikely(span->size != record_size)) {
+        /* we own the tail of the block, pad it and retry on the next block */
+        BBQ_RECORD_LEN(span->data) = BBQ_RECORD_PAD;
+        bbq_mpmc_commit(q, span);
+        span->size = 0;
+        return true;
+    }
+    BBQ_RECORD_LEN(span->data) = len;
+    span->data                 = BBQ_RECORD_DATA(span->data);
+    span->len                  = len;
+    return true;
+}
+/* return means retry, `span->size != 0` if a record was claimed. A record
+ * longer than `max_len` stays in the queue, `span->len` holds its length */
+static inline vbool_t
+_bbq_mpmc_peek_record(bbq_mpmc_t *q, vuint32_t max_len, bbq_span_t *span)
+{
     /* get the address of the occupy block */
     vuint64_t ridx        = vatomic64_read(&q->ridx);
     vuint16_t block_idx   = BBQ_GLOBAL_IDX(ridx);
@@ -314,15 +731,14 @@ _bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
     vuint64_t reserved_space = BBQ_LOCAL_IDX(reserved);
     if (likely(reserved_space < block_size)) {
         vuint64_t committed = vatomic64_read(&blk->committed);
-        /* check if we have an entry to occupy */
+        if (unlikely(BBQ_LOCAL_VSN(committed) != BBQ_LOCAL_VSN(reserved))) {
+            return true;
+        }
         vuint64_t committed_space = BBQ_LOCAL_IDX(committed);
         if (unlikely(reserved_space >= committed_space)) {
-            /* Note: the version is strictly monotic and may not wrap. */
             ASSERT(reserved <= committed && "reserved must be <= committed");
             return false;
         }
-        vuint16_t entry_total_size = VMIN((*count) << BBQ_ENTRY_SIZE_LOG,
-                                          committed_space - reserved_space);
         if (unlikely(committed_space != block_size)) {
             vuint64_t allocated       = vatomic64_read(&blk->allocated);
             vuint64_t allocated_space = BBQ_LOCAL_IDX(allocated);
@@ -330,22 +746,170 @@ _bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
                 return false;
             }
         }
+        /* producers commit whole records, the header is complete */
+        void *entry         = BBQ_GET_ENTRY(blk, reserved_space);
+        vuint32_t rec_len   = BBQ_RECORD_LEN(entry);
+        vsize_t record_size = rec_len == BBQ_RECORD_PAD ?
+                                  block_size - reserved_space :
+                                  BBQ_RECORD_SIZE(rec_len);
+        if (unlikely(rec_len != BBQ_RECORD_PAD && rec_len > max_len)) {
+            /* only report the length if the header was not recycled */
+            if (vatomic64_read(&blk->reserved) != reserved) {
+                return true;
+            }
+            span->len = rec_len;
+            return false;
+        }
         if (vatomic64_cmpxchg(&blk->reserved, reserved,
-                              reserved + entry_total_size) != reserved) {
+                              reserved + record_size) != reserved) {
             return true;
         }
-        /* we got the entry */
-        void *entry = BBQ_GET_ENTRY(blk, BBQ_LOCAL_IDX(reserved));
-        int r       = memcpy_s(*buf, entry_total_size, entry, entry_total_size);
-        BUG_ON(r != 0);
-        /* consume after copy the data back */
-        vatomic64_add(&blk->consumed, entry_total_size);
-        vuint16_t offset = entry_total_size >> BBQ_ENTRY_SIZE_LOG;
-        *buf += offset;
-        *count -= offset;
+        if (rec_len == BBQ_RECORD_PAD) {
+            /* skip the padding */
+            (void)_bbq_mpmc_consume(q, blk, reserved, record_size);
+            return true;
+        }
+        /* we got the record */
+        BBQ_SPAN_SET(span, blk, reserved, BBQ_RECORD_DATA(entry), rec_len,
+                     record_size);
         return true;
     }
     /* need to advance the block */
+    return _bbq_mpmc_advance_ridx(q, ridx, reserved);
+}
+/* return means retry */
+static inline vbool_t
+_bbq_mpmc_enqueue_record(bbq_mpmc_t *q, const void *data, vuint32_t len,
+                         vbool_t *done)
+{
+    bbq_span_t span = {.size = 0};
+
+    if (*done) {
+        return false;
+    }
+    vbool_t retry = _bbq_mpmc_reserve_record(q, len, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    if (len > 0) {
+        int r = memcpy_s(span.data, len, data, len);
+        BUG_ON(r != 0);
+    }
+    bbq_mpmc_commit(q, &span);
+    *done = true;
+    return true;
+}
+/* return means retry */
+static inline vbool_t
+_bbq_mpmc_dequeue_record(bbq_mpmc_t *q, void *buf, vuint32_t buf_len,
+                         vuint32_t *len, vbool_t *done)
+{
+    bbq_span_t span = {.size = 0, .len = 0};
+
+    if (*done) {
+        return false;
+    }
+    vbool_t retry = _bbq_mpmc_peek_record(q, buf_len, &span);
+    if (span.size == 0) {
+        if (span.len > buf_len) {
+            *len = span.len;
+        }
+        return retry;
+    }
+    if (span.len > 0) {
+        int r = memcpy_s(buf, buf_len, span.data, span.len);
+        BUG_ON(r != 0);
+    }
+    if (unlikely(!bbq_mpmc_release(q, &span))) {
+        return true;
+    }
+    *len  = span.len;
+    *done = true;
+    return true;
+}
+/* reclaims the previous round of the block in DROP_OLD mode, return false if
+ * a producer of that round did not commit yet */
+static inline vbool_t
+_bbq_mpmc_drop_block(bbq_mpmc_t *q, bbq_mpmc_block_t *nblk, vuint64_t vsn)
+{
+    vuint16_t block_size = q->config.blk_size;
+    vuint64_t committed  = vatomic64_read(&nblk->committed);
+    if (BBQ_LOCAL_VSN(committed) != vsn) {
+        /* already reclaimed by another producer */
+        return true;
+    }
+    if (unlikely(BBQ_LOCAL_IDX(committed) != block_size)) {
+        return false;
+    }
+    /* close the round before the cursors move on, consumers that did not
+     * reserve their entries yet fail, the others validate their copy */
+    vuint64_t reserved = vatomic64_get_max(
+        &nblk->reserved, BBQ_LOCAL_COMPOSE(vsn, (vuint64_t)block_size));
+    vuint64_t reserved_space = BBQ_LOCAL_VSN(reserved) == vsn ?
+                                   BBQ_LOCAL_IDX(reserved) :
+                                   BBQ_BLOCK_MPMC_INIT_VALUE;
+    if (reserved_space < block_size) {
+        vatomic64_add(&q->dropped,
+                      (block_size - reserved_space) >> BBQ_ENTRY_SIZE_LOG);
+    }
+    return true;
+}
+/* return means retry */
+static inline vbool_t
+_bbq_mpmc_advance_widx(bbq_mpmc_t *q, vuint64_t widx)
+{
+    vuint16_t block_idx    = BBQ_GLOBAL_IDX(widx);
+    vuint16_t block_size   = q->config.blk_size;
+    bbq_mpmc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
+    vuint64_t global_vsn   = BBQ_GLOBAL_VSN(widx);
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        if (unlikely(!_bbq_mpmc_drop_block(q, nblk, global_vsn))) {
+            return false;
+        }
+    } else if (unlikely(!BBQ_BLOCK_FULLY_CONSUMED_WITH_VSN(nblk, block_size,
+                                                           global_vsn))) {
+        return false;
+    }
+    /* reset cursor and advance block */
+    bbq_reset_block_cursor_heavy(&nblk->committed, global_vsn + 1,
+                                 BBQ_BLOCK_MPMC_INIT_VALUE);
+    bbq_reset_block_cursor_heavy(&nblk->allocated, global_vsn + 1,
+                                 BBQ_BLOCK_MPMC_INIT_VALUE);
+    BBQ_ADVANCE_HEAD(&q->widx, widx, widx + 1);
+    return true;
+}
+/* DROP_OLD: moves to the next block or, if the producers lapped the consumers,
+ * to the oldest block they did not reclaim yet. return means retry */
+static inline vbool_t
+_bbq_mpmc_skip_ridx(bbq_mpmc_t *q, vuint64_t ridx)
+{
+    vuint64_t widx = vatomic64_read(&q->widx);
+    vuint64_t next = ridx + 1;
+    if (widx > ridx && widx - ridx >= BBQ_BLOCK_NUM) {
+        next = widx - BBQ_BLOCK_NUM + 1;
+    }
+    bbq_mpmc_block_t *nblk = BBQ_GET_BLOCK(q, BBQ_GLOBAL_IDX(next));
+    vuint64_t vsn          = BBQ_BLOCK_VSN(next);
+    vuint64_t committed_vsn =
+        BBQ_LOCAL_VSN(vatomic64_read(&nblk->committed));
+    if (committed_vsn != vsn) {
+        /* either the producers did not reach the block yet, or they reclaimed
+         * it and are moving on */
+        return committed_vsn > vsn && vatomic64_read(&q->widx) != widx;
+    }
+    vatomic64_max(&nblk->reserved,
+                  BBQ_LOCAL_COMPOSE(vsn, BBQ_BLOCK_MPMC_INIT_VALUE));
+    BBQ_ADVANCE_HEAD(&q->ridx, ridx, next);
+    return true;
+}
+/* return means retry */
+static inline vbool_t
+_bbq_mpmc_advance_ridx(bbq_mpmc_t *q, vuint64_t ridx, vuint64_t reserved)
+{
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        return _bbq_mpmc_skip_ridx(q, ridx);
+    }
+    vuint16_t block_idx    = BBQ_GLOBAL_IDX(ridx);
     bbq_mpmc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
     /* r_head never pass the w_head and r_tail */
     vuint64_t next_consumer_vsn = BBQ_LOCAL_VSN(reserved) - (block_idx != 0);
@@ -362,4 +926,24 @@ _bbq_mpmc_dequeue(bbq_mpmc_t *q, vuintptr_t **buf, vuint32_t *count)
     BBQ_ADVANCE_HEAD(&q->ridx, ridx, ridx + 1);
     return true;
 }
+/* return false if the copied entries were overwritten (DROP_OLD only) */
+static inline vbool_t
+_bbq_mpmc_consume(bbq_mpmc_t *q, bbq_mpmc_block_t *blk, vuint64_t reserved,
+                  vsize_t size)
+{
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        /* the copy must be complete before we check the version */
+        vatomic_fence_acq();
+        vuint64_t allocated = vatomic64_read_rlx(&blk->allocated);
+        if (unlikely(BBQ_LOCAL_VSN(allocated) != BBQ_LOCAL_VSN(reserved))) {
+            vatomic64_add(&q->dropped, size >> BBQ_ENTRY_SIZE_LOG);
+            return false;
+        }
+        return true;
+    }
+    /* consume after copy the data back */
+    vatomic64_add(&blk->consumed, size);
+    BBQ_NOTIFY(q);
+    return true;
+}
 #endif
@@ -17,8 +17,34 @@
  * ### Remarks:
  *
  * In this implementations, values have a fixed size equal to pointer size.
- * This implementation does not support `DROP_OLD` mode as described in the
- * original paper.
+ *
+ * By default the queue runs in the `RETRY_NEW` mode of the original paper:
+ * enqueue fails (or waits) while the queue is full. A queue initialized with
+ * `bbq_spsc_init_mode(q, size, BBQ_MODE_DROP_OLD)` instead overwrites the
+ * oldest block, so the producer never waits for the consumer. The consumer
+ * skips the overwritten entries, which are accounted by
+ * `bbq_spsc_dropped_count`. `BBQ_SPSC_COUNT` is meaningless in `DROP_OLD`
+ * mode.
+ *
+ * Alternatively, the queue can carry variable-size records with
+ * `bbq_spsc_enqueue_record` and `bbq_spsc_dequeue_record`. Records are copied
+ * inline into the blocks, prefixed with their length, so no per-record
+ * allocation is needed. A record never spans two blocks, hence its length is
+ * bounded by `bbq_spsc_record_max_len`. A queue must be used either with
+ * records or with fixed-size values, never with both.
+ *
+ * Both flavors have a zero-copy variant. `bbq_spsc_reserve` and
+ * `bbq_spsc_reserve_record` hand out a span of the ring to be written in place
+ * and published with `bbq_spsc_commit`. `bbq_spsc_peek` and
+ * `bbq_spsc_peek_record` hand out a span to be read in place and returned with
+ * `bbq_spsc_release`. In `DROP_OLD` mode a claimed span can be overwritten
+ * while it is read, which `bbq_spsc_release` reports.
+ *
+ * With `wait` set, callers spin until space or entries are available.
+ * Define `BBQ_PARK` to park them on a futex once `VPARK_MAX_SPIN` retries
+ * failed. The producer and the consumer then pay a full fence per commit and
+ * release, but only issue the wake syscall if the other side is parked.
+ * On linux compile with `-D_GNU_SOURCE`.
  *
  * @cite [BBQ: A Block-based Bounded Queue for Exchanging Data and
  * Profiling](https://www.usenix.org/conference/atc22/presentation/wang-jiawei)
@@ -74,8 +100,12 @@ typedef struct bbq_spsc_block_s {
 
 typedef struct bbq_spsc_s {
     bbq_config_t config VSYNC_CACHEALIGN;
-    vuint64_t widx VSYNC_CACHEALIGN;
+    vatomic64_t dropped; /* rarely written, only in DROP_OLD mode */
+    vatomic64_t widx VSYNC_CACHEALIGN; /* read by the consumer in DROP_OLD */
     vuint64_t ridx VSYNC_CACHEALIGN;
+#if defined(BBQ_PARK)
+    vpark_t park VSYNC_CACHEALIGN;
+#endif
     vuint8_t blk[] VSYNC_CACHEALIGN;
 } bbq_spsc_t;
 
@@ -83,9 +113,9 @@ typedef struct bbq_spsc_s {
 #define BBQ_BLOCK_SPSC_INIT_VALUE BBQ_BLOCK_INIT_VALUE(struct bbq_spsc_block_s)
 /* Note:The following macros are used inside bbq/common.h in BBQ_COUNT
  * definition */
-#define BBQ_SPSC_WRITE_PROD(k, v) ((k) = v)
+#define BBQ_SPSC_WRITE_PROD(k, v) (vatomic64_write_rlx(&(k), v))
 #define BBQ_SPSC_WRITE_CONS(k, v) ((k) = v)
-#define BBQ_SPSC_READ_PROD(k)     (k)
+#define BBQ_SPSC_READ_PROD(k)     (vatomic64_read_rlx(&(k)))
 #define BBQ_SPSC_READ_CONS(k)     (k)
 #define BBQ_SPSC_COUNT(q)         BBQ_COUNT(q, spsc, SPSC)
 
@@ -96,6 +126,23 @@ static inline vbool_t _bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t **buf,
                                         vuint32_t *count);
 static inline void _bbq_spsc_block_init(bbq_spsc_block_t *blk, vsize_t idx,
                                         vuint16_t block_size);
+static inline vbool_t _bbq_spsc_enqueue_record(bbq_spsc_t *q, const void *data,
+                                               vuint32_t len, vbool_t *done);
+static inline vbool_t _bbq_spsc_dequeue_record(bbq_spsc_t *q, void *buf,
+                                               vuint32_t buf_len,
+                                               vuint32_t *len, vbool_t *done);
+static inline vbool_t _bbq_spsc_reserve(bbq_spsc_t *q, vsize_t size,
+                                        bbq_span_t *span);
+static inline vbool_t _bbq_spsc_peek(bbq_spsc_t *q, vsize_t size,
+                                     bbq_span_t *span);
+static inline vbool_t _bbq_spsc_reserve_record(bbq_spsc_t *q, vuint32_t len,
+                                               bbq_span_t *span);
+static inline vbool_t _bbq_spsc_peek_record(bbq_spsc_t *q, vuint32_t max_len,
+                                            bbq_span_t *span);
+static inline vbool_t _bbq_spsc_advance_widx(bbq_spsc_t *q);
+static inline vbool_t _bbq_spsc_advance_ridx(bbq_spsc_t *q);
+static inline vbool_t _bbq_spsc_consume(bbq_spsc_t *q, bbq_spsc_block_t *blk,
+                                        vuint64_t consumed, vsize_t size);
 /**
  * Enqueues one or more entries.
  *
@@ -134,7 +181,7 @@ bbq_spsc_enqueue(bbq_spsc_t *q, vuintptr_t *buf, vuint32_t count, vbool_t wait)
          * It is sufficient to observe retry only
          *
          */
-        await_while (!retry && wait && rest) {
+        bbq_await_while (q, !retry && wait && rest) {
             retry = _bbq_spsc_enqueue(q, &rest_buf, &rest);
         }
     } while (retry);
@@ -181,7 +228,7 @@ bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t *buf, vuint32_t count, vbool_t wait)
          * It is sufficient to observe retry only
          *
          */
-        await_while (!retry && wait && rest) {
+        bbq_await_while (q, !retry && wait && rest) {
             retry = _bbq_spsc_dequeue(q, &rest_buf, &rest);
         }
     } while (retry);
@@ -189,6 +236,255 @@ bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t *buf, vuint32_t count, vbool_t wait)
 
     return count - rest;
 }
+/**
+ * Returns the maximum payload length of a record.
+ *
+ * @param q address of bbq_spsc_t object.
+ * @return maximum length in bytes accepted by `bbq_spsc_enqueue_record`.
+ */
+static inline vuint32_t
+bbq_spsc_record_max_len(bbq_spsc_t *q)
+{
+    return BBQ_RECORD_MAX_LEN(q, bbq_spsc_block_t);
+}
+
+/**
+ * Enqueues a variable-size record.
+ *
+ * The payload is copied into the queue after a length header. If the record
+ * does not fit in the rest of the current block, the rest is padded and the
+ * record goes into the next block.
+ *
+ * @param q    address of bbq_spsc_t object.
+ * @param data address of the payload.
+ * @param len  length of the payload in bytes.
+ * @param wait true/false when set to true it waits (blocks) till space becomes
+ * available. Otherwise, it quits retrying.
+ *
+ * @return true the record was enqueued.
+ * @return false the queue is full, or `len > bbq_spsc_record_max_len(q)`.
+ */
+static inline vbool_t
+bbq_spsc_enqueue_record(bbq_spsc_t *q, const void *data, vuint32_t len,
+                        vbool_t wait)
+{
+    vbool_t done = false;
+    vbool_t retry;
+
+    if (unlikely(len > bbq_spsc_record_max_len(q))) {
+        return false;
+    }
+    do {
+        retry = _bbq_spsc_enqueue_record(q, data, len, &done);
+        bbq_await_while (q, !retry && wait && !done) {
+            retry = _bbq_spsc_enqueue_record(q, data, len, &done);
+        }
+    } while (retry);
+
+    return done;
+}
+
+/**
+ * Dequeues a variable-size record.
+ *
+ * @param q       address of bbq_spsc_t object.
+ * @param buf     address of the preallocated memory for the payload.
+ * @param buf_len size of `buf` in bytes.
+ * @param len     output parameter, length of the payload in bytes.
+ * @param wait    true/false. When set to true the API waits/blocks for a
+ * record to be available.
+ *
+ * @return true a record was dequeued and copied into `buf`.
+ * @return false the queue is empty, or the next record does not fit in `buf`.
+ * In the latter case `*len > buf_len` holds the length of the record, which
+ * remains in the queue.
+ */
+static inline vbool_t
+bbq_spsc_dequeue_record(bbq_spsc_t *q, void *buf, vuint32_t buf_len,
+                        vuint32_t *len, vbool_t wait)
+{
+    vbool_t done = false;
+    vbool_t retry;
+
+    *len = 0;
+    do {
+        retry = _bbq_spsc_dequeue_record(q, buf, buf_len, len, &done);
+        bbq_await_while (q, !retry && wait && !done && *len <= buf_len) {
+            retry = _bbq_spsc_dequeue_record(q, buf, buf_len, len, &done);
+        }
+    } while (retry);
+
+    return done;
+}
+
+/**
+ * Reserves space for up to `count` entries to be written in place.
+ *
+ * The span never crosses a block boundary, so fewer entries than requested
+ * might be reserved. The caller writes the entries at `span->data` and
+ * publishes them with `bbq_spsc_commit` before the next reserve.
+ *
+ * @param q     address of bbq_spsc_t object.
+ * @param count number of entries to reserve.
+ * @param span  output parameter, the reserved span.
+ * @param wait  should wait for space to be available.
+ *
+ * @return number of reserved entries, `0` if the queue is full.
+ */
+static inline vuint32_t
+bbq_spsc_reserve(bbq_spsc_t *q, vuint32_t count, bbq_span_t *span,
+                 vbool_t wait)
+{
+    vsize_t size = (vsize_t)count << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry;
+
+    span->size = 0;
+    if (count == 0) {
+        return 0;
+    }
+    do {
+        retry = _bbq_spsc_reserve(q, size, span);
+        bbq_await_while (q, !retry && wait && span->size == 0) {
+            retry = _bbq_spsc_reserve(q, size, span);
+        }
+    } while (retry && span->size == 0);
+
+    return span->size >> BBQ_ENTRY_SIZE_LOG;
+}
+
+/**
+ * Publishes a span obtained with `bbq_spsc_reserve` or
+ * `bbq_spsc_reserve_record`.
+ *
+ * @param q    address of bbq_spsc_t object.
+ * @param span address of the reserved span.
+ */
+static inline void
+bbq_spsc_commit(bbq_spsc_t *q, bbq_span_t *span)
+{
+    bbq_spsc_block_t *blk = span->blk;
+    ASSERT(span->size != 0);
+    vatomic64_write_rel(&blk->committed, span->cursor + span->size);
+    BBQ_NOTIFY(q);
+    V_UNUSED(q);
+}
+
+/**
+ * Claims up to `count` entries to be read in place.
+ *
+ * The span never crosses a block boundary, so fewer entries than available
+ * might be claimed. The caller reads the entries at `span->data` and returns
+ * the space with `bbq_spsc_release`.
+ *
+ * @param q     address of bbq_spsc_t object.
+ * @param count number of entries to claim.
+ * @param span  output parameter, the claimed span.
+ * @param wait  should wait for entries to be available.
+ *
+ * @return number of claimed entries, `0` if the queue is empty.
+ */
+static inline vuint32_t
+bbq_spsc_peek(bbq_spsc_t *q, vuint32_t count, bbq_span_t *span, vbool_t wait)
+{
+    vsize_t size = (vsize_t)count << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry;
+
+    span->size = 0;
+    if (count == 0) {
+        return 0;
+    }
+    do {
+        retry = _bbq_spsc_peek(q, size, span);
+        bbq_await_while (q, !retry && wait && span->size == 0) {
+            retry = _bbq_spsc_peek(q, size, span);
+        }
+    } while (retry && span->size == 0);
+
+    return span->size >> BBQ_ENTRY_SIZE_LOG;
+}
+
+/**
+ * Returns the space of a span obtained with `bbq_spsc_peek` or
+ * `bbq_spsc_peek_record` to the producers.
+ *
+ * @param q    address of bbq_spsc_t object.
+ * @param span address of the claimed span.
+ *
+ * @return true the span was read intact.
+ * @return false the span was overwritten while it was read, which only
+ * happens in `BBQ_MODE_DROP_OLD` mode. The caller must discard what it read.
+ */
+static inline vbool_t
+bbq_spsc_release(bbq_spsc_t *q, bbq_span_t *span)
+{
+    ASSERT(span->size != 0);
+    return _bbq_spsc_consume(q, span->blk, span->cursor, span->size);
+}
+
+/**
+ * Reserves space for a record of `len` bytes to be written in place.
+ *
+ * On success the caller writes the payload at `span->data` and publishes the
+ * record with `bbq_spsc_commit` before the next reserve.
+ *
+ * @param q    address of bbq_spsc_t object.
+ * @param len  length of the payload in bytes.
+ * @param span output parameter, the reserved payload.
+ * @param wait should wait for space to be available.
+ *
+ * @return true the record was reserved.
+ * @return false the queue is full, or `len > bbq_spsc_record_max_len(q)`.
+ */
+static inline vbool_t
+bbq_spsc_reserve_record(bbq_spsc_t *q, vuint32_t len, bbq_span_t *span,
+                        vbool_t wait)
+{
+    vbool_t retry;
+
+    span->size = 0;
+    if (unlikely(len > bbq_spsc_record_max_len(q))) {
+        return false;
+    }
+    do {
+        retry = _bbq_spsc_reserve_record(q, len, span);
+        bbq_await_while (q, !retry && wait && span->size == 0) {
+            retry = _bbq_spsc_reserve_record(q, len, span);
+        }
+    } while (retry && span->size == 0);
+
+    return span->size != 0;
+}
+
+/**
+ * Claims the next record to be read in place.
+ *
+ * On success `span->data` and `span->len` hold the payload, the caller
+ * returns the space with `bbq_spsc_release` before the next peek.
+ *
+ * @param q    address of bbq_spsc_t object.
+ * @param span output parameter, the claimed payload.
+ * @param wait should wait for a record to be available.
+ *
+ * @return true a record was claimed.
+ * @return false the queue is empty.
+ */
+static inline vbool_t
+bbq_spsc_peek_record(bbq_spsc_t *q, bbq_span_t *span, vbool_t wait)
+{
+    vbool_t retry;
+
+    span->size = 0;
+    do {
+        /* any length fits */
+        retry = _bbq_spsc_peek_record(q, VUINT32_MAX, span);
+        bbq_await_while (q, !retry && wait && span->size == 0) {
+            retry = _bbq_spsc_peek_record(q, VUINT32_MAX, span);
+        }
+    } while (retry && span->size == 0);
+
+    return span->size != 0;
+}
+
 /**
  * Calculates the size of bbq_spsc_t object based on the given capacity.
  *
@@ -215,16 +511,17 @@ bbq_spsc_memsize(vsize_t capacity)
 }
 
 /**
- * Initializes a bbq data structure.
+ * Initializes a bbq data structure in the given mode.
  *
  * @param q address of bbq_spsc_t object.
  * @param size size of the given bbq_spsc_t object `q`.
+ * @param mode `BBQ_MODE_RETRY_NEW` or `BBQ_MODE_DROP_OLD`.
  *
  * @return true initialization succeeded.
  * @return false initialization failed.
  */
 static inline vbool_t
-bbq_spsc_init(bbq_spsc_t *q, vsize_t size)
+bbq_spsc_init_mode(bbq_spsc_t *q, vsize_t size, bbq_mode_t mode)
 {
     // we shift vuint16_t by BBQ_ENTRY_SIZE_LOG, we need to make sure the
     // behavior is defined
@@ -252,8 +549,13 @@ bbq_spsc_init(bbq_spsc_t *q, vsize_t size)
     }
     (q)->config.blk_size     = blk_size;
     (q)->config.blk_size_log = blk_size_log;
+    (q)->config.mode         = mode;
     BBQ_SPSC_WRITE_PROD((q)->widx, 0);
     BBQ_SPSC_WRITE_CONS((q)->ridx, 0);
+    vatomic64_write(&(q)->dropped, 0);
+#if defined(BBQ_PARK)
+    vpark_init(&(q)->park);
+#endif
 
     for (vsize_t i = 0; i < (1UL << BBQ_BLOCK_NUM_LOG); i++) {
         _bbq_spsc_block_init(
@@ -262,6 +564,37 @@ bbq_spsc_init(bbq_spsc_t *q, vsize_t size)
     return true;
 }
 
+/**
+ * Initializes a bbq data structure in `BBQ_MODE_RETRY_NEW` mode.
+ *
+ * @param q address of bbq_spsc_t object.
+ * @param size size of the given bbq_spsc_t object `q`.
+ *
+ * @return true initialization succeeded.
+ * @return false initialization failed.
+ */
+static inline vbool_t
+bbq_spsc_init(bbq_spsc_t *q, vsize_t size)
+{
+    return bbq_spsc_init_mode(q, size, BBQ_MODE_RETRY_NEW);
+}
+
+/**
+ * Returns the number of entries lost in `BBQ_MODE_DROP_OLD` mode.
+ *
+ * Counts the entries that were overwritten before the consumer dequeued them.
+ * Records are counted in entries of `BBQ_ENTRY_SIZE` bytes, including the
+ * padding at the end of blocks.
+ *
+ * @param q address of bbq_spsc_t object.
+ * @return number of dropped entries.
+ */
+static inline vuint64_t
+bbq_spsc_dropped_count(bbq_spsc_t *q)
+{
+    return vatomic64_read(&q->dropped);
+}
+
 static inline void
 _bbq_spsc_block_init(bbq_spsc_block_t *blk, vsize_t idx, vuint16_t block_size)
 {
@@ -271,50 +604,89 @@ _bbq_spsc_block_init(bbq_spsc_block_t *blk, vsize_t idx, vuint16_t block_size)
     vatomic64_write(&blk->consumed, init_value);
 }
 
-/* return means retry */
+/* return means retry, `span->size != 0` if space was reserved */
 static inline vbool_t
-_bbq_spsc_enqueue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
+_bbq_spsc_reserve(bbq_spsc_t *q, vsize_t size, bbq_span_t *span)
 {
-    if (*count == 0) {
-        return false;
-    }
-
     /* get the address of the alloc block */
-    vuint64_t widx        = q->widx;
+    vuint64_t widx        = BBQ_SPSC_READ_PROD(q->widx);
     vuint16_t block_idx   = BBQ_GLOBAL_IDX(widx);
     bbq_spsc_block_t *blk = BBQ_GET_BLOCK(q, block_idx);
     /* precheck once */
     vuint16_t block_size      = q->config.blk_size;
     vuint64_t committed       = vatomic64_read_rlx(&blk->committed);
     vuint64_t committed_space = BBQ_LOCAL_IDX(committed);
-    vsize_t entry_total_size  = (*count) << BBQ_ENTRY_SIZE_LOG;
     /* if out of bound, we don't add the space, but help to move the block */
     if (likely(committed_space < block_size)) {
-        vuint16_t space = VMIN(entry_total_size, block_size - committed_space);
+        vuint16_t space = VMIN(size, block_size - committed_space);
         void *entry     = BBQ_GET_ENTRY(blk, committed_space);
-        int r           = memcpy_s(entry, space, *buf, space);
-        BUG_ON(r != 0);
-        vuint64_t new_committed = BBQ_LOCAL_COMPOSE(BBQ_LOCAL_VSN(committed),
-                                                    committed_space + space);
-        vatomic64_write_rel(&blk->committed, new_committed);
-        vuint16_t offset = space >> BBQ_ENTRY_SIZE_LOG;
-        *buf += offset;
-        *count -= offset;
+        BBQ_SPAN_SET(span, blk, committed, entry, space, space);
         return true;
     }
 
-    /* slow path, all writers help to move to next block */
-    bbq_spsc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
-    vuint64_t global_vsn   = BBQ_GLOBAL_VSN(widx);
-    if (unlikely(
-            !BBQ_BLOCK_FULLY_CONSUMED_WITH_VSN(nblk, block_size, global_vsn))) {
+    /* slow path, move to next block */
+    return _bbq_spsc_advance_widx(q);
+}
+
+/* return means retry, `span->size != 0` if entries were claimed */
+static inline vbool_t
+_bbq_spsc_peek(bbq_spsc_t *q, vsize_t size, bbq_span_t *span)
+{
+    /* get the address of the occupy block */
+    vuint64_t ridx        = q->ridx;
+    vuint16_t block_idx   = BBQ_GLOBAL_IDX(ridx);
+    bbq_spsc_block_t *blk = BBQ_GET_BLOCK(q, block_idx);
+
+    /* check if the block is fully reserved */
+    vuint16_t block_size     = q->config.blk_size;
+    vuint64_t consumed       = vatomic64_read_rlx(&blk->consumed);
+    vuint64_t consumed_space = BBQ_LOCAL_IDX(consumed);
+    if (likely(consumed_space < block_size)) {
+        vuint64_t committed = vatomic64_read_acq(&blk->committed);
+        if (unlikely(BBQ_LOCAL_VSN(committed) != BBQ_LOCAL_VSN(consumed))) {
+            /* DROP_OLD: the producer is reclaiming the block */
+            return true;
+        }
+        /* check if we have an entry to occupy */
+        vuint64_t committed_space = BBQ_LOCAL_IDX(committed);
+        if (unlikely(consumed_space >= committed_space)) {
+            ASSERT(consumed_space == committed_space &&
+                   "Consumed should be <= committed");
+            return false;
+        }
+
+        /* we got the entry */
+        vuint16_t space = VMIN(size, committed_space - consumed_space);
+        void *entry     = BBQ_GET_ENTRY(blk, consumed_space);
+        BBQ_SPAN_SET(span, blk, consumed, entry, space, space);
+        return true;
+    }
+
+    /* need to advance the block */
+    return _bbq_spsc_advance_ridx(q);
+}
+
+/* return means retry */
+static inline vbool_t
+_bbq_spsc_enqueue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
+{
+    bbq_span_t span = {.size = 0};
+
+    if (*count == 0) {
         return false;
     }
 
-    /* reset cursor and advance block */
-    BBQ_RESET_BLOCK_CURSOR_LIGHT(&nblk->committed, global_vsn + 1,
-                                 BBQ_BLOCK_SPSC_INIT_VALUE);
-    q->widx++;
+    vsize_t entry_total_size = (*count) << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry            = _bbq_spsc_reserve(q, entry_total_size, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    int r = memcpy_s(span.data, span.size, *buf, span.size);
+    BUG_ON(r != 0);
+    bbq_spsc_commit(q, &span);
+    vuint16_t offset = span.size >> BBQ_ENTRY_SIZE_LOG;
+    *buf += offset;
+    *count -= offset;
     return true;
 }
 
@@ -322,10 +694,55 @@ _bbq_spsc_enqueue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
 static inline vbool_t
 _bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
 {
+    bbq_span_t span = {.size = 0};
+
     if (*count == 0) {
         return false;
     }
 
+    vsize_t entry_total_size = (*count) << BBQ_ENTRY_SIZE_LOG;
+    vbool_t retry            = _bbq_spsc_peek(q, entry_total_size, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    int r = memcpy_s(*buf, span.size, span.data, span.size);
+    BUG_ON(r != 0);
+    if (unlikely(!bbq_spsc_release(q, &span))) {
+        return true;
+    }
+    vuint16_t offset = span.size >> BBQ_ENTRY_SIZE_LOG;
+    *buf += offset;
+    *count -= offset;
+    return true;
+}
+
+/* return means retry, `span->size != 0` if the record was reserved */
+static inline vbool_t
+_bbq_spsc_reserve_record(bbq_spsc_t *q, vuint32_t len, bbq_span_t *span)
+{
+    vsize_t record_size = BBQ_RECORD_SIZE(len);
+    vbool_t retry       = _bbq_spsc_reserve(q, record_size, span);
+    if (span->size == 0) {
+        return retry;
+    }
+    if (unlikely(span->size != record_size)) {
+        /* pad the tail of the block and retry on the next block */
+        BBQ_RECORD_LEN(span->data) = BBQ_RECORD_PAD;
+        bbq_spsc_commit(q, span);
+        span->size = 0;
+        return true;
+    }
+    BBQ_RECORD_LEN(span->data) = len;
+    span->data                 = BBQ_RECORD_DATA(span->data);
+    span->len                  = len;
+    return true;
+}
+
+/* return means retry, `span->size != 0` if a record was claimed. A record
+ * longer than `max_len` stays in the queue, `span->len` holds its length */
+static inline vbool_t
+_bbq_spsc_peek_record(bbq_spsc_t *q, vuint32_t max_len, bbq_span_t *span)
+{
     /* get the address of the occupy block */
     vuint64_t ridx        = q->ridx;
     vuint16_t block_idx   = BBQ_GLOBAL_IDX(ridx);
@@ -337,7 +754,10 @@ _bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
     vuint64_t consumed_space = BBQ_LOCAL_IDX(consumed);
     if (likely(consumed_space < block_size)) {
         vuint64_t committed = vatomic64_read_acq(&blk->committed);
-        /* check if we have an entry to occupy */
+        if (unlikely(BBQ_LOCAL_VSN(committed) != BBQ_LOCAL_VSN(consumed))) {
+            return true;
+        }
+        /* check if we have a record to occupy */
         vuint64_t committed_space = BBQ_LOCAL_IDX(committed);
         if (unlikely(consumed_space >= committed_space)) {
             ASSERT(consumed_space == committed_space &&
@@ -345,21 +765,161 @@ _bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
             return false;
         }
 
-        /* we got the entry */
-        vuint16_t space = VMIN((*count) << BBQ_ENTRY_SIZE_LOG,
-                               committed_space - consumed_space);
-        void *entry     = BBQ_GET_ENTRY(blk, consumed_space);
-        int r           = memcpy_s(*buf, space, entry, space);
-        BUG_ON(r != 0);
-        vuint64_t new_consumed = consumed + space;
-        vatomic64_write_rel(&blk->consumed, new_consumed);
-        vuint16_t offset = space >> BBQ_ENTRY_SIZE_LOG;
-        *buf += offset;
-        *count -= offset;
+        void *entry         = BBQ_GET_ENTRY(blk, consumed_space);
+        vuint32_t rec_len   = BBQ_RECORD_LEN(entry);
+        vsize_t record_size = BBQ_RECORD_SIZE(rec_len);
+        if (q->config.mode == BBQ_MODE_DROP_OLD &&
+            unlikely(!_bbq_spsc_consume(q, blk, consumed, 0))) {
+            /* the header was overwritten */
+            return true;
+        }
+        if (rec_len == BBQ_RECORD_PAD) {
+            /* skip the padding */
+            (void)_bbq_spsc_consume(q, blk, consumed,
+                                    block_size - consumed_space);
+            return true;
+        }
+        if (unlikely(rec_len > max_len)) {
+            span->len = rec_len;
+            return false;
+        }
+        /* we got the record */
+        BBQ_SPAN_SET(span, blk, consumed, BBQ_RECORD_DATA(entry), rec_len,
+                     record_size);
         return true;
     }
 
     /* need to advance the block */
+    return _bbq_spsc_advance_ridx(q);
+}
+
+/* return means retry */
+static inline vbool_t
+_bbq_spsc_enqueue_record(bbq_spsc_t *q, const void *data, vuint32_t len,
+                         vbool_t *done)
+{
+    bbq_span_t span = {.size = 0};
+
+    if (*done) {
+        return false;
+    }
+
+    vbool_t retry = _bbq_spsc_reserve_record(q, len, &span);
+    if (span.size == 0) {
+        return retry;
+    }
+    if (len > 0) {
+        int r = memcpy_s(span.data, len, data, len);
+        BUG_ON(r != 0);
+    }
+    bbq_spsc_commit(q, &span);
+    *done = true;
+    return true;
+}
+
+/* return means retry */
+static inline vbool_t
+_bbq_spsc_dequeue_record(bbq_spsc_t *q, void *buf, vuint32_t buf_len,
+                         vuint32_t *len, vbool_t *done)
+{
+    bbq_span_t span = {.size = 0, .len = 0};
+
+    if (*done) {
+        return false;
+    }
+
+    vbool_t retry = _bbq_spsc_peek_record(q, buf_len, &span);
+    if (span.size == 0) {
+        if (span.len > buf_len) {
+            *len = span.len;
+        }
+        return retry;
+    }
+    if (span.len > 0) {
+        int r = memcpy_s(buf, buf_len, span.data, span.len);
+        BUG_ON(r != 0);
+    }
+    if (unlikely(!bbq_spsc_release(q, &span))) {
+        return true;
+    }
+    *len  = span.len;
+    *done = true;
+    return true;
+}
+
+/* return means retry */
+static inline vbool_t
+_bbq_spsc_advance_widx(bbq_spsc_t *q)
+{
+    vuint64_t widx         = BBQ_SPSC_READ_PROD(q->widx);
+    vuint16_t block_idx    = BBQ_GLOBAL_IDX(widx);
+    vuint16_t block_size   = q->config.blk_size;
+    bbq_spsc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
+    vuint64_t global_vsn   = BBQ_GLOBAL_VSN(widx);
+
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        /* close the previous round of the block before its cursor moves on,
+         * whatever the consumer did not consume yet is lost */
+        vuint64_t consumed = vatomic64_get_max(
+            &nblk->consumed,
+            BBQ_LOCAL_COMPOSE(global_vsn, (vuint64_t)block_size));
+        vuint64_t consumed_space = BBQ_LOCAL_VSN(consumed) == global_vsn ?
+                                       BBQ_LOCAL_IDX(consumed) :
+                                       BBQ_BLOCK_SPSC_INIT_VALUE;
+        if (consumed_space < block_size) {
+            vatomic64_add(&q->dropped,
+                          (block_size - consumed_space) >> BBQ_ENTRY_SIZE_LOG);
+        }
+    } else if (unlikely(!BBQ_BLOCK_FULLY_CONSUMED_WITH_VSN(nblk, block_size,
+                                                           global_vsn))) {
+        return false;
+    }
+
+    /* reset cursor and advance block */
+    BBQ_RESET_BLOCK_CURSOR_LIGHT(&nblk->committed, global_vsn + 1,
+                                 BBQ_BLOCK_SPSC_INIT_VALUE);
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        /* the consumer validates its copy with the committed cursor */
+        vatomic_fence_rel();
+    }
+    vatomic64_write_rel(&q->widx, widx + 1);
+    return true;
+}
+
+/* DROP_OLD: moves to the next block or, if the producer lapped the consumer, to
+ * the oldest block it did not reclaim yet. return means retry */
+static inline vbool_t
+_bbq_spsc_skip_ridx(bbq_spsc_t *q, vuint64_t ridx)
+{
+    vuint64_t widx = vatomic64_read_acq(&q->widx);
+    vuint64_t next = ridx + 1;
+    if (widx > ridx && widx - ridx >= BBQ_BLOCK_NUM) {
+        next = widx - BBQ_BLOCK_NUM + 1;
+    }
+    bbq_spsc_block_t *nblk = BBQ_GET_BLOCK(q, BBQ_GLOBAL_IDX(next));
+    vuint64_t vsn          = BBQ_BLOCK_VSN(next);
+    vuint64_t committed_vsn =
+        BBQ_LOCAL_VSN(vatomic64_read_acq(&nblk->committed));
+    if (committed_vsn != vsn) {
+        /* either the producer did not reach the block yet, or it reclaimed
+         * it and is moving on */
+        return committed_vsn > vsn && vatomic64_read_acq(&q->widx) != widx;
+    }
+    vatomic64_max(&nblk->consumed,
+                  BBQ_LOCAL_COMPOSE(vsn, BBQ_BLOCK_SPSC_INIT_VALUE));
+    q->ridx = next;
+    return true;
+}
+
+/* return means retry */
+static inline vbool_t
+_bbq_spsc_advance_ridx(bbq_spsc_t *q)
+{
+    vuint64_t ridx = q->ridx;
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        return _bbq_spsc_skip_ridx(q, ridx);
+    }
+    vuint16_t block_idx    = BBQ_GLOBAL_IDX(ridx);
     bbq_spsc_block_t *nblk = BBQ_GET_NEXT_BLOCK(q, block_idx);
     vuint64_t global_vsn   = BBQ_GLOBAL_VSN(ridx);
 
@@ -375,4 +935,26 @@ _bbq_spsc_dequeue(bbq_spsc_t *q, vuintptr_t **buf, vuint32_t *count)
     q->ridx++;
     return true;
 }
+
+/* return false if the copied entries were overwritten (DROP_OLD only) */
+static inline vbool_t
+_bbq_spsc_consume(bbq_spsc_t *q, bbq_spsc_block_t *blk, vuint64_t consumed,
+                  vsize_t size)
+{
+    vuint64_t new_consumed = consumed + size;
+    if (q->config.mode == BBQ_MODE_DROP_OLD) {
+        /* the copy must be complete before we check the version */
+        vatomic_fence_acq();
+        vuint64_t committed = vatomic64_read_rlx(&blk->committed);
+        if (unlikely(BBQ_LOCAL_VSN(committed) != BBQ_LOCAL_VSN(consumed))) {
+            return false;
+        }
+        /* fails if the producer closed the round, it accounted the entries */
+        return size == 0 || vatomic64_cmpxchg_rel(&blk->consumed, consumed,
+                                                  new_consumed) == consumed;
+    }
+    vatomic64_write_rel(&blk->consumed, new_consumed);
+    BBQ_NOTIFY(q);
+    return true;
+}
 #endif
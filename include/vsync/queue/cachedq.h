@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2025-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -13,6 +13,22 @@
  * A variation of the DPDK ring buffer that uses cached variables to improve the
  * performance. It accepts vuint64_t as data type.
  *
+ * `cachedq_enqueue_wait` and `cachedq_dequeue_wait` spin until space or
+ * entries are available. Define `CACHEDQ_PARK` to park them on a futex once
+ * `VPARK_MAX_SPIN` retries failed. All enqueues and dequeues then pay a full
+ * fence, but only issue the wake syscall if somebody is parked. On linux
+ * compile with `-D_GNU_SOURCE`.
+ *
+ * By default producers (and consumers) publish their entries strictly in the
+ * order in which they reserved them: each waits for its predecessors before
+ * moving `ptail` (or `ctail`), so a preempted thread stalls all threads behind
+ * it. Define `CACHEDQ_RELAXED_TAIL` to instead let every thread mark its
+ * finished batch in a per-slot array, and let whoever finishes move the tail
+ * over all consecutive finished batches. Nobody waits for a predecessor; the
+ * batches behind a preempted thread only become visible once it finishes.
+ * This mode doubles the memory footprint of the ring and costs a full fence
+ * per operation.
+ *
  * @example
  * @include eg_cachedq.c
  *
@@ -20,7 +36,31 @@
 #include <vsync/atomic.h>
 #include <vsync/common/cache.h>
 #include <vsync/common/assert.h>
+#include <vsync/common/macros.h>
 #include <vsync/vtypes.h>
+#include <vsync/utils/math.h>
+#include <vsync/utils/string.h>
+
+#if defined(CACHEDQ_PARK)
+    #include <vsync/thread/internal/park.h>
+    #define cachedq_await_while(q, cond) vpark_await_while(&(q)->park, cond)
+    #define CACHEDQ_NOTIFY(q)            vpark_notify(&(q)->park)
+#else
+    #define cachedq_await_while(q, cond) await_while (cond)
+    #define CACHEDQ_NOTIFY(q)                                                  \
+        do {                                                                   \
+        } while (0)
+#endif
+
+#if defined(CACHEDQ_RELAXED_TAIL)
+    /* every slot has an entry and a mark */
+    #define CACHEDQ_SLOT_WORDS 2U
+#else
+    #define CACHEDQ_SLOT_WORDS 1U
+#endif
+/* tags of the marks, telling which side finished the batch */
+#define CACHEDQ_MARK_PROD 0U
+#define CACHEDQ_MARK_CONS 1U
 
 typedef struct cachedq_s {
     vatomic64_t phead VSYNC_CACHEALIGN;
@@ -30,8 +70,20 @@ typedef struct cachedq_s {
     vatomic64_t ctail VSYNC_CACHEALIGN;
     vatomic64_t ctail_cached VSYNC_CACHEALIGN;
     vuint64_t size VSYNC_CACHEALIGN;
+    vuint64_t mask; /* size - 1 if size is a power of two, otherwise 0 */
+#if defined(CACHEDQ_PARK)
+    vpark_t park VSYNC_CACHEALIGN;
+#endif
     vuint64_t entry[] VSYNC_CACHEALIGN;
 } cachedq_t;
+static inline vsize_t _cachedq_enqueue(cachedq_t *q, vuint64_t *buf,
+                                       vsize_t count, vbool_t burst);
+static inline void _cachedq_copy_out(cachedq_t *q, vuint64_t pos,
+                                     vuint64_t *buf, vsize_t count);
+static inline vatomic64_t *_cachedq_mark(cachedq_t *q, vsize_t idx);
+static inline void _cachedq_publish(cachedq_t *q, vatomic64_t *tail,
+                                    vuint64_t head, vuint64_t next,
+                                    vuint64_t tag);
 /**
  * Returns the minimum allocation size for a`cachedq` with the given capacity.
  *
@@ -42,7 +94,8 @@ typedef struct cachedq_s {
 static inline vsize_t
 cachedq_memsize(vsize_t capacity)
 {
-    return sizeof(cachedq_t) + sizeof(vuint64_t) * capacity +
+    return sizeof(cachedq_t) +
+           sizeof(vuint64_t) * CACHEDQ_SLOT_WORDS * capacity +
            VSYNC_CACHELINE_SIZE;
 }
 /**
@@ -53,7 +106,9 @@ cachedq_memsize(vsize_t capacity)
  *
  * @return `buf` pointer casted to cachedq_t*.
  *
- * Use `cachedq_memsize()` to determine the size of buf.
+ * Use `cachedq_memsize()` to determine the size of buf. If the resulting
+ * capacity is a power of two, ring indices are computed with a mask instead
+ * of a division.
  */
 static inline cachedq_t *
 cachedq_init(void *buf, vsize_t capacity)
@@ -65,15 +120,25 @@ cachedq_init(void *buf, vsize_t capacity)
     vatomic64_init(&q->chead, 0);
     vatomic64_init(&q->ctail, 0);
     vatomic64_init(&q->ctail_cached, 0);
+#if defined(CACHEDQ_PARK)
+    vpark_init(&q->park);
+#endif
     q->size = (capacity - VSYNC_CACHELINE_SIZE - sizeof(cachedq_t)) /
-              sizeof(vuint64_t);
+              (sizeof(vuint64_t) * CACHEDQ_SLOT_WORDS);
+    q->mask = (q->size & (q->size - 1)) == 0 ? q->size - 1 : 0;
+#if defined(CACHEDQ_RELAXED_TAIL)
+    for (vsize_t i = 0; i < q->size; i++) {
+        vatomic64_init(_cachedq_mark(q, i), 0);
+    }
+#endif
     return q;
 }
 /**
  * Enqueues one or more entries.
  *
  * Multiple entries can be enqueued if `buf` points to an array. Use `count` to
- * indicate how many entries should be enqueueed, starting from `buf`.
+ * indicate how many entries should be enqueueed, starting from `buf`. Either
+ * all `count` entries are enqueued or none.
  *
  * @param q address of `cachedq_t` object.
  * @param buf   pointer to first entry.
@@ -84,51 +149,28 @@ cachedq_init(void *buf, vsize_t capacity)
 static inline vsize_t
 cachedq_enqueue(cachedq_t *q, vuint64_t *buf, vsize_t count)
 {
-    vuint64_t phead        = 0;
-    vuint64_t pnext        = 0;
-    vuint64_t ctail_cached = 0;
-
-    ASSERT(q);
-    ASSERT(buf);
-
-    while (true) {
-        phead        = vatomic64_read_rlx(&q->phead);
-        pnext        = phead + count;
-        ctail_cached = vatomic64_read_rlx(&q->ctail_cached);
-        if (pnext <= ctail_cached + q->size) {
-            if (vatomic64_cmpxchg_rlx(&q->phead, phead, pnext) != phead) {
-                continue;
-            }
-            for (vsize_t i = 0; i < count; i++) {
-                q->entry[(phead + i) % q->size] = buf[i];
-            }
-            await_while (vatomic64_read_rlx(&q->ptail) != phead) {}
-            vatomic64_write_rel(&q->ptail, pnext);
-            return count;
-        } else {
-            vuint64_t ctail = vatomic64_read_acq(&q->ctail);
-            if (pnext <= ctail + q->size) {
-                if (vatomic64_cmpxchg_rlx(&q->phead, phead, pnext) != phead) {
-                    continue;
-                }
-                vatomic64_write_rlx(&q->ctail_cached, ctail);
-                for (vsize_t i = 0; i < count; i++) {
-                    q->entry[(phead + i) % q->size] = buf[i];
-                }
-                await_while (vatomic64_read_rlx(&q->ptail) != phead) {}
-                vatomic64_write_rel(&q->ptail, pnext);
-                return count;
-            } else {
-                return 0;
-            }
-        }
-    }
+    return _cachedq_enqueue(q, buf, count, false);
+}
+/**
+ * Enqueues as many entries as fit, up to `count`.
+ *
+ * @param q address of `cachedq_t` object.
+ * @param buf   pointer to first entry.
+ * @param count maximum number of entries to enqueue.
+ *
+ * @return number of enqueued entries, the first ones of `buf`.
+ */
+static inline vsize_t
+cachedq_enqueue_burst(cachedq_t *q, vuint64_t *buf, vsize_t count)
+{
+    return _cachedq_enqueue(q, buf, count, true);
 }
 /**
  * Dequeues one or more entries.
  *
  * Multiple entries can be dequeued if `buf` points to an array. Use `count` to
- * indicate how many entries should be dequeued.
+ * indicate how many entries should be dequeued. If fewer entries are
+ * available, all of them are dequeued.
  *
  * @param q address of `cachedq_t` object.
  * @param buf   pointer to preallocated memory for the first entry.
@@ -138,59 +180,82 @@ cachedq_enqueue(cachedq_t *q, vuint64_t *buf, vsize_t count)
 static inline vsize_t
 cachedq_dequeue(cachedq_t *q, vuint64_t *buf, vsize_t count)
 {
-    vuint64_t chead        = 0;
-    vuint64_t cnext        = 0;
-    vuint64_t ptail_cached = 0;
+    vuint64_t chead = 0;
+    vuint64_t cnext = 0;
+    vuint64_t ptail = 0;
 
     ASSERT(q);
     ASSERT(buf);
 
     while (true) {
-        chead        = vatomic64_read_rlx(&q->chead);
-        cnext        = chead + count;
-        ptail_cached = vatomic64_read_rlx(&q->ptail_cached);
-        if (cnext <= ptail_cached) {
-            if (vatomic64_cmpxchg_rlx(&q->chead, chead, cnext) != chead) {
-                continue;
-            }
-            for (vsize_t i = 0; i < count; i++) {
-                buf[i] = q->entry[(chead + i) % q->size];
-            }
-            await_while (vatomic64_read_rlx(&q->ctail) != chead) {}
-            vatomic64_write_rel(&q->ctail, cnext);
-            return count;
-        } else {
-            vuint64_t ptail = vatomic64_read_acq(&q->ptail);
-            if (cnext <= ptail) {
-                if (vatomic64_cmpxchg_rlx(&q->chead, chead, cnext) != chead) {
-                    continue;
+        chead = vatomic64_read_rlx(&q->chead);
+        cnext = chead + count;
+        ptail = vatomic64_read_rlx(&q->ptail_cached);
+        if (cnext > ptail) {
+            /* the cached value might be stale */
+            ptail = vatomic64_read_acq(&q->ptail);
+            if (cnext > ptail) {
+                if (chead >= ptail) {
+                    return 0;
                 }
-                vatomic64_write_rlx(&q->ptail_cached, ptail);
-                for (vsize_t i = 0; i < count; i++) {
-                    buf[i] = q->entry[(chead + i) % q->size];
-                }
-                await_while (vatomic64_read_rlx(&q->ctail) != chead) {}
-                vatomic64_write_rel(&q->ctail, cnext);
-                return count;
-            } else if (chead < ptail) {
+                /* take what is there */
                 cnext = ptail;
-                ASSERT((cnext - chead) < VSIZE_MAX);
-                count = (vsize_t)(cnext - chead);
-                if (vatomic64_cmpxchg_rlx(&q->chead, chead, cnext) != chead) {
-                    continue;
-                }
-                vatomic64_write_rlx(&q->ptail_cached, ptail);
-                for (vsize_t i = 0; i < count; i++) {
-                    buf[i] = q->entry[(chead + i) % q->size];
-                }
-                await_while (vatomic64_read_rlx(&q->ctail) != chead) {}
-                vatomic64_write_rel(&q->ctail, cnext);
-                return count;
-            } else {
-                return 0;
             }
+            if (vatomic64_cmpxchg_rlx(&q->chead, chead, cnext) != chead) {
+                continue;
+            }
+            vatomic64_write_rlx(&q->ptail_cached, ptail);
+        } else if (vatomic64_cmpxchg_rlx(&q->chead, chead, cnext) != chead) {
+            continue;
         }
+        ASSERT((cnext - chead) < VSIZE_MAX);
+        count = (vsize_t)(cnext - chead);
+        _cachedq_copy_out(q, chead, buf, count);
+        _cachedq_publish(q, &q->ctail, chead, cnext, CACHEDQ_MARK_CONS);
+        CACHEDQ_NOTIFY(q);
+        return count;
+    }
+}
+/**
+ * Enqueues `count` entries, waits while the cachedq has no space for them.
+ *
+ * @param q address of `cachedq_t` object.
+ * @param buf   pointer to first entry.
+ * @param count number of entries to enqueue, at most the capacity.
+ *
+ * @return number of enqueued entries, i.e., `count`.
+ */
+static inline vsize_t
+cachedq_enqueue_wait(cachedq_t *q, vuint64_t *buf, vsize_t count)
+{
+    ASSERT(q);
+    ASSERT(count <= q->size);
+    if (count == 0) {
+        return 0;
+    }
+    cachedq_await_while (q, cachedq_enqueue(q, buf, count) == 0) {}
+    return count;
+}
+/**
+ * Dequeues one or more entries, waits while the cachedq is empty.
+ *
+ * @param q address of `cachedq_t` object.
+ * @param buf   pointer to preallocated memory for the first entry.
+ * @param count number of entries to dequeue.
+ *
+ * @return number of dequeued entries, at least one if `count > 0`.
+ */
+static inline vsize_t
+cachedq_dequeue_wait(cachedq_t *q, vuint64_t *buf, vsize_t count)
+{
+    vsize_t n = 0;
+
+    ASSERT(q);
+    if (count == 0) {
+        return 0;
     }
+    cachedq_await_while (q, (n = cachedq_dequeue(q, buf, count)) == 0) {}
+    return n;
 }
 /**
  * Returns the current number of entries in the cachedq.
@@ -207,4 +272,130 @@ cachedq_count(cachedq_t *q)
     return (vsize_t)(p - c);
 }
 
+static inline vsize_t
+_cachedq_idx(cachedq_t *q, vuint64_t pos)
+{
+    return (vsize_t)(q->mask != 0 ? pos & q->mask : pos % q->size);
+}
+/* the marks follow the entries */
+static inline vatomic64_t *
+_cachedq_mark(cachedq_t *q, vsize_t idx)
+{
+    return (vatomic64_t *)&q->entry[q->size + idx];
+}
+static inline void
+_cachedq_copy(vuint64_t *dst, const vuint64_t *src, vsize_t count)
+{
+#if defined(VSYNC_VERIFICATION)
+    for (vsize_t i = 0; i < count; i++) {
+        dst[i] = src[i];
+    }
+#else
+    if (count > 0) {
+        int r = memcpy_s(dst, count * sizeof(vuint64_t), src,
+                         count * sizeof(vuint64_t));
+        BUG_ON(r != 0);
+    }
+#endif
+}
+/* copies into the ring in at most two segments, the second one wraps */
+static inline void
+_cachedq_copy_in(cachedq_t *q, vuint64_t pos, const vuint64_t *buf,
+                 vsize_t count)
+{
+    vsize_t idx   = _cachedq_idx(q, pos);
+    vsize_t first = (vsize_t)VMIN(count, q->size - idx);
+    _cachedq_copy(&q->entry[idx], buf, first);
+    _cachedq_copy(&q->entry[0], buf + first, count - first);
+}
+static inline void
+_cachedq_copy_out(cachedq_t *q, vuint64_t pos, vuint64_t *buf, vsize_t count)
+{
+    vsize_t idx   = _cachedq_idx(q, pos);
+    vsize_t first = (vsize_t)VMIN(count, q->size - idx);
+    _cachedq_copy(buf, &q->entry[idx], first);
+    _cachedq_copy(buf + first, &q->entry[0], count - first);
+}
+static inline vsize_t
+_cachedq_enqueue(cachedq_t *q, vuint64_t *buf, vsize_t count, vbool_t burst)
+{
+    vuint64_t phead = 0;
+    vuint64_t pnext = 0;
+    vuint64_t ctail = 0;
+
+    ASSERT(q);
+    ASSERT(buf);
+
+    while (true) {
+        phead = vatomic64_read_rlx(&q->phead);
+        pnext = phead + count;
+        ctail = vatomic64_read_rlx(&q->ctail_cached);
+        if (pnext > ctail + q->size) {
+            /* the cached value might be stale */
+            ctail = vatomic64_read_acq(&q->ctail);
+            if (pnext > ctail + q->size) {
+                if (!burst || phead >= ctail + q->size) {
+                    return 0;
+                }
+                /* take what is left */
+                pnext = ctail + q->size;
+            }
+            if (vatomic64_cmpxchg_rlx(&q->phead, phead, pnext) != phead) {
+                continue;
+            }
+            vatomic64_write_rlx(&q->ctail_cached, ctail);
+        } else if (vatomic64_cmpxchg_rlx(&q->phead, phead, pnext) != phead) {
+            continue;
+        }
+        ASSERT((pnext - phead) < VSIZE_MAX);
+        count = (vsize_t)(pnext - phead);
+        _cachedq_copy_in(q, phead, buf, count);
+        _cachedq_publish(q, &q->ptail, phead, pnext, CACHEDQ_MARK_PROD);
+        CACHEDQ_NOTIFY(q);
+        return count;
+    }
+}
+/*
+ * Moves `tail` from `head` to `next` once all batches before are finished.
+ *
+ * In-order mode waits for the predecessors. Relaxed mode stores `next`,
+ * tagged with the side, in the mark of the first slot of the batch and then
+ * advances the tail over every finished batch it finds, starting from the
+ * current tail. A mark is only taken if it has the right tag and ends after
+ * the tail; marks of older laps end at most at the tail. The slot of a batch
+ * cannot be reused before the tail passed the batch.
+ */
+static inline void
+_cachedq_publish(cachedq_t *q, vatomic64_t *tail, vuint64_t head,
+                 vuint64_t next, vuint64_t tag)
+{
+#if defined(CACHEDQ_RELAXED_TAIL)
+    vuint64_t cur  = 0;
+    vuint64_t mark = 0;
+    vuint64_t old  = 0;
+
+    if (head == next) {
+        /* empty batch, the slot may belong to somebody else already */
+        return;
+    }
+    /* seq_cst: either we see the tail reaching our batch, or whoever moves
+     * the tail there sees our mark */
+    vatomic64_write(_cachedq_mark(q, _cachedq_idx(q, head)),
+                    (next << 1) | tag);
+    cur = vatomic64_read(tail);
+    while (true) {
+        mark = vatomic64_read(_cachedq_mark(q, _cachedq_idx(q, cur)));
+        if ((mark & 1U) != tag || (mark >> 1) <= cur) {
+            /* the batch at the tail is not finished, its owner moves on */
+            return;
+        }
+        old = vatomic64_cmpxchg(tail, cur, mark >> 1);
+        cur = old == cur ? mark >> 1 : old;
+    }
+#else
+    V_UNUSED(q, tag);
+    await_while (vatomic64_read_rlx(tail) != head) {}
+    vatomic64_write_rel(tail, next);
+#endif
+}
 #endif /* VSYNC_CACHEDQ_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2025-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -7,12 +7,22 @@
 #define VDEQUE_H
 /*******************************************************************************
  * @file chaselev.h
- * @brief Chase-Lev Work-Stealing bounded deque.
+ * @brief Chase-Lev Work-Stealing deque.
  *
  * @ingroup lock_free
  *
- * The deque has a bounded size and returns errors in case the deque is
- * full, empty, or if there is contention while trying to pop/steal.
+ * The deque returns errors in case the deque is full, empty, or if there is
+ * contention while trying to pop/steal.
+ *
+ * A deque initialized with `vdeque_init` has the bounded size of the given
+ * array. A deque initialized with `vdeque_init_growable` allocates its array
+ * with the given `vmem_lib_t` and, when the owner pushes into a full array,
+ * switches to a new array of twice the size holding a copy of the entries.
+ * Thieves might still read the replaced array. It is handed to the `retire`
+ * callback, which should defer freeing it with `vdeque_array_free` via SMR,
+ * in which case `vdeque_steal` must be called inside an SMR critical section.
+ * Without callback, the deque keeps replaced arrays until `vdeque_destroy`;
+ * since the size doubles, they take less memory than the current array.
  *
  *
  * @cite
@@ -24,20 +34,32 @@
  ******************************************************************************/
 #include <vsync/atomic.h>
 #include <vsync/common/assert.h>
+#include <vsync/utils/alloc.h>
 
 typedef struct vdeque_array_s {
+    struct vdeque_array_s *prev; /* replaced array, kept without callback */
     vatomicsz_t size;
     vatomicptr_t buffer[];
 } vdeque_array_t;
 
+/**
+ * Callback receiving arrays replaced by a growth.
+ *
+ * @param a address of the replaced vdeque_array_t object.
+ * @param arg extra argument given at init.
+ */
+typedef void (*vdeque_retire_array_t)(vdeque_array_t *a, void *arg);
+
 typedef struct vdeque_s {
     vatomicsz_t top;
+    vatomicsz_t claim; /* end of the range of vdeque_steal_many, 0 if none */
     vatomicsz_t bottom;
-    vatomicptr(struct vdeque_array_t *)
-        array; /* Current implementation provides atomic array pointer in order
-                  to accommodate growth of the array buffer in the future. Note:
-                  this will cause for some of the barriers proposed in this
-                  implementation to be changed, once growth is supported. */
+    vatomicptr(struct vdeque_array_t *) array;
+    /* only used by growable deques, accessed by the owner */
+    vdeque_array_t *retired;
+    vdeque_retire_array_t retire;
+    void *retire_arg;
+    vmem_lib_t mem_lib;
 } vdeque_t;
 
 typedef enum vdeque_state_e {
@@ -61,10 +83,18 @@ vdeque_init(vdeque_t *q, vdeque_array_t *a, vsize_t len)
     ASSERT(a && "array is NULL");
     ASSERT(len != 0 && "array with 0 size");
 
+    a->prev = NULL;
     vatomicsz_init(&a->size, len);
     vatomicptr_init(&q->array, a);
     vatomicsz_init(&q->top, 0);
+    vatomicsz_init(&q->claim, 0);
     vatomicsz_init(&q->bottom, 0);
+    q->retired            = NULL;
+    q->retire             = NULL;
+    q->retire_arg         = NULL;
+    q->mem_lib.free_fun   = NULL;
+    q->mem_lib.malloc_fun = NULL;
+    q->mem_lib.arg        = NULL;
 
     /* initialize the array */
     for (vsize_t i = 0; i < len; i++) {
@@ -82,6 +112,114 @@ vdeque_memsize(vsize_t cap)
 {
     return sizeof(vdeque_array_t) + (cap * sizeof(vatomicptr_t));
 }
+/**
+ * Initializes a chase-lev deque that grows when full.
+ *
+ * @param q address of vdeque_t object.
+ * @param len initial length of the array.
+ * @param mem_lib object of type `vmem_lib_t` used to allocate/free arrays.
+ * @param retire address of callback function called on replaced arrays, can
+ * be NULL.
+ * @param retire_arg extra argument passed to `retire`.
+ */
+static inline void
+vdeque_init_growable(vdeque_t *q, vsize_t len, vmem_lib_t mem_lib,
+                     vdeque_retire_array_t retire, void *retire_arg)
+{
+    vdeque_array_t *a = NULL;
+
+    ASSERT(q && "deque is NULL");
+    ASSERT(len != 0 && "array with 0 size");
+    ASSERT(vmem_lib_not_null(&mem_lib));
+
+    a = (vdeque_array_t *)mem_lib.malloc_fun(vdeque_memsize(len), mem_lib.arg);
+    ASSERT(a && "allocation of the array failed");
+    vdeque_init(q, a, len);
+    vmem_lib_copy(&q->mem_lib, &mem_lib);
+    q->retire     = retire;
+    q->retire_arg = retire_arg;
+}
+/**
+ * Frees an array of a growable deque.
+ *
+ * Meant to be called from the SMR callback of arrays passed to `retire`.
+ *
+ * @param q address of vdeque_t object.
+ * @param a address of vdeque_array_t object.
+ */
+static inline void
+vdeque_array_free(vdeque_t *q, vdeque_array_t *a)
+{
+    ASSERT(q);
+    ASSERT(a);
+    q->mem_lib.free_fun(a, q->mem_lib.arg);
+}
+/**
+ * Destroys a growable deque, frees its current and kept arrays.
+ *
+ * @param q address of vdeque_t object.
+ *
+ * @note call only after all threads are done accessing the deque.
+ */
+static inline void
+vdeque_destroy(vdeque_t *q)
+{
+    vdeque_array_t *a    = NULL;
+    vdeque_array_t *prev = NULL;
+
+    ASSERT(q);
+    ASSERT(vmem_lib_not_null(&q->mem_lib) && "deque is not growable");
+    a = (vdeque_array_t *)vatomicptr_read_rlx(&q->array);
+    vdeque_array_free(q, a);
+    for (a = q->retired; a != NULL; a = prev) {
+        prev = a->prev;
+        vdeque_array_free(q, a);
+    }
+    q->retired = NULL;
+    vatomicptr_write_rlx(&q->array, NULL);
+}
+/**
+ * Replaces the full array `a` with one of twice the size, called by the owner.
+ *
+ * @param q address of vdeque_t object.
+ * @param a address of the current vdeque_array_t object.
+ * @param top index of the top, possibly stale.
+ * @param bottom index of the bottom.
+ * @return address of the new array, NULL if the deque is not growable or the
+ * allocation failed.
+ */
+static inline vdeque_array_t *
+_vdeque_grow(vdeque_t *q, vdeque_array_t *a, vsize_t top, vsize_t bottom)
+{
+    vdeque_array_t *na = NULL;
+    vsize_t size       = vatomicsz_read_rlx(&a->size);
+    vsize_t nsize      = size * 2U;
+
+    if (!vmem_lib_not_null(&q->mem_lib) || nsize < size) {
+        return NULL;
+    }
+    na = (vdeque_array_t *)q->mem_lib.malloc_fun(vdeque_memsize(nsize),
+                                                 q->mem_lib.arg);
+    if (na == NULL) {
+        return NULL;
+    }
+    na->prev = NULL;
+    vatomicsz_init(&na->size, nsize);
+    /* entries below a stale top are copied needlessly, but harmlessly */
+    for (vsize_t i = top; i != bottom; i++) {
+        vatomicptr_init(&na->buffer[i % nsize],
+                        vatomicptr_read_rlx(&a->buffer[i % size]));
+    }
+    /* release: thieves reading the new array see the copied entries */
+    vatomicptr_write_rel(&q->array, na);
+    if (q->retire != NULL) {
+        q->retire(a, q->retire_arg);
+    } else {
+        a->prev    = q->retired;
+        q->retired = a;
+    }
+    return na;
+}
 /**
  * Tries to push a value to the bottom.
  *
@@ -89,7 +227,7 @@ vdeque_memsize(vsize_t cap)
  * @param in_obj address of object to push.
  *
  * @return VDEQUE_STATE_OK if successful.
- * @return VDEQUE_STATE_FULL if deque is full.
+ * @return VDEQUE_STATE_FULL if deque is full and cannot grow.
  */
 static inline vdeque_state_t
 vdeque_push_bottom(vdeque_t *q, void *in_obj)
@@ -106,7 +244,11 @@ vdeque_push_bottom(vdeque_t *q, void *in_obj)
     vsize_t cmp_size = size - 1U;
     /* Check if deque is full. */
     if ((bottom - top) > cmp_size) {
-        return VDEQUE_STATE_FULL;
+        a = _vdeque_grow(q, a, top, bottom);
+        if (a == NULL) {
+            return VDEQUE_STATE_FULL;
+        }
+        size = vatomicsz_read_rlx(&a->size);
     }
     vsize_t idx = bottom % size;
     vatomicptr_write_rlx(&a->buffer[idx], in_obj);
@@ -123,6 +265,9 @@ vdeque_push_bottom(vdeque_t *q, void *in_obj)
  * @return VDEQUE_STATE_OK if successful.
  * @return VDEQUE_STATE_EMPTY if deque is empty, or if it failed to take the
  * last element.
+ *
+ * @note if a concurrent `vdeque_steal_many` claimed a range including the
+ * bottom value, the oldest value is taken instead, as `vdeque_steal` does.
  */
 static inline vdeque_state_t
 vdeque_pop_bottom(vdeque_t *q, void **out_obj)
@@ -146,9 +291,27 @@ vdeque_pop_bottom(vdeque_t *q, void **out_obj)
     bottom            = bottom - 1;
     vdeque_array_t *a = (vdeque_array_t *)vatomicptr_read_rlx(&q->array);
     vatomicsz_write(&q->bottom, bottom);
+    /* A thief claiming after this point reads the new bottom and gives up if
+     * its range includes ours. One that claimed before might not have. */
+    vsize_t claim        = vatomicsz_read(&q->claim);
     vsize_t top          = vatomicsz_read(&q->top);
     vdeque_state_t state = VDEQUE_STATE_OK;
-    if (top <= bottom) {
+    if (top < bottom && bottom < claim) {
+        /* Contention with vdeque_steal_many. Give the bottom back and take
+         * the top like vdeque_steal: our CAS on top makes the CAS of the
+         * thief fail. A failed CAS means another thread took a value, so we
+         * retry at most once per value. */
+        vatomicsz_write_rlx(&q->bottom, bottom + 1U);
+        vsize_t size = vatomicsz_read_rlx(&a->size);
+        vsize_t seen = 0;
+        state        = VDEQUE_STATE_EMPTY;
+        while (state == VDEQUE_STATE_EMPTY && top <= bottom) {
+            *out_obj = vatomicptr_read_rlx(&a->buffer[top % size]);
+            seen     = vatomicsz_cmpxchg(&q->top, top, top + 1U);
+            state    = seen == top ? VDEQUE_STATE_OK : VDEQUE_STATE_EMPTY;
+            top      = seen;
+        }
+    } else if (top <= bottom) {
         /* Non-empty deque. */
         vsize_t size = vatomicsz_read_rlx(&a->size);
         vsize_t idx  = bottom % size;
@@ -190,8 +353,11 @@ vdeque_steal(vdeque_t *q, void **out_obj)
     vsize_t top    = vatomicsz_read(&q->top);
     vsize_t bottom = vatomicsz_read(&q->bottom);
     if (top < bottom) {
-        /* Non-empty deque. */
-        vdeque_array_t *a = (vdeque_array_t *)vatomicptr_read_rlx(&q->array);
+        /* Non-empty deque. Acquire: pairs with the release in _vdeque_grow,
+         * so that the entries copied into a new array are visible. A stale
+         * array still holds the entry at top, the owner stops writing into
+         * it before it could overwrite that entry. */
+        vdeque_array_t *a = (vdeque_array_t *)vatomicptr_read_acq(&q->array);
         vsize_t size      = vatomicsz_read_rlx(&a->size);
         vsize_t idx       = top % size;
         *out_obj          = vatomicptr_read_rlx(&a->buffer[idx]);
@@ -204,4 +370,75 @@ vdeque_steal(vdeque_t *q, void **out_obj)
     return state;
 }
 
+/**
+ * Tries to steal up to half of the values from the top with a single CAS.
+ *
+ * Takes `min(max, ceil(n / 2))` values if the thief sees `n` values, so that
+ * a single value can be stolen too. The values are stored in `out_objs` from
+ * the oldest to the newest.
+ *
+ * @param q address of vdeque_t object.
+ * @param out_objs output array of at least `max` entries.
+ * @param max maximum number of values to steal, `> 0`.
+ * @param out_count output parameter number of stolen values.
+ *
+ * @return VDEQUE_STATE_OK if successful.
+ * @return VDEQUE_STATE_EMPTY if deque is empty.
+ * @return VDEQUE_STATE_ABORT if failed to steal because of contention.
+ *
+ * @note while the call is in flight, `vdeque_pop_bottom` takes the oldest
+ * value instead of racing for the claimed ones, which makes this call return
+ * VDEQUE_STATE_ABORT. Only one call claims a range at a time, concurrent
+ * calls take a single value with `vdeque_steal`.
+ */
+static inline vdeque_state_t
+vdeque_steal_many(vdeque_t *q, void **out_objs, vsize_t max,
+                  vsize_t *out_count)
+{
+    vdeque_state_t state = VDEQUE_STATE_EMPTY;
+
+    ASSERT(q);
+    ASSERT(out_objs);
+    ASSERT(out_count);
+    ASSERT(max != 0);
+
+    *out_count     = 0;
+    vsize_t top    = vatomicsz_read(&q->top);
+    vsize_t bottom = vatomicsz_read(&q->bottom);
+    if (top >= bottom) {
+        /* Empty deque, leave the owner alone. */
+        return VDEQUE_STATE_EMPTY;
+    }
+    vsize_t n = (bottom - top + 1U) / 2U;
+    n         = n < max ? n : max;
+    /* seq_cst: pairs with the read of claim in vdeque_pop_bottom */
+    if (vatomicsz_cmpxchg(&q->claim, 0, top + n) != 0) {
+        /* Another vdeque_steal_many is in flight, take a single value. */
+        state      = vdeque_steal(q, &out_objs[0]);
+        *out_count = state == VDEQUE_STATE_OK ? 1U : 0U;
+        return state;
+    }
+    /* From now on the owner does not pop into our range, unless it did
+     * before we claimed it, in which case we see the lower bottom. */
+    if (vatomicsz_read(&q->bottom) < top + n) {
+        state = VDEQUE_STATE_ABORT;
+    } else {
+        /* see vdeque_steal for the acquire */
+        vdeque_array_t *a = (vdeque_array_t *)vatomicptr_read_acq(&q->array);
+        vsize_t size      = vatomicsz_read_rlx(&a->size);
+        for (vsize_t i = 0; i < n; i++) {
+            out_objs[i] = vatomicptr_read_rlx(&a->buffer[(top + i) % size]);
+        }
+        state = VDEQUE_STATE_OK;
+        if (vatomicsz_cmpxchg(&q->top, top, top + n) != top) {
+            /* Failed race. */
+            state = VDEQUE_STATE_ABORT;
+        } else {
+            *out_count = n;
+        }
+    }
+    vatomicsz_write_rel(&q->claim, 0);
+    return state;
+}
+
 #endif
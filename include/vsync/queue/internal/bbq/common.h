@@ -30,6 +30,10 @@
 #define BBQ_GLOBAL_IDX(v)        ((v) & ((1ULL << BBQ_BLOCK_NUM_LOG) - 1))
 #define BBQ_GLOBAL_VSN(v)        (((v) >> BBQ_BLOCK_NUM_LOG) & BBQ_GLOBA_VERSION_MASK)
 #define BBQ_GLOBAL_COMPOSE(h, l) (((h) << BBQ_BLOCK_NUM_LOG) | (l))
+#define BBQ_BLOCK_NUM            (1ULL << BBQ_BLOCK_NUM_LOG)
+/* version of the block cursors while the block holds the global index `v`,
+ * the first block moves to a new version when the others wrap around */
+#define BBQ_BLOCK_VSN(v) (BBQ_GLOBAL_VSN(v) + (BBQ_GLOBAL_IDX(v) != 0))
 
 /* local var related */
 #define BBQ_LOCAL_SPACE_BIT     20U /* >16 to provent the FAA overflow */
@@ -38,11 +42,43 @@
 #define BBQ_LOCAL_VSN(v)        ((v) >> BBQ_LOCAL_SPACE_BIT)
 #define BBQ_LOCAL_COMPOSE(h, l) (((h) << BBQ_LOCAL_SPACE_BIT) | (l))
 
+/* queue modes, see the BBQ paper */
+typedef enum bbq_mode_e {
+    /* enqueue fails if the queue is full */
+    BBQ_MODE_RETRY_NEW = 0,
+    /* enqueue overwrites the oldest block if the queue is full */
+    BBQ_MODE_DROP_OLD = 1,
+} bbq_mode_t;
+
 typedef struct bbq_config_s {
     vuint16_t blk_size_log; /* total size of each block (in log) */
     vuint16_t blk_size;     /* total size of each block */
+    vuint16_t mode;         /* one of bbq_mode_t */
 } bbq_config_t;
 
+/**
+ * A contiguous region of a block handed out by the zero-copy API.
+ *
+ * Only `data` and `len` are meant to be accessed by users.
+ */
+typedef struct bbq_span_s {
+    void *data;    /* address of the first byte */
+    vuint32_t len; /* length in bytes, the payload length for records */
+    /* private fields */
+    vuint32_t size;   /* bytes claimed in the block, 0 if nothing claimed */
+    void *blk;        /* block holding the span */
+    vuint64_t cursor; /* block cursor before the span was claimed */
+} bbq_span_t;
+
+#define BBQ_SPAN_SET(span, b, c, d, l, sz)                                     \
+    do {                                                                       \
+        (span)->blk    = (b);                                                  \
+        (span)->cursor = (c);                                                  \
+        (span)->data   = (d);                                                  \
+        (span)->len    = (l);                                                  \
+        (span)->size   = (sz);                                                 \
+    } while (0)
+
 #define BBQ_BLOCK_INIT_VALUE(S)                                                \
     ((sizeof(S) / BBQ_ENTRY_SIZE + 1) * BBQ_ENTRY_SIZE)
 
@@ -94,6 +130,35 @@ bbq_reset_block_cursor_heavy(vatomic64_t *v, vuint64_t new_vsn,
 
 #define BBQ_ADVANCE_HEAD(v, old, new) vatomic64_max(v, new)
 
+/* waiting for space or entries */
+#if defined(BBQ_PARK)
+    #include <vsync/thread/internal/park.h>
+    #define bbq_await_while(q, cond) vpark_await_while(&(q)->park, cond)
+    #define BBQ_NOTIFY(q)            vpark_notify(&(q)->park)
+#else
+    #define bbq_await_while(q, cond) await_while (cond)
+    #define BBQ_NOTIFY(q)                                                      \
+        do {                                                                   \
+        } while (0)
+#endif
+
+/* variable-size records */
+/* every record starts with a header entry holding the payload length */
+#define BBQ_RECORD_HDR_SIZE BBQ_ENTRY_SIZE
+/* header length of the padding that fills the unusable tail of a block */
+#define BBQ_RECORD_PAD VUINT32_MAX
+/* space taken by a record with `len` payload bytes, a multiple of entry size */
+#define BBQ_RECORD_SIZE(len)                                                   \
+    (((vsize_t)(len) + BBQ_RECORD_HDR_SIZE + BBQ_ENTRY_SIZE - 1) &             \
+     ~(vsize_t)(BBQ_ENTRY_SIZE - 1))
+#define BBQ_RECORD_LEN(entry) (*(vuint32_t *)(entry))
+#define BBQ_RECORD_DATA(entry)                                                 \
+    ((void *)(((vuintptr_t)(entry)) + BBQ_RECORD_HDR_SIZE))
+/* largest payload that fits in an empty block */
+#define BBQ_RECORD_MAX_LEN(rb, S)                                              \
+    ((vuint32_t)((rb)->config.blk_size - BBQ_BLOCK_INIT_VALUE(S) -             \
+                 BBQ_RECORD_HDR_SIZE))
+
 #define BBQ_COUNT(rb, name, name_uc)                                           \
     ({                                                                         \
         vuint64_t ridx = BBQ_##name_uc##_READ_CONS((rb)->ridx);                \
@@ -41,6 +41,13 @@
  *
  * Enqueue operation is wait-free.
  *
+ * `vmpsc_deq_batch` dequeues up to a given number of entries in one call and
+ * hands back all discarded nodes as one chain. The consumer can return such
+ * chains to the queue with `vmpsc_recycle`. Producers take recycled nodes with
+ * `vmpsc_node_get`, which grabs the whole free list at once into a
+ * per-producer `vmpsc_node_cache_t`, and only allocate new nodes when it
+ * returns NULL.
+ *
  * @ingroup unbounded_queue
  *
  * @example
@@ -64,8 +71,16 @@ typedef struct vmpsc_s {
     vatomicptr_t tail;     /* address of most recent node in the queue */
     vmpsc_node_t *head;    /* address of least recent node in the queue */
     vmpsc_node_t sentinel; /* sentinel node */
+    vatomicptr_t free;     /* recycled nodes, linked via next */
 } vmpsc_t;
 
+/**
+ * Per-producer cache of recycled nodes.
+ */
+typedef struct vmpsc_node_cache_s {
+    vmpsc_node_t *nodes;
+} vmpsc_node_cache_t;
+
 typedef void (*vmpsc_visit_t)(vmpsc_node_t *node, void *args);
 typedef vbool_t (*vmpsc_data_visit_t)(void *data, void *args);
 /**
@@ -85,6 +100,7 @@ vmpsc_init(vmpsc_t *q)
     /* both head and tail point to the sentinel */
     q->head = sentinel;
     vatomicptr_write_rlx(&q->tail, sentinel);
+    vatomicptr_write_rlx(&q->free, NULL);
 }
 /**
  * Calls the given `f` function on each enqueued node's data.
@@ -120,6 +136,7 @@ vmpsc_foreach(const vmpsc_t *q, vmpsc_data_visit_t f, void *args)
  *
  * @note call only after all threads are done accessing the queue.
  * @note use the callback function to destruct nodes and data objects.
+ * @note recycled nodes are visited too, their data is NULL.
  */
 static inline void
 vmpsc_destroy(vmpsc_t *q, vmpsc_visit_t f, void *args)
@@ -133,6 +150,13 @@ vmpsc_destroy(vmpsc_t *q, vmpsc_visit_t f, void *args)
         }
         cur = next;
     }
+    cur = vatomicptr_read_rlx(&q->free);
+    while (cur) {
+        next = vatomicptr_read_rlx(&cur->next);
+        f(cur, args);
+        cur = next;
+    }
+    vatomicptr_write_rlx(&q->free, NULL);
 }
 /**
  * Enqueues the given node into the given queue.
@@ -197,10 +221,171 @@ vmpsc_deq(vmpsc_t *q, vmpsc_node_t **discarded_node)
          * tail->next is NULL. hence tail != head.
          * and it is safe to free head.
          */
+        vatomicptr_write_rlx(&head->next, NULL);
         *discarded_node = head;
     }
     return entry;
 }
+/**
+ * Dequeues up to `max` data objects from the queue.
+ *
+ * If the queue looks empty but a producer is in the middle of enqueuing, the
+ * call waits for that producer to link its entry, like `vmpsc_deq`, as long
+ * as no entry has been dequeued yet. Once it has dequeued at least one entry,
+ * it stops at the first entry that is not linked yet instead of waiting.
+ *
+ * @param q address of vmpsc_t object.
+ * @param out output array of at least `max` entries, filled in FIFO order.
+ * @param max maximum number of entries to dequeue.
+ * @param discarded output parameter. Chain of the discarded vmpsc_node_t
+ * objects linked via `next`, or NULL. Can be passed to `vmpsc_recycle`.
+ *
+ * @return number of dequeued entries, 0 if the queue is empty.
+ *
+ * @note to be called only by the consumer.
+ */
+static inline vsize_t
+vmpsc_deq_batch(vmpsc_t *q, void **out, vsize_t max,
+                vmpsc_node_t **discarded)
+{
+    vmpsc_node_t *head  = NULL;
+    vmpsc_node_t *next  = NULL;
+    vmpsc_node_t *first = NULL;
+    vmpsc_node_t *last  = NULL;
+    vsize_t count       = 0;
+
+    ASSERT(q);
+    ASSERT(out);
+    ASSERT(discarded);
+    *discarded = NULL;
+    head       = q->head;
+    while (count < max) {
+        next = vatomicptr_read_acq(&head->next);
+        if (next == NULL) {
+            if (count != 0 || vatomicptr_read_rlx(&q->tail) == head) {
+                break;
+            }
+            /* a producer is mid-enq, wait for the first entry */
+            next = vatomicptr_await_neq_acq(&head->next, NULL);
+        }
+        out[count++] = next->data;
+        ASSERT(next->data);
+        next->data = NULL;
+        /* head has a successor, see vmpsc_deq why it can be discarded */
+        if (likely(head != &q->sentinel)) {
+            if (last == NULL) {
+                first = head;
+            } else {
+                vatomicptr_write_rlx(&last->next, head);
+            }
+            last = head;
+        }
+        head = next;
+    }
+    q->head = head;
+    if (last != NULL) {
+        vatomicptr_write_rlx(&last->next, NULL);
+    }
+    *discarded = first;
+    return count;
+}
+/**
+ * Returns a chain of discarded nodes to the free list of the queue.
+ *
+ * @param q address of vmpsc_t object.
+ * @param chain address of the first vmpsc_node_t object of a chain linked via
+ * `next`, as returned by `vmpsc_deq_batch`, or a node discarded by
+ * `vmpsc_deq`.
+ *
+ * @note to be called only by the consumer.
+ */
+static inline void
+vmpsc_recycle(vmpsc_t *q, vmpsc_node_t *chain)
+{
+    vmpsc_node_t *last = chain;
+    vmpsc_node_t *next = NULL;
+    vmpsc_node_t *top  = NULL;
+    vmpsc_node_t *cur  = NULL;
+
+    ASSERT(q);
+    if (chain == NULL) {
+        return;
+    }
+    while ((next = vatomicptr_read_rlx(&last->next)) != NULL) {
+        last = next;
+    }
+    /* only the consumer pushes, producers only take everything, so there is
+     * no ABA on the top */
+    top = vatomicptr_read_rlx(&q->free);
+    do {
+        cur = top;
+        vatomicptr_write_rlx(&last->next, cur);
+        /* release: the producer taking the nodes sees our last accesses */
+        top = vatomicptr_cmpxchg_rel(&q->free, cur, chain);
+    } while (top != cur);
+}
+/**
+ * Initializes a per-producer node cache.
+ *
+ * @param cache address of vmpsc_node_cache_t object.
+ */
+static inline void
+vmpsc_node_cache_init(vmpsc_node_cache_t *cache)
+{
+    ASSERT(cache);
+    cache->nodes = NULL;
+}
+/**
+ * Takes a recycled node for the next `vmpsc_enq`.
+ *
+ * Refills the cache with the whole free list of the queue if it is empty.
+ *
+ * @param q address of vmpsc_t object.
+ * @param cache address of the vmpsc_node_cache_t object of the producer.
+ *
+ * @return address of a vmpsc_node_t object, NULL if no node is recycled. The
+ * caller has to allocate one then.
+ */
+static inline vmpsc_node_t *
+vmpsc_node_get(vmpsc_t *q, vmpsc_node_cache_t *cache)
+{
+    vmpsc_node_t *node = NULL;
+
+    ASSERT(q);
+    ASSERT(cache);
+    if (cache->nodes == NULL) {
+        if (vatomicptr_read_rlx(&q->free) == NULL) {
+            return NULL;
+        }
+        cache->nodes = vatomicptr_xchg_acq(&q->free, NULL);
+    }
+    node = cache->nodes;
+    if (node != NULL) {
+        cache->nodes = vatomicptr_read_rlx(&node->next);
+    }
+    return node;
+}
+/**
+ * Calls the given `f` function on each node of the cache and empties it.
+ *
+ * @param cache address of vmpsc_node_cache_t object.
+ * @param f function pointer of type vmpsc_visit_t.
+ * @param args extra arguments of `f`.
+ */
+static inline void
+vmpsc_node_cache_destroy(vmpsc_node_cache_t *cache, vmpsc_visit_t f,
+                         void *args)
+{
+    vmpsc_node_t *cur  = NULL;
+    vmpsc_node_t *next = NULL;
+
+    ASSERT(cache);
+    for (cur = cache->nodes; cur != NULL; cur = next) {
+        next = vatomicptr_read_rlx(&cur->next);
+        f(cur, args);
+    }
+    cache->nodes = NULL;
+}
 /**
  * Checks if the current queue is empty or not.
  *
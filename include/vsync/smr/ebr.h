@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2025-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -18,6 +18,26 @@
  * - global epoch = `e+1` => nodes retired on epoch `e-1` are safe
  * to recycle.
  *
+ * Retired nodes are kept in per-thread lists tagged with the epoch they were
+ * retired in, so retiring does not write shared state. Once a thread has
+ * `VEBR_RETIRE_BATCH` more nodes pending, it tries to advance the global epoch
+ * when it leaves its critical section and frees its own nodes that became
+ * safe. Nodes still pending when a thread deregisters are handed off to global
+ * lists, which `vebr_recycle` frees.
+ *
+ * Define `VEBR_ROBUST` to enable cooperative neutralization. A recycler that
+ * waits for a thread stuck in a long critical section for
+ * `VEBR_ROBUST_PATIENCE` iterations asks it to restart and stops waiting: it
+ * releases the lock and gives up advancing the epoch this time. The thread
+ * notices the request at its next `vebr_check`, drops all references it holds
+ * and restarts its operation on the current epoch, after which recyclers make
+ * progress again. Until then, nothing it could reference is freed, so the
+ * restart is what keeps it safe, not the recycler. A thread that never calls
+ * `vebr_check` only delays reclamation until it leaves its critical section.
+ * `vebr_recycle` returns in the meantime, `vebr_sync` keeps retrying without
+ * holding the lock. Long running critical sections, e.g., traversals, should
+ * call `vebr_check` at points where they can restart.
+ *
  * @example
  * @include eg_vebr.c
  *
@@ -37,6 +57,17 @@
 #include <vsync/smr/internal/smr_nodes_list.h>
 
 #define V_EBR_EPOCH_COUNT (vuint64_t)3
+
+#if defined(VSYNC_VERIFICATION)
+    #undef VEBR_RETIRE_BATCH
+    #define VEBR_RETIRE_BATCH 2U
+#elif !defined(VEBR_RETIRE_BATCH)
+    /**
+     * Number of nodes a thread retires before it attempts to recycle its own
+     * retired nodes.
+     */
+    #define VEBR_RETIRE_BATCH 64U
+#endif
 /*
  * Calculate the queue index associated with the given epoch
  * e = 1 => 1
@@ -61,6 +92,24 @@
 #define V_EBR_GET_PREV_EPOCH_IDX(_e_)                                          \
     ((vsize_t)(((_e_) + 2U) % V_EBR_EPOCH_COUNT))
 
+#if defined(VEBR_ROBUST) && !defined(VEBR_ROBUST_PATIENCE)
+    /**
+     * Number of iterations a recycler waits for a thread before it requests
+     * the thread to restart.
+     */
+    #define VEBR_ROBUST_PATIENCE 1024U
+#endif
+
+/**
+ * Nodes retired by one thread in one epoch.
+ */
+typedef struct vebr_retired_s {
+    smr_node_t *head;
+    smr_node_t *tail;
+    vuint64_t epoch;
+    vsize_t count;
+} vebr_retired_t;
+
 /**
  * Per-thread EBR object
  */
@@ -68,6 +117,13 @@ typedef struct vebr_instance_s {
     dbl_list_node_t lst_node; /* !!! keep as first field !!! */
     vatomic64_t epoch_local;
     vuint32_t enter_count;
+    /* only accessed by the owner thread */
+    vebr_retired_t retired[V_EBR_EPOCH_COUNT];
+    vsize_t retired_count;
+    vsize_t recycle_at; /* retired_count that triggers self recycling */
+#if defined(VEBR_ROBUST)
+    vatomic32_t neutralized; /* set by recyclers, cleared by the owner */
+#endif
 } vebr_thread_t;
 
 /**
@@ -78,10 +134,20 @@ typedef struct vebr_s {
     smr_nodes_list_t retired_lst[V_EBR_EPOCH_COUNT];
     dbl_list_t threads;
     smr_lock_lib_t lock;
+    vatomic32_t syncing; /* 1 while a thread runs _vebr_sync_epochs */
 } VSYNC_CACHEALIGN vebr_t;
 
+static inline void vebr_enter(vebr_t *ebr, vebr_thread_t *ebr_thrd);
+static inline void vebr_exit(vebr_t *ebr, vebr_thread_t *ebr_thrd);
 static inline vuint64_t _vebr_sync_epochs(vebr_t *ebr, vuint64_t epoch,
                                           vbool_t blocking);
+static inline vsize_t _vebr_recycle_local(vebr_t *ebr, vebr_thread_t *ebr_thrd,
+                                          vuint64_t epoch);
+static inline void _vebr_try_recycle_local(vebr_t *ebr,
+                                           vebr_thread_t *ebr_thrd);
+#if defined(VEBR_ROBUST)
+static inline void _vebr_retire_list(smr_nodes_list_t *lst, smr_node_t *head);
+#endif
 /**
  * Initializes the given object `ebr`.
  *
@@ -99,6 +165,7 @@ vebr_init(vebr_t *ebr, smr_lock_lib_t lock_lib)
         smr_nodes_list_init(&ebr->retired_lst[i]);
     }
     vatomic64_write(&ebr->epoch_global, 1);
+    vatomic32_init(&ebr->syncing, 0);
     ASSERT(smr_lock_lib_is_set(&lock_lib));
 #if defined(VSYNC_VERIFICATION)
     ebr->lock.arg = lock_lib.arg;
@@ -141,7 +208,18 @@ vebr_register(vebr_t *ebr, vebr_thread_t *ebr_thrd)
     ASSERT(ebr);
     ASSERT(ebr_thrd);
     vatomic64_init(&ebr_thrd->epoch_local, 0);
-    ebr_thrd->enter_count = 0;
+    ebr_thrd->enter_count   = 0;
+    ebr_thrd->retired_count = 0;
+    ebr_thrd->recycle_at    = VEBR_RETIRE_BATCH;
+#if defined(VEBR_ROBUST)
+    vatomic32_init(&ebr_thrd->neutralized, 0);
+#endif
+    for (vsize_t i = 0; i < V_EBR_EPOCH_COUNT; i++) {
+        ebr_thrd->retired[i].head  = NULL;
+        ebr_thrd->retired[i].tail  = NULL;
+        ebr_thrd->retired[i].epoch = 0;
+        ebr_thrd->retired[i].count = 0;
+    }
     /* the threads list is protected by a lock */
     ebr->lock.acq(ebr->lock.arg);
     dbl_list_add(&ebr->threads, &ebr_thrd->lst_node);
@@ -150,6 +228,9 @@ vebr_register(vebr_t *ebr, vebr_thread_t *ebr_thrd)
 /**
  * Deregisters the given `ebr_thrd`.
  *
+ * Nodes retired by the thread that are not recycled yet are handed off to
+ * `vebr_recycle`.
+ *
  * @note the thread is associated with the given `ebr_thrd` should not attempt
  * to access the given `ebr` instance after this call.
  * @pre `vebr_register`.
@@ -159,11 +240,34 @@ vebr_register(vebr_t *ebr, vebr_thread_t *ebr_thrd)
 static inline void
 vebr_deregister(vebr_t *ebr, vebr_thread_t *ebr_thrd)
 {
+    vuint64_t epoch         = 0;
+    vsize_t idx             = 0;
+    vebr_retired_t *retired = NULL;
+
     ASSERT(ebr);
     ASSERT(ebr_thrd);
 
     ASSERT(vatomic64_read_rlx(&ebr_thrd->epoch_local) == 0);
 
+    /* hand off like vebr_retire does, i.e., inside the critical section and
+     * on the current global epoch */
+    vebr_enter(ebr, ebr_thrd);
+    vatomic_fence();
+    epoch = vatomic64_read(&ebr->epoch_global);
+    idx   = V_EBR_GET_EPOCH_IDX(epoch);
+    for (vsize_t i = 0; i < V_EBR_EPOCH_COUNT; i++) {
+        retired = &ebr_thrd->retired[i];
+        if (retired->count > 0) {
+            smr_nodes_list_merge(&ebr->retired_lst[idx], retired->head,
+                                 retired->tail, retired->count);
+            retired->head  = NULL;
+            retired->tail  = NULL;
+            retired->count = 0;
+        }
+    }
+    ebr_thrd->retired_count = 0;
+    vebr_exit(ebr, ebr_thrd);
+
     ebr->lock.acq(ebr->lock.arg);
     dbl_list_rem(&ebr->threads, &ebr_thrd->lst_node);
     ebr->lock.rel(ebr->lock.arg);
@@ -191,6 +295,12 @@ vebr_enter(vebr_t *ebr, vebr_thread_t *ebr_thrd)
      */
     ebr_thrd->enter_count++;
     if (ebr_thrd->enter_count == 1) {
+#if defined(VEBR_ROBUST)
+        /* a request to a previous critical section is stale */
+        if (vatomic32_read_rlx(&ebr_thrd->neutralized) != 0U) {
+            vatomic32_write_rlx(&ebr_thrd->neutralized, 0U);
+        }
+#endif
         glb_epoch = vatomic64_read(&ebr->epoch_global);
         vatomic64_write_rel(&ebr_thrd->epoch_local, glb_epoch);
         vatomic_fence();
@@ -199,6 +309,9 @@ vebr_enter(vebr_t *ebr, vebr_thread_t *ebr_thrd)
 /**
  * Marks the end of a critical section, indicates that a reader is inactive.
  *
+ * If the thread has retired `VEBR_RETIRE_BATCH` nodes since its last attempt,
+ * it tries to advance the global epoch and frees its nodes that are safe.
+ *
  * @pre `vebr_enter`
  * @param ebr address of vebr_t object.
  * @param ebr_thrd address of vebr_thread_t object.
@@ -210,17 +323,67 @@ vebr_exit(vebr_t *ebr, vebr_thread_t *ebr_thrd)
     ASSERT(ebr_thrd->enter_count);
     if (ebr_thrd->enter_count == 1U) {
         vatomic64_write_rel(&ebr_thrd->epoch_local, 0U);
+        /* outside of the critical section recyclers do not wait for us, and
+         * we do not wait for them either, see _vebr_try_recycle_local */
+        if (ebr_thrd->retired_count >= ebr_thrd->recycle_at) {
+            _vebr_try_recycle_local(ebr, ebr_thrd);
+        }
     }
     ebr_thrd->enter_count--;
-    V_UNUSED(ebr);
 }
+#if defined(VEBR_ROBUST)
+/**
+ * Checks if a recycler asked the calling thread to restart its operation.
+ *
+ * If so, the thread moves to the current global epoch, after which the nodes
+ * it could see before may be freed at any time.
+ *
+ * ```C
+ * vebr_enter(&ebr, &thrd);
+ * RESTART:
+ * for (node = head(); node; node = next(node)) {
+ *     if (vebr_check(&ebr, &thrd)) {
+ *         goto RESTART;
+ *     }
+ *     ...
+ * }
+ * vebr_exit(&ebr, &thrd);
+ * ```
+ *
+ * @pre `vebr_enter`
+ * @param ebr address of vebr_t object.
+ * @param ebr_thrd address of vebr_thread_t object.
+ * @return true the thread was neutralized, it must not access any reference
+ * obtained before this call and must restart its operation.
+ * @return false the thread can continue.
+ */
+static inline vbool_t
+vebr_check(vebr_t *ebr, vebr_thread_t *ebr_thrd)
+{
+    ASSERT(ebr_thrd);
+    ASSERT(ebr_thrd->enter_count);
+    if (likely(vatomic32_read_rlx(&ebr_thrd->neutralized) == 0U)) {
+        return false;
+    }
+    vatomic32_write_rlx(&ebr_thrd->neutralized, 0U);
+    vatomic64_write_rel(&ebr_thrd->epoch_local,
+                        vatomic64_read(&ebr->epoch_global));
+    vatomic_fence();
+    return true;
+}
+#endif
 /**
  * Defers reclamation of objects until it is safe to do so.
  *
+ * The node is appended to the list of `ebr_thrd` associated with the current
+ * global epoch. The thread frees its nodes itself once they are safe, see
+ * `vebr_exit`.
+ *
  * @note must be called within the critical section. This is important to avoid
  * data race on the local queue when recycle is being called by another thread.
  * @param ebr address of vebr_t object.
- * @param ebr_thrd address of vebr_thread_t object.
+ * @param ebr_thrd address of vebr_thread_t object of the calling thread, or
+ * `NULL` to retire directly to the global lists.
  * @param smr_node address of smr_node_t object.
  * @param dest address of callback function used for destroying the retired
  * `smr_node`.
@@ -229,9 +392,12 @@ static inline void
 vebr_retire(vebr_t *ebr, vebr_thread_t *ebr_thrd, smr_node_t *smr_node,
             smr_node_destroy_fun destructor, void *destructor_args)
 {
-    vuint64_t epoch = 0;
-    vsize_t idx     = 0;
+    vuint64_t epoch         = 0;
+    vsize_t idx             = 0;
+    vebr_retired_t *retired = NULL;
 
+    ASSERT(smr_node);
+    ASSERT(destructor);
     /**
      * The fence is required for scenarios that are similar to
      * test_case_specific_wrap_around_ebr.h
@@ -246,9 +412,27 @@ vebr_retire(vebr_t *ebr, vebr_thread_t *ebr_thrd, smr_node_t *smr_node,
     /* retire on the current global epoch */
     idx = V_EBR_GET_EPOCH_IDX(epoch);
     ASSERT(idx <= V_EBR_EPOCH_COUNT);
-    smr_nodes_list_add(&ebr->retired_lst[idx], smr_node, destructor,
-                       destructor_args);
-    V_UNUSED(ebr_thrd);
+    if (ebr_thrd == NULL) {
+        smr_nodes_list_add(&ebr->retired_lst[idx], smr_node, destructor,
+                           destructor_args);
+        return;
+    }
+
+    retired = &ebr_thrd->retired[idx];
+    if (retired->count > 0 && retired->epoch != epoch) {
+        /* the slot holds nodes of epoch - 3 or older, they are safe */
+        (void)_vebr_recycle_local(ebr, ebr_thrd, epoch);
+    }
+    smr_node->destroy_fun     = destructor;
+    smr_node->destroy_fun_arg = destructor_args;
+    smr_node->core.next       = retired->head ? &retired->head->core : NULL;
+    if (retired->head == NULL) {
+        retired->tail = smr_node;
+    }
+    retired->head  = smr_node;
+    retired->epoch = epoch;
+    retired->count++;
+    ebr_thrd->retired_count++;
 }
 /**
  * Recycles/frees nodes that can safely be freed.
@@ -282,6 +466,14 @@ vebr_recycle(vebr_t *ebr)
     idx       = V_EBR_GET_PREV_EPOCH_IDX(glb_epoch);
     head      = smr_nodes_list_get_and_empty(&ebr->retired_lst[idx]);
     lcl_epoch = _vebr_sync_epochs(ebr, glb_epoch, true);
+#if defined(VEBR_ROBUST)
+    if (lcl_epoch != 0 && lcl_epoch < glb_epoch) {
+        /* a neutralized thread did not restart yet, the nodes go back. The
+         * list is only recycled once an epoch >= glb_epoch is observed */
+        _vebr_retire_list(&ebr->retired_lst[idx], head);
+        return 0;
+    }
+#endif
     ASSERT(lcl_epoch == 0 || lcl_epoch >= glb_epoch);
 
     /*
@@ -354,6 +546,12 @@ vebr_sync(vebr_t *ebr)
             /* all threads are inactive or have observed the target，then our
              * job is done */
             return;
+#if defined(VEBR_ROBUST)
+        } else if (lcl_epoch < cur_epoch) {
+            /* a neutralized thread did not restart yet, retry */
+            verification_ignore();
+            cur_epoch = vatomic64_read(&ebr->epoch_global);
+#endif
         } else {
             /* all active threads have observed `cur_epoch` advance to cur_epoch
              * + 1 */
@@ -364,20 +562,25 @@ vebr_sync(vebr_t *ebr)
             cur_epoch = glb_epoch == cur_epoch ? cur_epoch + 1 : glb_epoch;
         }
     } /* as long as target is not reached */
+#if !defined(VEBR_ROBUST)
     ASSERT(i <= 2);
+#endif
 }
 /**
  * Checks if/ensures every registered thread has observed an epoch >= to the
  * given `epoch`.
  *
- * @note must be called under lock protection. Same lock used to protect
- * threads' registration list.
+ * @note takes the lock that protects the threads' registration list. With
+ * `blocking = false` the caller must own `ebr->syncing`, with `blocking = true`
+ * this function waits for the current owner.
  *
  * @param ebr address of vebr_t object.
  * @param epoch target epoch.
  * @param blocking a boolean flag determines if the API should exit if one of
  * the active threads local epoch is behind the given `epoch` or spin till the
- * thread local epoch catches up, i.e. `t.local_epoch >= epoch`.
+ * thread local epoch catches up, i.e. `t.local_epoch >= epoch`. With
+ * `VEBR_ROBUST`, it spins at most `VEBR_ROBUST_PATIENCE` times, then
+ * neutralizes the thread and exits like `blocking = false`.
  * @return vuint64_t the minimum local_epoch of active threads, or 0 if all
  * registered threads are inactive.
  *
@@ -389,12 +592,21 @@ _vebr_sync_epochs(vebr_t *ebr, vuint64_t epoch, vbool_t blocking)
     vebr_thread_t *thrd   = NULL;
     vuint64_t lcl_epoch   = 0;
     vuint64_t min_epoch   = VUINT64_MAX;
+#if defined(VEBR_ROBUST)
+    vuint32_t patience = 0;
+#endif
 
+    if (blocking) {
+        /* the owner does not block, see _vebr_try_recycle_local */
+        (void)vatomic32_await_eq_set_acq(&ebr->syncing, 0U, 1U);
+    }
     /* for each registered thread */
     ebr->lock.acq(ebr->lock.arg);
     for (node = ebr->threads.head; node; node = node->next) {
         thrd = (vebr_thread_t *)node;
-
+#if defined(VEBR_ROBUST)
+        patience = 0;
+#endif
         do {
             lcl_epoch = vatomic64_read(&thrd->epoch_local);
             if (lcl_epoch == 0) { /* thread is inactive, no need to spin */
@@ -414,18 +626,118 @@ _vebr_sync_epochs(vebr_t *ebr, vuint64_t epoch, vbool_t blocking)
                 } else {
                     /* spinning  */
                     verification_ignore();
+#if defined(VEBR_ROBUST)
+                    if (++patience == VEBR_ROBUST_PATIENCE) {
+                        /* ask the thread to restart on a newer epoch, and
+                         * do not wait for it while holding the lock */
+                        vatomic32_write_rlx(&thrd->neutralized, 1U);
+                        min_epoch = lcl_epoch;
+                        goto EXIT;
+                    }
+#endif
                 }
             }
         } while (true);
     }
 EXIT:
     ebr->lock.rel(ebr->lock.arg);
+    if (blocking) {
+        vatomic32_write_rel(&ebr->syncing, 0U);
+    }
     /* min_epoch == 0 => all inactive */
     /* min_epoch >= epoch => all those that are active have at least observed
      * (valid if blocking = false) min_epoch < epoch => there exists at least
      * one active thread with a local epoch that is behind given epoch */
     return min_epoch == VUINT64_MAX ? 0 : min_epoch;
 }
+/**
+ * Frees the nodes retired by `ebr_thrd` that are safe at the given `epoch`.
+ *
+ * Nodes retired on epoch `e` are safe once the global epoch reached `e + 2`.
+ *
+ * @param ebr address of vebr_t object.
+ * @param ebr_thrd address of vebr_thread_t object.
+ * @param epoch an observed value of the global epoch.
+ * @return vsize_t count of freed nodes.
+ */
+static inline vsize_t
+_vebr_recycle_local(vebr_t *ebr, vebr_thread_t *ebr_thrd, vuint64_t epoch)
+{
+    vsize_t count           = 0;
+    smr_node_t *head        = NULL;
+    vebr_retired_t *retired = NULL;
+
+    for (vsize_t i = 0; i < V_EBR_EPOCH_COUNT; i++) {
+        retired = &ebr_thrd->retired[i];
+        if (retired->count == 0 || retired->epoch + 2U > epoch) {
+            continue;
+        }
+        head = retired->head;
+        ebr_thrd->retired_count -= retired->count;
+        retired->head  = NULL;
+        retired->tail  = NULL;
+        retired->count = 0;
+        count += smr_nodes_list_destroy(head);
+    }
+    V_UNUSED(ebr);
+    return count;
+}
+/**
+ * Tries to advance the global epoch twice without waiting for other threads,
+ * then frees the nodes of `ebr_thrd` that are safe.
+ *
+ * A blocking recycler holds the registration lock while it waits for a
+ * lagging reader. Taking `ebr->syncing` first keeps us from queuing up behind
+ * it: if another thread is synchronizing, we skip advancing the epoch and
+ * only free what is already safe.
+ *
+ * @note must be called outside of the critical section.
+ * @param ebr address of vebr_t object.
+ * @param ebr_thrd address of vebr_thread_t object.
+ */
+static inline void
+_vebr_try_recycle_local(vebr_t *ebr, vebr_thread_t *ebr_thrd)
+{
+    vuint64_t glb_epoch = 0;
+    vuint64_t lcl_epoch = 0;
+
+    /* nodes retired on `e` need the global epoch to reach `e + 2` */
+    if (vatomic32_cmpxchg_acq(&ebr->syncing, 0U, 1U) == 0U) {
+        for (vsize_t i = 0; i < 2U; i++) {
+            glb_epoch = vatomic64_read(&ebr->epoch_global);
+            lcl_epoch = _vebr_sync_epochs(ebr, glb_epoch, false);
+            if (lcl_epoch != 0 && lcl_epoch < glb_epoch) {
+                break;
+            }
+            (void)vatomic64_cmpxchg(&ebr->epoch_global, glb_epoch,
+                                    glb_epoch + 1U);
+        }
+        vatomic32_write_rel(&ebr->syncing, 0U);
+    }
+    (void)_vebr_recycle_local(ebr, ebr_thrd,
+                              vatomic64_read(&ebr->epoch_global));
+    /* amortize the lock of _vebr_sync_epochs over the next batch */
+    ebr_thrd->recycle_at = ebr_thrd->retired_count + VEBR_RETIRE_BATCH;
+}
+#if defined(VEBR_ROBUST)
+/**
+ * Adds the nodes of the list starting at `head` back to `lst`.
+ *
+ * @param lst address of smr_nodes_list_t object.
+ * @param head first node of the list, can be `NULL`.
+ */
+static inline void
+_vebr_retire_list(smr_nodes_list_t *lst, smr_node_t *head)
+{
+    smr_node_t *next = NULL;
+
+    for (; head; head = next) {
+        next = (smr_node_t *)head->core.next;
+        smr_nodes_list_add(lst, head, head->destroy_fun,
+                           head->destroy_fun_arg);
+    }
+}
+#endif
 #undef V_EBR_EPOCH_COUNT
 #undef V_EBR_GET_EPOCH_IDX
 #undef V_EBR_GET_PREV_EPOCH_IDX
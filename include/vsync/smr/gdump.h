@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VSYNC_GDUMP_H
+#define VSYNC_GDUMP_H
+
+/******************************************************************************
+ * @file gdump.h
+ * @brief Grace-period based SMR scheme with batched retirement.
+ *
+ * Readers announce the grace period they observed in a per-thread slot when
+ * they enter their outermost critical section and clear it when they exit.
+ * Readers never write shared state, they only write their own slot.
+ *
+ * Retired nodes are collected in a lock-free pending list. A recycler grabs the
+ * whole list, opens a new grace period `gp + 1`, and waits until every
+ * registered thread has either left its critical section or entered a new one
+ * after the grace period was opened, i.e., its slot is `0` or `>= gp + 1`.
+ * Then, no reader can hold a reference to the grabbed nodes and they are
+ * freed.
+ *
+ * `gdump_retire` pushes nodes one by one to the pending list with a single
+ * CAS and does not take any lock. `gdump_retire_local` buffers nodes in the
+ * calling thread and hands them off `VGDUMP_RETIRE_BATCH` nodes at a time,
+ * which amortizes the CAS over the batch.
+ *
+ * The list of registered threads is protected by a reader-writer lock:
+ * registration takes the write lock, recyclers take the read lock while
+ * scanning.
+ *
+ * @example
+ * @include eg_hashtable_evictable.c
+ *
+ * @cite
+ * Paul E. McKenney et al. - Read-Copy Update
+ *****************************************************************************/
+#include <vsync/atomic.h>
+#include <vsync/common/cache.h>
+#include <vsync/common/assert.h>
+#include <vsync/common/verify.h>
+#include <vsync/common/compiler.h>
+#include <vsync/smr/internal/smr_lock.h>
+#include <vsync/smr/internal/dbl_list.h>
+#include <vsync/smr/internal/smr_nodes_list.h>
+
+#if defined(VSYNC_VERIFICATION)
+    #undef VGDUMP_RETIRE_BATCH
+    #define VGDUMP_RETIRE_BATCH 2U
+#elif !defined(VGDUMP_RETIRE_BATCH)
+    /**
+     * Number of nodes `gdump_retire_local` buffers before handing them off to
+     * the shared pending list.
+     */
+    #define VGDUMP_RETIRE_BATCH 64U
+#endif
+
+/**
+ * Callback used by recyclers to back off while waiting for readers.
+ */
+typedef int (*gdump_yield_fun_t)(void *arg);
+
+/**
+ * Per-thread gdump object
+ */
+typedef struct gdump_thread_s {
+    dbl_list_node_t lst_node; /* !!! keep as first field !!! */
+    vatomic64_t gp_local;     /* 0 when the thread is inactive */
+    vuint32_t enter_count;
+    /* locally retired nodes, not visible to recyclers yet */
+    smr_node_t *retired_head;
+    smr_node_t *retired_tail;
+    vsize_t retired_count;
+} VSYNC_CACHEALIGN gdump_thread_t;
+
+/**
+ * The global gdump object
+ */
+typedef struct gdump_s {
+    vatomic64_t gp_global;
+    smr_nodes_list_t retired_lst;
+    dbl_list_t threads;
+    smr_rwlock_lib_t lock;
+} VSYNC_CACHEALIGN gdump_t;
+
+static inline void _gdump_wait_readers(gdump_t *gdump, vuint64_t gp,
+                                       gdump_yield_fun_t yield_fun,
+                                       void *yield_fun_arg);
+static inline void _gdump_flush(gdump_t *gdump, gdump_thread_t *thrd);
+
+/**
+ * Initializes the given object `gdump`.
+ *
+ * @param gdump address of gdump_t object.
+ * @param lock_lib smr_rwlock_lib_t object.
+ */
+static inline void
+gdump_init(gdump_t *gdump, smr_rwlock_lib_t lock_lib)
+{
+    ASSERT(gdump);
+    ASSERT(smr_rwlock_lib_is_set(&lock_lib));
+    dbl_list_init(&gdump->threads);
+    smr_nodes_list_init(&gdump->retired_lst);
+    vatomic64_write(&gdump->gp_global, 1U);
+    smr_rwlock_lib_copy(&gdump->lock, &lock_lib);
+}
+/**
+ * Destroys all remaining retired nodes.
+ *
+ * @note call only after all threads deregistered.
+ * @param gdump address of gdump_t object.
+ */
+static inline void
+gdump_destroy(gdump_t *gdump)
+{
+    smr_node_t *head = NULL;
+
+    ASSERT(gdump);
+    ASSERT(dbl_list_get_length(&gdump->threads) == 0);
+    head = smr_nodes_list_get_and_empty(&gdump->retired_lst);
+    (void)smr_nodes_list_destroy(head);
+}
+/**
+ * Registers and initializes the given `thrd`.
+ *
+ * @note each thread must be associated with a unique `thrd` that lives till
+ * the thread deregisters.
+ *
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object.
+ */
+static inline void
+gdump_register(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    ASSERT(gdump);
+    ASSERT(thrd);
+    vatomic64_init(&thrd->gp_local, 0);
+    thrd->enter_count   = 0;
+    thrd->retired_head  = NULL;
+    thrd->retired_tail  = NULL;
+    thrd->retired_count = 0;
+
+    gdump->lock.write_acq(gdump->lock.arg);
+    dbl_list_add(&gdump->threads, &thrd->lst_node);
+    gdump->lock.write_rel(gdump->lock.arg);
+}
+/**
+ * Deregisters the given `thrd` and hands off its locally retired nodes.
+ *
+ * @pre `gdump_register`.
+ * @note the thread must be outside of the critical section.
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object.
+ */
+static inline void
+gdump_deregister(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    ASSERT(gdump);
+    ASSERT(thrd);
+    ASSERT(vatomic64_read_rlx(&thrd->gp_local) == 0);
+
+    _gdump_flush(gdump, thrd);
+
+    gdump->lock.write_acq(gdump->lock.arg);
+    dbl_list_rem(&gdump->threads, &thrd->lst_node);
+    gdump->lock.write_rel(gdump->lock.arg);
+}
+/**
+ * Marks the beginning of a critical section.
+ *
+ * Critical sections can be nested, only the outermost one is announced.
+ *
+ * @post `gdump_exit`
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object.
+ */
+static inline void
+gdump_enter(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    ASSERT(gdump);
+    ASSERT(thrd);
+    thrd->enter_count++;
+    if (thrd->enter_count == 1U) {
+        vatomic64_write_rlx(&thrd->gp_local,
+                            vatomic64_read_rlx(&gdump->gp_global));
+        /* the announcement must be visible before we read shared nodes */
+        vatomic_fence();
+    }
+}
+/**
+ * Marks the end of a critical section.
+ *
+ * @pre `gdump_enter`
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object.
+ */
+static inline void
+gdump_exit(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    ASSERT(thrd);
+    ASSERT(thrd->enter_count);
+    if (thrd->enter_count == 1U) {
+        vatomic64_write_rel(&thrd->gp_local, 0U);
+    }
+    thrd->enter_count--;
+    V_UNUSED(gdump);
+}
+/**
+ * Defers the destruction of `smr_node` until no reader can access it.
+ *
+ * The node is pushed to the shared pending list. Can be called by any thread,
+ * registered or not.
+ *
+ * @param gdump address of gdump_t object.
+ * @param smr_node address of smr_node_t object.
+ * @param destructor callback function used for destroying the `smr_node`.
+ * @param destructor_args extra argument passed to `destructor`.
+ */
+static inline void
+gdump_retire(gdump_t *gdump, smr_node_t *smr_node,
+             smr_node_destroy_fun destructor, void *destructor_args)
+{
+    ASSERT(gdump);
+    smr_nodes_list_add(&gdump->retired_lst, smr_node, destructor,
+                       destructor_args);
+}
+/**
+ * Defers the destruction of `smr_node` until no reader can access it.
+ *
+ * The node is buffered in `thrd` and handed off to recyclers together with
+ * `VGDUMP_RETIRE_BATCH - 1` other nodes. Use `gdump_flush` to hand off the
+ * buffered nodes earlier.
+ *
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object of the calling thread.
+ * @param smr_node address of smr_node_t object.
+ * @param destructor callback function used for destroying the `smr_node`.
+ * @param destructor_args extra argument passed to `destructor`.
+ */
+static inline void
+gdump_retire_local(gdump_t *gdump, gdump_thread_t *thrd, smr_node_t *smr_node,
+                   smr_node_destroy_fun destructor, void *destructor_args)
+{
+    ASSERT(thrd);
+    ASSERT(smr_node);
+    ASSERT(destructor);
+
+    smr_node->destroy_fun     = destructor;
+    smr_node->destroy_fun_arg = destructor_args;
+    if (thrd->retired_head) {
+        smr_node->core.next = &thrd->retired_head->core;
+    } else {
+        smr_node->core.next = NULL;
+        thrd->retired_tail  = smr_node;
+    }
+    thrd->retired_head = smr_node;
+    thrd->retired_count++;
+
+    if (thrd->retired_count >= VGDUMP_RETIRE_BATCH) {
+        _gdump_flush(gdump, thrd);
+    }
+}
+/**
+ * Hands off the nodes buffered by `gdump_retire_local` to recyclers.
+ *
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object of the calling thread.
+ */
+static inline void
+gdump_flush(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    ASSERT(gdump);
+    ASSERT(thrd);
+    _gdump_flush(gdump, thrd);
+}
+/**
+ * Waits until all readers that might hold references to nodes detached
+ * before this call have left their critical section.
+ *
+ * @note must be called outside of the critical section.
+ * @param gdump address of gdump_t object.
+ * @param yield_fun callback called while waiting for readers, can be `NULL`.
+ * @param yield_fun_arg argument passed to `yield_fun`.
+ */
+static inline void
+gdump_sync(gdump_t *gdump, gdump_yield_fun_t yield_fun, void *yield_fun_arg)
+{
+    vuint64_t gp = 0;
+
+    ASSERT(gdump);
+    vatomic_fence();
+    gp = vatomic64_get_inc(&gdump->gp_global) + 1U;
+    _gdump_wait_readers(gdump, gp, yield_fun, yield_fun_arg);
+}
+/**
+ * Recycles/frees the retired nodes that can safely be freed.
+ *
+ * Grabs the pending list, waits for a grace period and destroys the grabbed
+ * nodes.
+ *
+ * @note It is recommended to call this function periodically in a dedicated
+ * thread. It blocks until the readers that are in their critical section
+ * leave it, and it must not be called inside the critical section.
+ * @param gdump address of gdump_t object.
+ * @param yield_fun callback called while waiting for readers, can be `NULL`.
+ * @param yield_fun_arg argument passed to `yield_fun`.
+ * @param threshold the minimum number of pending nodes to start recycling.
+ * @return vsize_t count of recycled nodes.
+ */
+static inline vsize_t
+gdump_recycle(gdump_t *gdump, gdump_yield_fun_t yield_fun,
+              void *yield_fun_arg, vsize_t threshold)
+{
+    smr_node_t *head = NULL;
+
+    ASSERT(gdump);
+    if (smr_nodes_list_is_empty(&gdump->retired_lst) ||
+        smr_nodes_list_get_length(&gdump->retired_lst) < threshold) {
+        return 0;
+    }
+    head = smr_nodes_list_get_and_empty(&gdump->retired_lst);
+    if (head == NULL) {
+        /* another recycler grabbed the list */
+        return 0;
+    }
+    gdump_sync(gdump, yield_fun, yield_fun_arg);
+    return smr_nodes_list_destroy(head);
+}
+/**
+ * Returns the number of nodes waiting to be recycled.
+ *
+ * @note nodes buffered by `gdump_retire_local` are not counted.
+ * @param gdump address of gdump_t object.
+ * @return vuint64_t approximate count of pending nodes.
+ */
+static inline vuint64_t
+gdump_get_pending_count(gdump_t *gdump)
+{
+    ASSERT(gdump);
+    return smr_nodes_list_get_length(&gdump->retired_lst);
+}
+/**
+ * Waits until every registered thread is inactive or observed `gp`.
+ *
+ * @param gdump address of gdump_t object.
+ * @param gp the opened grace period.
+ * @param yield_fun callback called while waiting for readers, can be `NULL`.
+ * @param yield_fun_arg argument passed to `yield_fun`.
+ */
+static inline void
+_gdump_wait_readers(gdump_t *gdump, vuint64_t gp, gdump_yield_fun_t yield_fun,
+                    void *yield_fun_arg)
+{
+    dbl_list_node_t *node = NULL;
+    gdump_thread_t *thrd  = NULL;
+    vuint64_t gp_local    = 0;
+
+    gdump->lock.read_acq(gdump->lock.arg);
+    for (node = dbl_list_get_head(&gdump->threads); node;
+         node = dbl_list_get_next(node)) {
+        thrd = (gdump_thread_t *)node;
+        while (true) {
+            gp_local = vatomic64_read(&thrd->gp_local);
+            if (gp_local == 0 || gp_local >= gp) {
+                break;
+            }
+            /* the reader entered before gp was opened */
+            verification_ignore();
+            if (yield_fun) {
+                (void)yield_fun(yield_fun_arg);
+            }
+        }
+    }
+    gdump->lock.read_rel(gdump->lock.arg);
+}
+/**
+ * Merges the locally retired nodes of `thrd` into the pending list.
+ *
+ * @param gdump address of gdump_t object.
+ * @param thrd address of gdump_thread_t object.
+ */
+static inline void
+_gdump_flush(gdump_t *gdump, gdump_thread_t *thrd)
+{
+    if (thrd->retired_count == 0) {
+        return;
+    }
+    smr_nodes_list_merge(&gdump->retired_lst, thrd->retired_head,
+                         thrd->retired_tail, thrd->retired_count);
+    thrd->retired_head  = NULL;
+    thrd->retired_tail  = NULL;
+    thrd->retired_count = 0;
+}
+
+#endif
@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VSYNC_HP_H
+#define VSYNC_HP_H
+
+/******************************************************************************
+ * @file hp.h
+ * @brief Hazard Pointers (HP) SMR scheme.
+ *
+ * Every thread owns `VHP_SLOT_COUNT` hazard slots. Before dereferencing a
+ * shared pointer, a reader publishes it in one of its slots with
+ * `vhp_protect`. A retired object is only destroyed once no slot holds its
+ * address.
+ *
+ * Unlike vsync/smr/ebr.h, a reader that stalls only prevents the reclamation
+ * of the objects it protects, not of all retired objects. A thread scans the
+ * slots of all threads every `VHP_RETIRE_THRESHOLD` retirements. A scan frees
+ * everything but the at most `H` objects found in the slots, `H` being the
+ * slot count of all threads, so a thread keeps fewer than
+ * `VHP_RETIRE_THRESHOLD + H` retired objects. Retiring never waits for
+ * readers.
+ *
+ * Retired objects embed a `vhp_node_t`, which records the address readers
+ * protect, usually the address of the object itself. Otherwise, retirement has
+ * the shape of `vebr_retire`, i.e., the embedded `smr_node_t` and a destructor
+ * callback.
+ *
+ * @note data structures must protect every pointer they dereference with
+ * `vhp_protect`. Code written against enter/exit based schemes, which protect
+ * everything inside the critical section, does not become safe by only
+ * swapping the SMR scheme.
+ *
+ * @example
+ * @include eg_vhp.c
+ *
+ * @cite
+ * Maged M. Michael - [Hazard Pointers: Safe Memory Reclamation for Lock-Free
+ * Objects](https://doi.org/10.1109/TPDS.2004.8)
+ *****************************************************************************/
+#include <vsync/atomic.h>
+#include <vsync/common/cache.h>
+#include <vsync/common/assert.h>
+#include <vsync/common/verify.h>
+#include <vsync/common/compiler.h>
+#include <vsync/smr/internal/smr_lock.h>
+#include <vsync/smr/internal/smr_node.h>
+#include <vsync/smr/internal/dbl_list.h>
+
+#if !defined(VHP_SLOT_COUNT)
+    /**
+     * Number of hazard slots per thread.
+     */
+    #define VHP_SLOT_COUNT 4U
+#endif
+
+#if defined(VSYNC_VERIFICATION)
+    #undef VHP_RETIRE_THRESHOLD
+    #define VHP_RETIRE_THRESHOLD 2U
+#elif !defined(VHP_RETIRE_THRESHOLD)
+    /**
+     * Number of objects a thread retires between two scans, also the number
+     * of buckets of its set of retired objects. Scans are cheaper if it is
+     * larger than the number of slots of all threads.
+     */
+    #define VHP_RETIRE_THRESHOLD 256U
+#endif
+
+/**
+ * Node embedded in objects retired with `vhp_retire`.
+ */
+typedef struct vhp_node_s {
+    smr_node_t smr_node; /* keep as first field */
+    void *ptr;           /* the protected address */
+} vhp_node_t;
+
+/**
+ * Per-thread HP object
+ */
+typedef struct vhp_thread_s {
+    dbl_list_node_t lst_node; /* !!! keep as first field !!! */
+    vatomicptr(void *) slots[VHP_SLOT_COUNT];
+    /* only accessed by the owner thread */
+    smr_node_core_t *retired[VHP_RETIRE_THRESHOLD]; /* hashed by address */
+    vsize_t retired_count;
+    vsize_t scan_at; /* retired_count that triggers the next scan */
+} VSYNC_CACHEALIGN vhp_thread_t;
+
+/**
+ * The global HP object
+ */
+typedef struct vhp_s {
+    dbl_list_t threads;
+    smr_lock_lib_t lock;
+} VSYNC_CACHEALIGN vhp_t;
+
+static inline void _vhp_retired_add(vhp_thread_t *thrd, vhp_node_t *node);
+static inline smr_node_core_t *_vhp_retired_take_protected(vhp_t *hp,
+                                                           vhp_thread_t *thrd);
+
+/**
+ * Initializes the given object `hp`.
+ *
+ * @param hp address of vhp_t object.
+ * @param lock_lib smr_lock_lib_t object, protects the list of threads.
+ */
+static inline void
+vhp_init(vhp_t *hp, smr_lock_lib_t lock_lib)
+{
+    ASSERT(hp);
+    ASSERT(smr_lock_lib_is_set(&lock_lib));
+    dbl_list_init(&hp->threads);
+#if defined(VSYNC_VERIFICATION)
+    hp->lock.arg = lock_lib.arg;
+    hp->lock.acq = lock_lib.acq;
+    hp->lock.rel = lock_lib.rel;
+#else
+    hp->lock = lock_lib;
+#endif
+}
+/**
+ * Destroys the given `hp` object.
+ *
+ * @note call only after all threads deregistered.
+ * @param hp address of vhp_t object.
+ */
+static inline void
+vhp_destroy(vhp_t *hp)
+{
+    ASSERT(hp);
+    ASSERT(dbl_list_get_length(&hp->threads) == 0);
+    V_UNUSED(hp);
+}
+/**
+ * Registers and initializes the given `thrd`.
+ *
+ * @note each thread must be associated with a unique `thrd` that lives till
+ * the thread deregisters.
+ *
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object.
+ */
+static inline void
+vhp_register(vhp_t *hp, vhp_thread_t *thrd)
+{
+    ASSERT(hp);
+    ASSERT(thrd);
+    for (vsize_t i = 0; i < VHP_SLOT_COUNT; i++) {
+        vatomicptr_init(&thrd->slots[i], NULL);
+    }
+    for (vsize_t i = 0; i < VHP_RETIRE_THRESHOLD; i++) {
+        thrd->retired[i] = NULL;
+    }
+    thrd->retired_count = 0;
+    thrd->scan_at       = VHP_RETIRE_THRESHOLD;
+
+    hp->lock.acq(hp->lock.arg);
+    dbl_list_add(&hp->threads, &thrd->lst_node);
+    hp->lock.rel(hp->lock.arg);
+}
+/**
+ * Publishes the pointer stored in `src` in the given slot.
+ *
+ * Re-reads `src` until the published pointer is still stored in it, i.e., it
+ * was not retired before it got protected.
+ *
+ * @param thrd address of vhp_thread_t object of the calling thread.
+ * @param slot index of the slot, `< VHP_SLOT_COUNT`.
+ * @param src address of the shared pointer.
+ * @return void* the protected pointer, can be `NULL`.
+ */
+static inline void *
+vhp_protect(vhp_thread_t *thrd, vsize_t slot, vatomicptr_t *src)
+{
+    void *ptr = NULL;
+    void *cur = NULL;
+
+    ASSERT(thrd);
+    ASSERT(slot < VHP_SLOT_COUNT);
+    cur = vatomicptr_read(src);
+    do {
+        ptr = cur;
+        /* seq_cst: the slot must be visible before we validate */
+        vatomicptr_write(&thrd->slots[slot], ptr);
+        cur = vatomicptr_read(src);
+    } while (cur != ptr);
+    return ptr;
+}
+/**
+ * Publishes the given pointer in the given slot.
+ *
+ * @note the caller is responsible for validating that `ptr` was still
+ * reachable after this call returns, e.g., by re-reading its source.
+ * @param thrd address of vhp_thread_t object of the calling thread.
+ * @param slot index of the slot, `< VHP_SLOT_COUNT`.
+ * @param ptr the pointer to protect.
+ */
+static inline void
+vhp_set(vhp_thread_t *thrd, vsize_t slot, void *ptr)
+{
+    ASSERT(thrd);
+    ASSERT(slot < VHP_SLOT_COUNT);
+    vatomicptr_write(&thrd->slots[slot], ptr);
+}
+/**
+ * Clears the given slot.
+ *
+ * @param thrd address of vhp_thread_t object of the calling thread.
+ * @param slot index of the slot, `< VHP_SLOT_COUNT`.
+ */
+static inline void
+vhp_clear(vhp_thread_t *thrd, vsize_t slot)
+{
+    ASSERT(thrd);
+    ASSERT(slot < VHP_SLOT_COUNT);
+    vatomicptr_write_rel(&thrd->slots[slot], NULL);
+}
+/**
+ * Marks the beginning of an operation.
+ *
+ * Does nothing, available for symmetry with the other SMR schemes.
+ *
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object.
+ */
+static inline void
+vhp_enter(vhp_t *hp, vhp_thread_t *thrd)
+{
+    V_UNUSED(hp, thrd);
+}
+/**
+ * Marks the end of an operation, clears all slots of the calling thread.
+ *
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object.
+ */
+static inline void
+vhp_exit(vhp_t *hp, vhp_thread_t *thrd)
+{
+    ASSERT(thrd);
+    for (vsize_t i = 0; i < VHP_SLOT_COUNT; i++) {
+        vatomicptr_write_rel(&thrd->slots[i], NULL);
+    }
+    V_UNUSED(hp);
+}
+/**
+ * Frees the objects retired by `thrd` that no thread protects.
+ *
+ * The slots of all threads are read once, under the lock, and the objects
+ * they protect are set aside. The others are destroyed after the lock is
+ * released.
+ *
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object of the calling thread.
+ * @return vsize_t count of recycled objects.
+ */
+static inline vsize_t
+vhp_recycle(vhp_t *hp, vhp_thread_t *thrd)
+{
+    vsize_t count            = 0;
+    smr_node_core_t *kept    = NULL;
+    smr_node_core_t *garbage = NULL;
+    smr_node_core_t *core    = NULL;
+    smr_node_core_t *next    = NULL;
+    smr_node_t *node         = NULL;
+
+    ASSERT(hp);
+    ASSERT(thrd);
+    /* the objects were detached before, the slots must be read after */
+    vatomic_fence();
+
+    hp->lock.acq(hp->lock.arg);
+    kept = _vhp_retired_take_protected(hp, thrd);
+    hp->lock.rel(hp->lock.arg);
+
+    /* empty the set before destroying, destructors may retire again */
+    for (vsize_t i = 0; i < VHP_RETIRE_THRESHOLD; i++) {
+        for (core = thrd->retired[i]; core; core = next) {
+            next       = core->next;
+            core->next = garbage;
+            garbage    = core;
+        }
+        thrd->retired[i] = NULL;
+    }
+    thrd->retired_count = 0;
+    for (core = kept; core; core = next) {
+        next = core->next;
+        _vhp_retired_add(thrd, (vhp_node_t *)core);
+    }
+    thrd->scan_at = thrd->retired_count + VHP_RETIRE_THRESHOLD;
+
+    for (core = garbage; core; core = next) {
+        next = core->next;
+        node = (smr_node_t *)core;
+        node->destroy_fun(node, node->destroy_fun_arg);
+        count++;
+    }
+    return count;
+}
+/**
+ * Defers the destruction of the object until no thread protects it.
+ *
+ * Every `VHP_RETIRE_THRESHOLD` retirements, the thread scans the slots of all
+ * threads and frees its unprotected objects, see `vhp_recycle`. Objects that
+ * are still protected are kept for the next scan, the call does not wait for
+ * them.
+ *
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object of the calling thread.
+ * @param ptr the address readers protect, usually the object embedding
+ * `node`.
+ * @param node address of vhp_node_t object.
+ * @param destructor callback function used for destroying `node->smr_node`.
+ * @param destructor_args extra argument passed to `destructor`.
+ */
+static inline void
+vhp_retire(vhp_t *hp, vhp_thread_t *thrd, void *ptr, vhp_node_t *node,
+           smr_node_destroy_fun destructor, void *destructor_args)
+{
+    ASSERT(thrd);
+    ASSERT(node);
+    ASSERT(destructor);
+    node->smr_node.destroy_fun     = destructor;
+    node->smr_node.destroy_fun_arg = destructor_args;
+    node->ptr                      = ptr;
+    _vhp_retired_add(thrd, node);
+
+    if (thrd->retired_count >= thrd->scan_at) {
+        (void)vhp_recycle(hp, thrd);
+    }
+}
+/**
+ * Deregisters the given `thrd`.
+ *
+ * Frees the objects retired by the thread, blocks while any of them is
+ * protected by another thread.
+ *
+ * @pre `vhp_register`.
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object.
+ */
+static inline void
+vhp_deregister(vhp_t *hp, vhp_thread_t *thrd)
+{
+    ASSERT(hp);
+    ASSERT(thrd);
+    vhp_exit(hp, thrd);
+    while (thrd->retired_count > 0) {
+        if (vhp_recycle(hp, thrd) == 0) {
+            verification_ignore();
+        }
+    }
+    hp->lock.acq(hp->lock.arg);
+    dbl_list_rem(&hp->threads, &thrd->lst_node);
+    hp->lock.rel(hp->lock.arg);
+}
+/**
+ * Adds `node` to the set of retired objects of `thrd`.
+ *
+ * @param thrd address of vhp_thread_t object.
+ * @param node address of vhp_node_t object.
+ */
+static inline void
+_vhp_retired_add(vhp_thread_t *thrd, vhp_node_t *node)
+{
+    vsize_t idx =
+        (vsize_t)(((vuintptr_t)node->ptr >> 4U) % VHP_RETIRE_THRESHOLD);
+
+    node->smr_node.core.next = thrd->retired[idx];
+    thrd->retired[idx]       = &node->smr_node.core;
+    thrd->retired_count++;
+}
+/**
+ * Removes the objects protected by any slot of any registered thread from the
+ * set of retired objects of `thrd`.
+ *
+ * @note must be called under lock protection.
+ * @param hp address of vhp_t object.
+ * @param thrd address of vhp_thread_t object.
+ * @return smr_node_core_t* list of the removed objects.
+ */
+static inline smr_node_core_t *
+_vhp_retired_take_protected(vhp_t *hp, vhp_thread_t *thrd)
+{
+    dbl_list_node_t *lst_node = NULL;
+    vhp_thread_t *other       = NULL;
+    smr_node_core_t *kept     = NULL;
+    smr_node_core_t **link    = NULL;
+    smr_node_core_t *core     = NULL;
+    void *ptr                 = NULL;
+
+    for (lst_node = dbl_list_get_head(&hp->threads); lst_node;
+         lst_node = dbl_list_get_next(lst_node)) {
+        other = (vhp_thread_t *)lst_node;
+        for (vsize_t i = 0; i < VHP_SLOT_COUNT; i++) {
+            ptr = vatomicptr_read(&other->slots[i]);
+            if (ptr == NULL) {
+                continue;
+            }
+            link = &thrd->retired[(vsize_t)(((vuintptr_t)ptr >> 4U) %
+                                            VHP_RETIRE_THRESHOLD)];
+            while ((core = *link) != NULL) {
+                if (((vhp_node_t *)core)->ptr != ptr) {
+                    link = &core->next;
+                    continue;
+                }
+                *link      = core->next;
+                core->next = kept;
+                kept       = core;
+                thrd->retired_count--;
+            }
+        }
+    }
+    return kept;
+}
+
+#endif
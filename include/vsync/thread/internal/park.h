@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VTHREAD_PARK_H
+#define VTHREAD_PARK_H
+/*******************************************************************************
+ * Spin-then-park waiting
+ *
+ * A waiter re-checks its condition `VPARK_MAX_SPIN` times, then parks on a
+ * futex. Waiters register themselves before their last check, so that
+ * `vpark_notify` only issues the wake syscall when a waiter is registered.
+ *
+ * Usage:
+ *
+ * ```c
+ * vpark_await_while(&park, !done)
+ *     done = try_something();
+ * ```
+ *
+ * and `vpark_notify(&park)` after every change that might affect the outcome
+ * of `try_something`.
+ *
+ * @note on linux compile with `-D_GNU_SOURCE`.
+ ******************************************************************************/
+#include <vsync/atomic.h>
+#include <vsync/thread/internal/futex.h>
+
+/**
+ * @def VPARK_MAX_SPIN
+ * @brief times of spinning before parking.
+ *
+ * default value is 1000, compile with -DVPARK_MAX_SPIN=N to
+ * overwrite the default.
+ *
+ * @note spinning is deactivated on verification.
+ */
+#if defined(VSYNC_VERIFICATION)
+    #undef VPARK_MAX_SPIN
+    #define VPARK_MAX_SPIN 0U
+#elif !defined(VPARK_MAX_SPIN)
+    #define VPARK_MAX_SPIN 1000U
+#endif
+
+typedef struct vpark_s {
+    vatomic32_t seq; /* futex word, bumped when waiters are notified */
+    vatomic32_t waiters;
+} vpark_t;
+
+typedef struct vpark_waiter_s {
+    vuint32_t spins;
+    vuint32_t ticket;
+    vbool_t registered;
+} vpark_waiter_t;
+
+/**
+ * Loops over the next statement while `cond` holds, parking when spinning
+ * did not help.
+ *
+ * @param p address of vpark_t object.
+ * @param cond condition, re-evaluated after every execution of the statement.
+ */
+#define vpark_await_while(p, cond)                                             \
+    for (vpark_waiter_t _vpark_w = {0U, 0U, false};                            \
+         vpark_await_next((p), &_vpark_w, (cond));)
+
+/**
+ * Initializes the given park object.
+ *
+ * @param p address of vpark_t object.
+ */
+static inline void
+vpark_init(vpark_t *p)
+{
+    vatomic32_init(&p->seq, 0U);
+    vatomic32_init(&p->waiters, 0U);
+}
+/**
+ * Decides the next step of a waiter, use `vpark_await_while` instead.
+ *
+ * @param p address of vpark_t object.
+ * @param w address of the vpark_waiter_t object of the waiter.
+ * @param cond current value of the waiting condition.
+ * @return true the caller has to check its condition again.
+ * @return false the condition does not hold anymore.
+ */
+static inline vbool_t
+vpark_await_next(vpark_t *p, vpark_waiter_t *w, vbool_t cond)
+{
+    if (!cond) {
+        if (w->registered) {
+            vatomic32_dec_rlx(&p->waiters);
+        }
+        return false;
+    }
+    if (w->spins < VPARK_MAX_SPIN) {
+        w->spins++;
+        vatomic_cpu_pause();
+        return true;
+    }
+    if (!w->registered) {
+        vatomic32_inc_rlx(&p->waiters);
+        /* pairs with the fence in vpark_notify: the notifier either sees us
+         * registered or we see its change in the last check */
+        vatomic_fence();
+        w->ticket     = vatomic32_read_acq(&p->seq);
+        w->registered = true;
+        return true;
+    }
+    /* returns immediately if a notification came after the ticket */
+    vfutex_wait(&p->seq, w->ticket);
+    vatomic32_dec_rlx(&p->waiters);
+    w->registered = false;
+    return true;
+}
+/**
+ * Wakes up all parked waiters, if any.
+ *
+ * Call after every change waiters might wait for.
+ *
+ * @param p address of vpark_t object.
+ */
+static inline void
+vpark_notify(vpark_t *p)
+{
+    /* order the change before reading the waiters */
+    vatomic_fence();
+    if (vatomic32_read_rlx(&p->waiters) == 0U) {
+        return;
+    }
+    vatomic32_inc(&p->seq);
+    vfutex_wake(&p->seq, FUTEX_WAKE_ALL);
+}
+#endif /* VTHREAD_PARK_H */
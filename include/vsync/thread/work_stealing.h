@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VTHREAD_WORK_STEALING_H
+#define VTHREAD_WORK_STEALING_H
+/*******************************************************************************
+ * @file work_stealing.h
+ * @brief Work-stealing fork/join scheduler.
+ *
+ * Every worker owns a growable Chase-Lev deque (vsync/queue/chaselev.h).
+ * `vws_spawn` pushes a task onto the deque of the calling worker and
+ * `vws_sync` runs tasks until all children of a task completed. A worker that
+ * runs out of tasks steals from the other workers, starting at a victim chosen
+ * with the given `backoff_rand_fun_t`. A thief takes up to half of the tasks
+ * of its victim, at most `VWS_STEAL_BATCH`, with `vdeque_steal_many`, runs
+ * the oldest and pushes the others onto its own deque. When all deques are
+ * empty, idle workers spin for a while and then park on a futex. Spawning a
+ * task and completing the last child of a task wake them up.
+ *
+ * The scheduler does not create threads. Every worker but one is driven by a
+ * thread calling `vws_worker_run` until `vws_stop` is called. The remaining
+ * worker belongs to the thread that spawns the root tasks and syncs on them.
+ *
+ * Tasks are provided by the caller, usually embedded in a user struct, and
+ * must stay valid until they completed, e.g., on the stack of the parent that
+ * syncs on them.
+ *
+ * @note on linux compile with `-D_GNU_SOURCE`.
+ *
+ * @example
+ * @include eg_work_stealing.c
+ *
+ * @cite
+ * Robert D. Blumofe, Charles E. Leiserson - [Scheduling Multithreaded
+ * Computations by Work Stealing](https://doi.org/10.1145/324133.324234)
+ ******************************************************************************/
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/common/cache.h>
+#include <vsync/queue/chaselev.h>
+#include <vsync/thread/internal/park.h>
+#include <vsync/utils/alloc.h>
+#include <vsync/utils/backoff.h>
+
+/**
+ * @def VWS_DEQUE_INIT_SIZE
+ * @brief initial capacity of the worker deques, they grow on demand.
+ */
+#if !defined(VWS_DEQUE_INIT_SIZE)
+    #define VWS_DEQUE_INIT_SIZE 64U
+#endif
+
+/**
+ * @def VWS_STEAL_BATCH
+ * @brief maximum number of tasks a thief takes from its victim at once.
+ */
+#if !defined(VWS_STEAL_BATCH)
+    #define VWS_STEAL_BATCH 8U
+#endif
+
+typedef struct vws_sched_s vws_sched_t;
+typedef struct vws_worker_s vws_worker_t;
+typedef struct vws_task_s vws_task_t;
+
+/**
+ * Task function.
+ *
+ * @param w address of the vws_worker_t object running the task.
+ * @param task address of the vws_task_t object.
+ */
+typedef void (*vws_task_fun_t)(vws_worker_t *w, vws_task_t *task);
+
+struct vws_task_s {
+    vws_task_fun_t fun;
+    vws_task_t *parent;
+    vatomic32_t pending; /* children that did not complete yet */
+};
+
+struct vws_worker_s {
+    vdeque_t deque;
+    vws_sched_t *sched;
+    vuint32_t idx;
+} VSYNC_CACHEALIGN;
+
+struct vws_sched_s {
+    vws_worker_t *workers;
+    vuint32_t count;
+    backoff_rand_fun_t rand_fun;
+    vatomic32_t stop;
+    vpark_t park VSYNC_CACHEALIGN;
+};
+
+static inline void _vws_exec(vws_worker_t *w, vws_task_t *task);
+static inline vws_task_t *_vws_take(vws_worker_t *w);
+
+/**
+ * Initializes the scheduler.
+ *
+ * @param s address of vws_sched_t object.
+ * @param workers array of `count` vws_worker_t objects.
+ * @param count number of workers.
+ * @param rand_fun function pointer to a function that generates a random
+ * number, used to pick victims.
+ * @param mem_lib object of type `vmem_lib_t` used to allocate the deques.
+ */
+static inline void
+vws_init(vws_sched_t *s, vws_worker_t *workers, vuint32_t count,
+         backoff_rand_fun_t rand_fun, vmem_lib_t mem_lib)
+{
+    ASSERT(s);
+    ASSERT(workers);
+    ASSERT(count != 0);
+    ASSERT(rand_fun);
+
+    s->workers  = workers;
+    s->count    = count;
+    s->rand_fun = rand_fun;
+    vatomic32_init(&s->stop, 0U);
+    vpark_init(&s->park);
+    for (vuint32_t i = 0; i < count; i++) {
+        workers[i].sched = s;
+        workers[i].idx   = i;
+        vdeque_init_growable(&workers[i].deque, VWS_DEQUE_INIT_SIZE, mem_lib,
+                             NULL, NULL);
+    }
+}
+/**
+ * Destroys the scheduler, frees the deques.
+ *
+ * @param s address of vws_sched_t object.
+ *
+ * @note call only after all threads returned from `vws_worker_run`.
+ */
+static inline void
+vws_destroy(vws_sched_t *s)
+{
+    ASSERT(s);
+    for (vuint32_t i = 0; i < s->count; i++) {
+        vdeque_destroy(&s->workers[i].deque);
+    }
+}
+/**
+ * Returns the worker with the given index.
+ *
+ * @param s address of vws_sched_t object.
+ * @param idx index of the worker, `< count`.
+ * @return address of the vws_worker_t object.
+ */
+static inline vws_worker_t *
+vws_worker(vws_sched_t *s, vuint32_t idx)
+{
+    ASSERT(s);
+    ASSERT(idx < s->count);
+    return &s->workers[idx];
+}
+/**
+ * Initializes a root task, i.e., a task that is only used to sync on.
+ *
+ * @param task address of vws_task_t object.
+ */
+static inline void
+vws_task_init(vws_task_t *task)
+{
+    ASSERT(task);
+    task->fun    = NULL;
+    task->parent = NULL;
+    vatomic32_init(&task->pending, 0U);
+}
+/**
+ * Spawns `task` as child of `parent`.
+ *
+ * The task is pushed onto the deque of `w`, from where `w` or a thief runs
+ * it. If the deque cannot grow, the task is run immediately.
+ *
+ * @param w address of the vws_worker_t object of the calling thread.
+ * @param parent address of the vws_task_t object syncing on `task`, can be
+ * NULL.
+ * @param task address of vws_task_t object, valid until it completed.
+ * @param fun task function.
+ */
+static inline void
+vws_spawn(vws_worker_t *w, vws_task_t *parent, vws_task_t *task,
+          vws_task_fun_t fun)
+{
+    ASSERT(w);
+    ASSERT(task);
+    ASSERT(fun);
+
+    task->fun    = fun;
+    task->parent = parent;
+    vatomic32_init(&task->pending, 0U);
+    if (parent != NULL) {
+        /* only the worker running the parent spawns its children */
+        vatomic32_inc_rlx(&parent->pending);
+    }
+    if (vdeque_push_bottom(&w->deque, task) != VDEQUE_STATE_OK) {
+        _vws_exec(w, task);
+        return;
+    }
+    vpark_notify(&w->sched->park);
+}
+/**
+ * Waits until all children of `task` completed.
+ *
+ * While waiting, the calling worker runs its own tasks and steals tasks of
+ * others.
+ *
+ * @param w address of the vws_worker_t object of the calling thread.
+ * @param task address of vws_task_t object.
+ */
+static inline void
+vws_sync(vws_worker_t *w, vws_task_t *task)
+{
+    vws_task_t *t = NULL;
+
+    ASSERT(w);
+    ASSERT(task);
+    while (true) {
+        t = NULL;
+        vpark_await_while(&w->sched->park,
+                          vatomic32_read_acq(&task->pending) != 0U &&
+                              (t = _vws_take(w)) == NULL) {}
+        if (t == NULL) {
+            return;
+        }
+        _vws_exec(w, t);
+    }
+}
+/**
+ * Runs tasks of the given worker and steals from others until `vws_stop`.
+ *
+ * @param s address of vws_sched_t object.
+ * @param idx index of the worker driven by the calling thread.
+ */
+static inline void
+vws_worker_run(vws_sched_t *s, vuint32_t idx)
+{
+    vws_worker_t *w = vws_worker(s, idx);
+    vws_task_t *t   = NULL;
+
+    while (true) {
+        t = NULL;
+        vpark_await_while(&s->park, vatomic32_read_acq(&s->stop) == 0U &&
+                                        (t = _vws_take(w)) == NULL) {}
+        if (t == NULL) {
+            return;
+        }
+        _vws_exec(w, t);
+    }
+}
+/**
+ * Makes all threads in `vws_worker_run` return once they are idle.
+ *
+ * @param s address of vws_sched_t object.
+ */
+static inline void
+vws_stop(vws_sched_t *s)
+{
+    ASSERT(s);
+    vatomic32_write_rel(&s->stop, 1U);
+    vpark_notify(&s->park);
+}
+/* runs the task and signals its completion to the parent */
+static inline void
+_vws_exec(vws_worker_t *w, vws_task_t *task)
+{
+    vws_task_t *parent = task->parent;
+
+    task->fun(w, task);
+    /* release: the parent sees the effects of the task after its sync */
+    if (parent != NULL && vatomic32_get_dec_rel(&parent->pending) == 1U) {
+        vpark_notify(&w->sched->park);
+    }
+}
+/* pops a task of `w` or steals one, NULL if all deques are empty */
+static inline vws_task_t *
+_vws_take(vws_worker_t *w)
+{
+    vws_sched_t *s       = w->sched;
+    void *t              = NULL;
+    vsize_t n            = 0;
+    vuint32_t start      = 0;
+    vuint32_t v          = 0;
+    vdeque_state_t state = VDEQUE_STATE_EMPTY;
+    void *batch[VWS_STEAL_BATCH];
+
+    state = vdeque_pop_bottom(&w->deque, &t);
+    if (state == VDEQUE_STATE_OK) {
+        return (vws_task_t *)t;
+    }
+    /* visit every victim once, so that nobody parks while there is work */
+    start = s->rand_fun(0, s->count - 1U);
+    for (vuint32_t i = 0; i < s->count; i++) {
+        v = (start + i) % s->count;
+        if (v == w->idx) {
+            continue;
+        }
+        do {
+            state = vdeque_steal_many(&s->workers[v].deque, batch,
+                                      VWS_STEAL_BATCH, &n);
+        } while (state == VDEQUE_STATE_ABORT);
+        if (state != VDEQUE_STATE_OK) {
+            continue;
+        }
+        /* keep the oldest, the others become ours */
+        for (vsize_t j = 1; j < n; j++) {
+            if (vdeque_push_bottom(&w->deque, batch[j]) != VDEQUE_STATE_OK) {
+                _vws_exec(w, (vws_task_t *)batch[j]);
+            }
+        }
+        if (n > 1U) {
+            vpark_notify(&s->park);
+        }
+        return (vws_task_t *)batch[0];
+    }
+    return NULL;
+}
+#endif /* VTHREAD_WORK_STEALING_H */
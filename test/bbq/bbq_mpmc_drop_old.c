@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM        200000UL
+#define NUM_WRITER 3
+#define NUM_READER 2
+
+#define BUFFER_ENTRY_NUM 256
+#define ENQUEUE_BATCH    5UL
+#define DEQUEUE_BATCH    4UL
+#define YIELD_PERIOD     1000UL
+
+#include <vsync/queue/bbq_mpmc.h>
+
+bbq_mpmc_t *rb;
+vatomic32_t g_done;
+vatomic64_t g_received;
+
+void *
+writer(void *arg)
+{
+    vuint64_t id                  = (vuint64_t)(vuintptr_t)arg;
+    vuintptr_t buf[ENQUEUE_BATCH] = {0};
+    vuint64_t ptr                 = 0;
+    vuint64_t rest                = NUM;
+    while (rest) {
+        vuint32_t count = VMIN(rest, ENQUEUE_BATCH);
+        for (vuint32_t i = 0; i < count; i++) {
+            buf[i] = (id << 32) | (ptr + i);
+        }
+        /* never blocks on consumers */
+        count = bbq_mpmc_enqueue(rb, buf, count, true);
+        ptr += count;
+        rest -= count;
+        if (ptr % YIELD_PERIOD == 0) {
+            /* let the consumers catch up from time to time */
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuintptr_t buf[DEQUEUE_BATCH] = {0};
+    vuint64_t next[NUM_WRITER]    = {0};
+    vuint64_t received            = 0;
+    while (true) {
+        vuint32_t done  = vatomic32_read(&g_done);
+        vuint32_t count = bbq_mpmc_dequeue(rb, buf, DEQUEUE_BATCH, false);
+        if (count == 0 && done) {
+            break;
+        }
+        for (vuint32_t i = 0; i < count; i++) {
+            vuint64_t id  = buf[i] >> 32;
+            vuint64_t seq = buf[i] & ((1ULL << 32) - 1);
+            ASSERT(id < NUM_WRITER);
+            /* entries can be lost, but never reordered */
+            ASSERT(next[id] <= seq);
+            next[id] = seq + 1;
+        }
+        received += count;
+    }
+    vatomic64_add(&g_received, received);
+    return NULL;
+}
+
+/* fills the queue several times without consumers */
+void
+test_overwrite(void)
+{
+    vuintptr_t v    = 0;
+    vuint64_t total = 8 * BUFFER_ENTRY_NUM;
+    vuint64_t last  = 0;
+    vuint64_t count = 0;
+    vbool_t success = bbq_mpmc_init_mode(rb, bbq_mpmc_memsize(BUFFER_ENTRY_NUM),
+                                         BBQ_MODE_DROP_OLD);
+    ASSERT(success);
+
+    for (v = 1; v <= total; v++) {
+        ASSERT(bbq_mpmc_enqueue(rb, &v, 1, false) == 1);
+    }
+    ASSERT(bbq_mpmc_dropped_count(rb) > 0);
+    while (bbq_mpmc_dequeue(rb, &v, 1, false) == 1) {
+        /* only the newest entries survive, in order */
+        ASSERT(last == 0 || v == last + 1);
+        last = v;
+        count++;
+    }
+    ASSERT(last == total);
+    ASSERT(count + bbq_mpmc_dropped_count(rb) == total);
+    V_UNUSED(success);
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_mpmc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_mpmc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    test_overwrite();
+
+    vbool_t success = bbq_mpmc_init_mode(rb, sz, BBQ_MODE_DROP_OLD);
+    ASSERT(success);
+    V_UNUSED(success);
+
+    pthread_t t1[NUM_WRITER], t2[NUM_READER];
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_create(&t1[i], NULL, writer, (void *)i);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_create(&t2[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_join(t1[i], NULL);
+    }
+    vatomic32_write(&g_done, 1);
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_join(t2[i], NULL);
+    }
+
+    /* every entry was either received or accounted as dropped */
+    printf("received %" VUINT64_FORMAT ", dropped %" VUINT64_FORMAT "\n",
+           vatomic64_read(&g_received), bbq_mpmc_dropped_count(rb));
+    ASSERT(vatomic64_read(&g_received) + bbq_mpmc_dropped_count(rb) ==
+           NUM * NUM_WRITER);
+    free(rb);
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM        20000UL
+#define NUM_WRITER 4
+#define NUM_READER 5
+
+#define BUFFER_ENTRY_NUM 4096
+#define MIN_RECORD_LEN   40U
+#define MAX_RECORD_LEN   600U
+
+#include <vsync/queue/bbq_mpmc.h>
+
+bbq_mpmc_t *rb;
+
+static inline vuint32_t
+record_len(vuint64_t seq)
+{
+    return MIN_RECORD_LEN + (vuint32_t)(seq % (MAX_RECORD_LEN - MIN_RECORD_LEN));
+}
+
+void *
+writer(void *arg)
+{
+    vuint64_t id = (vuint64_t)(vuintptr_t)arg;
+    vuint8_t buf[MAX_RECORD_LEN];
+
+    for (vuint64_t seq = 0; seq < NUM * NUM_READER; seq++) {
+        vuint64_t tag = (id << 32) | seq;
+        vuint32_t len = record_len(seq);
+        memcpy(buf, &tag, sizeof(tag));
+        for (vuint32_t i = sizeof(tag); i < len; i++) {
+            buf[i] = (vuint8_t)(seq + i);
+        }
+        vbool_t success = bbq_mpmc_enqueue_record(rb, buf, len, true);
+        ASSERT(success);
+        V_UNUSED(success);
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuint8_t buf[MAX_RECORD_LEN];
+    vuint64_t next[NUM_WRITER] = {0};
+    vuint64_t rest             = NUM * NUM_WRITER;
+    vuint32_t len              = 0;
+
+    while (rest) {
+        if (!bbq_mpmc_dequeue_record(rb, buf, sizeof(buf), &len, false)) {
+            ASSERT(len <= sizeof(buf));
+            continue;
+        }
+        vuint64_t tag = 0;
+        memcpy(&tag, buf, sizeof(tag));
+        vuint64_t id  = tag >> 32;
+        vuint64_t seq = tag & ((1ULL << 32) - 1);
+        ASSERT(id < NUM_WRITER);
+        /* records of a writer are dequeued in order */
+        ASSERT(next[id] <= seq);
+        next[id] = seq + 1;
+        ASSERT(len == record_len(seq));
+        for (vuint32_t i = sizeof(tag); i < len; i++) {
+            ASSERT(buf[i] == (vuint8_t)(seq + i));
+        }
+        rest--;
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_mpmc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_mpmc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    vbool_t success = bbq_mpmc_init(rb, sz);
+    ASSERT(success);
+    ASSERT(bbq_mpmc_record_max_len(rb) >= MAX_RECORD_LEN);
+    ASSERT(!bbq_mpmc_enqueue_record(rb, NULL, bbq_mpmc_record_max_len(rb) + 1,
+                                    false));
+
+    pthread_t t1[NUM_WRITER], t2[NUM_READER];
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_create(&t1[i], NULL, writer, (void *)i);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_create(&t2[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_join(t1[i], NULL);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_join(t2[i], NULL);
+    }
+
+    vuint32_t len = 0;
+    ASSERT(!bbq_mpmc_dequeue_record(rb, NULL, 0, &len, false));
+    ASSERT(len == 0);
+    free(rb);
+    return 0;
+}
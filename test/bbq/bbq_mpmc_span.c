@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM        100000UL
+#define NUM_WRITER 3
+#define NUM_READER 2
+#define BATCH      7U
+
+#define BUFFER_ENTRY_NUM 1024
+#define RECORD_LEN       100U
+
+#include <vsync/queue/bbq_mpmc.h>
+
+bbq_mpmc_t *rb;
+vatomic64_t g_received;
+
+void *
+writer(void *arg)
+{
+    vuint64_t id  = (vuint64_t)(vuintptr_t)arg;
+    vuint64_t seq = 0;
+    bbq_span_t span;
+
+    while (seq < NUM) {
+        vuint32_t count =
+            bbq_mpmc_reserve(rb, (vuint32_t)VMIN(BATCH, NUM - seq), &span, true);
+        ASSERT(count > 0 && count <= BATCH);
+        ASSERT(span.len == count * sizeof(vuintptr_t));
+        /* build the entries directly in the ring */
+        vuintptr_t *entries = span.data;
+        for (vuint32_t i = 0; i < count; i++) {
+            entries[i] = (vuintptr_t)((id << 32) | seq++);
+        }
+        bbq_mpmc_commit(rb, &span);
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuint64_t next[NUM_WRITER] = {0};
+    bbq_span_t span;
+
+    while (vatomic64_read(&g_received) < NUM * NUM_WRITER) {
+        vuint32_t count = bbq_mpmc_peek(rb, BATCH, &span, false);
+        if (count == 0) {
+            continue;
+        }
+        /* parse the entries in place */
+        vuintptr_t *entries = span.data;
+        for (vuint32_t i = 0; i < count; i++) {
+            vuint64_t id  = (vuint64_t)entries[i] >> 32;
+            vuint64_t seq = (vuint64_t)entries[i] & ((1ULL << 32) - 1);
+            ASSERT(id < NUM_WRITER);
+            /* entries of a writer are claimed in order */
+            ASSERT(next[id] <= seq);
+            next[id] = seq + 1;
+        }
+        vbool_t intact = bbq_mpmc_release(rb, &span);
+        ASSERT(intact);
+        V_UNUSED(intact);
+        vatomic64_add(&g_received, count);
+    }
+    return NULL;
+}
+
+static void
+test_records(void)
+{
+    bbq_span_t span;
+    vuint32_t len = 0;
+    vuint8_t buf[RECORD_LEN];
+
+    /* fill the queue with records built in place */
+    vuint32_t num = 0;
+    while (bbq_mpmc_reserve_record(rb, RECORD_LEN, &span, false)) {
+        ASSERT(span.len == RECORD_LEN);
+        memset(span.data, (int)(num & 0xFF), RECORD_LEN);
+        bbq_mpmc_commit(rb, &span);
+        num++;
+    }
+    ASSERT(num > 0);
+    ASSERT(!bbq_mpmc_reserve_record(rb, bbq_mpmc_record_max_len(rb) + 1,
+                                    &span, false));
+
+    /* the copying API reads what the zero-copy API wrote */
+    ASSERT(bbq_mpmc_dequeue_record(rb, buf, sizeof(buf), &len, false));
+    ASSERT(len == RECORD_LEN && buf[0] == 0 && buf[RECORD_LEN - 1] == 0);
+    for (vuint32_t i = 1; i < num; i++) {
+        ASSERT(bbq_mpmc_peek_record(rb, &span, false));
+        ASSERT(span.len == RECORD_LEN);
+        vuint8_t *data = span.data;
+        ASSERT(data[0] == (vuint8_t)i && data[RECORD_LEN - 1] == (vuint8_t)i);
+        ASSERT(bbq_mpmc_release(rb, &span));
+    }
+    ASSERT(!bbq_mpmc_peek_record(rb, &span, false));
+
+    /* and the other way around */
+    memset(buf, 0x5A, sizeof(buf));
+    ASSERT(bbq_mpmc_enqueue_record(rb, buf, sizeof(buf), false));
+    ASSERT(bbq_mpmc_peek_record(rb, &span, false));
+    ASSERT(span.len == RECORD_LEN && memcmp(span.data, buf, RECORD_LEN) == 0);
+    ASSERT(bbq_mpmc_release(rb, &span));
+    ASSERT(!bbq_mpmc_peek_record(rb, &span, false));
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_mpmc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_mpmc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    vbool_t success = bbq_mpmc_init(rb, sz);
+    ASSERT(success);
+    V_UNUSED(success);
+
+    bbq_span_t span;
+    ASSERT(bbq_mpmc_reserve(rb, 0, &span, false) == 0);
+    ASSERT(bbq_mpmc_peek(rb, 1, &span, false) == 0);
+
+    pthread_t t1[NUM_WRITER], t2[NUM_READER];
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_create(&t1[i], NULL, writer, (void *)i);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_create(&t2[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_join(t1[i], NULL);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_join(t2[i], NULL);
+    }
+    ASSERT(vatomic64_read(&g_received) == NUM * NUM_WRITER);
+    ASSERT(bbq_mpmc_peek(rb, 1, &span, false) == 0);
+
+    /* records need a fresh queue */
+    success = bbq_mpmc_init(rb, sz);
+    ASSERT(success);
+    test_records();
+    free(rb);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM              2000000UL
+#define BUFFER_ENTRY_NUM 256
+#define ENQUEUE_BATCH    5UL
+#define DEQUEUE_BATCH    4UL
+#define YIELD_PERIOD     1000UL
+
+#include <vsync/queue/bbq_spsc.h>
+
+bbq_spsc_t *rb;
+vatomic32_t g_done;
+vuint64_t g_received;
+
+void *
+writer(void *arg)
+{
+    V_UNUSED(arg);
+    vuintptr_t buf[ENQUEUE_BATCH] = {0};
+    vuint64_t ptr                 = 0;
+    vuint64_t rest                = NUM;
+    while (rest) {
+        vuint32_t count = VMIN(rest, ENQUEUE_BATCH);
+        for (vuint32_t i = 0; i < count; i++) {
+            buf[i] = ptr++;
+        }
+        /* the producer never waits for the consumer */
+        ASSERT(bbq_spsc_enqueue(rb, buf, count, false) == count);
+        rest -= count;
+        if (ptr % YIELD_PERIOD == 0) {
+            /* let the consumer catch up from time to time */
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuintptr_t buf[DEQUEUE_BATCH] = {0};
+    vuint64_t next                = 0;
+    while (true) {
+        vuint32_t done  = vatomic32_read(&g_done);
+        vuint32_t count = bbq_spsc_dequeue(rb, buf, DEQUEUE_BATCH, false);
+        if (count == 0 && done) {
+            break;
+        }
+        for (vuint32_t i = 0; i < count; i++) {
+            /* entries can be lost, but never reordered */
+            ASSERT(next <= buf[i]);
+            next = buf[i] + 1;
+        }
+        g_received += count;
+    }
+    return NULL;
+}
+
+/* fills the queue several times without consumer */
+void
+test_overwrite(void)
+{
+    vuintptr_t v    = 0;
+    vuint64_t total = 8 * BUFFER_ENTRY_NUM;
+    vuint64_t last  = 0;
+    vuint64_t count = 0;
+    vbool_t success = bbq_spsc_init_mode(rb, bbq_spsc_memsize(BUFFER_ENTRY_NUM),
+                                         BBQ_MODE_DROP_OLD);
+    ASSERT(success);
+
+    for (v = 1; v <= total; v++) {
+        ASSERT(bbq_spsc_enqueue(rb, &v, 1, false) == 1);
+    }
+    ASSERT(bbq_spsc_dropped_count(rb) > 0);
+    while (bbq_spsc_dequeue(rb, &v, 1, false) == 1) {
+        /* only the newest entries survive, in order */
+        ASSERT(last == 0 || v == last + 1);
+        last = v;
+        count++;
+    }
+    ASSERT(last == total);
+    ASSERT(count + bbq_spsc_dropped_count(rb) == total);
+    V_UNUSED(success);
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_spsc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_spsc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    test_overwrite();
+
+    vbool_t success = bbq_spsc_init_mode(rb, sz, BBQ_MODE_DROP_OLD);
+    ASSERT(success);
+    V_UNUSED(success);
+
+    pthread_t t1, t2;
+    pthread_create(&t1, NULL, writer, NULL);
+    pthread_create(&t2, NULL, reader, NULL);
+    pthread_join(t1, NULL);
+    vatomic32_write(&g_done, 1);
+    pthread_join(t2, NULL);
+
+    /* every entry was either received or accounted as dropped */
+    printf("received %" VUINT64_FORMAT ", dropped %" VUINT64_FORMAT "\n",
+           g_received, bbq_spsc_dropped_count(rb));
+    ASSERT(g_received + bbq_spsc_dropped_count(rb) == NUM);
+    free(rb);
+    return 0;
+}
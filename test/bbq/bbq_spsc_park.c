@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define BBQ_PARK
+#define VPARK_MAX_SPIN 100U
+
+#define NUM        100000UL
+#define NUM_WRITER 1
+#define NUM_READER 1
+#define PAUSE      1000UL
+
+#define BUFFER_ENTRY_NUM 64
+
+#include <vsync/queue/bbq_spsc.h>
+
+bbq_spsc_t *rb;
+vatomic64_t g_sum;
+
+void *
+writer(void *arg)
+{
+    V_UNUSED(arg);
+    for (vuintptr_t i = 1; i <= NUM; i++) {
+        vuint32_t count = bbq_spsc_enqueue(rb, &i, 1, true);
+        ASSERT(count == 1);
+        V_UNUSED(count);
+        if (i % PAUSE == 0) {
+            /* let the readers park */
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuintptr_t val = 0;
+    for (vsize_t i = 0; i < NUM * NUM_WRITER / NUM_READER; i++) {
+        vuint32_t count = bbq_spsc_dequeue(rb, &val, 1, true);
+        ASSERT(count == 1);
+        V_UNUSED(count);
+        vatomic64_add(&g_sum, val);
+        if (i % PAUSE == 0) {
+            /* let the writers park */
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+void *
+idle_reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuintptr_t val  = 0;
+    vuint32_t count = bbq_spsc_dequeue(rb, &val, 1, true);
+    ASSERT(count == 1 && val == 42);
+    V_UNUSED(count);
+    return NULL;
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_spsc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_spsc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    vbool_t success = bbq_spsc_init(rb, sz);
+    ASSERT(success);
+    V_UNUSED(success);
+
+    /* an idle reader parks until an entry arrives */
+    pthread_t t;
+    pthread_create(&t, NULL, idle_reader, NULL);
+    while (vatomic32_read(&rb->park.waiters) == 0) {
+        usleep(1000);
+    }
+    vuintptr_t val = 42;
+    ASSERT(bbq_spsc_enqueue(rb, &val, 1, false) == 1);
+    pthread_join(t, NULL);
+    ASSERT(vatomic32_read(&rb->park.waiters) == 0);
+
+    pthread_t t1[NUM_WRITER], t2[NUM_READER];
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_create(&t1[i], NULL, writer, NULL);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_create(&t2[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < NUM_WRITER; i++) {
+        pthread_join(t1[i], NULL);
+    }
+    for (vsize_t i = 0; i < NUM_READER; i++) {
+        pthread_join(t2[i], NULL);
+    }
+
+    ASSERT(vatomic64_read(&g_sum) == NUM_WRITER * NUM * (NUM + 1) / 2);
+    ASSERT(bbq_spsc_dequeue(rb, &val, 1, false) == 0);
+    free(rb);
+    return 0;
+}
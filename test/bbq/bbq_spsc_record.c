@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM              200000UL
+#define BUFFER_ENTRY_NUM 4096
+#define MIN_RECORD_LEN   40U
+#define MAX_RECORD_LEN   600U
+
+#include <vsync/queue/bbq_spsc.h>
+
+bbq_spsc_t *rb;
+
+static inline vuint32_t
+record_len(vuint64_t seq)
+{
+    return MIN_RECORD_LEN + (vuint32_t)(seq % (MAX_RECORD_LEN - MIN_RECORD_LEN));
+}
+
+void *
+writer(void *arg)
+{
+    V_UNUSED(arg);
+    vuint8_t buf[MAX_RECORD_LEN];
+
+    for (vuint64_t seq = 0; seq < NUM; seq++) {
+        vuint32_t len = record_len(seq);
+        memcpy(buf, &seq, sizeof(seq));
+        for (vuint32_t i = sizeof(seq); i < len; i++) {
+            buf[i] = (vuint8_t)(seq + i);
+        }
+        vbool_t success = bbq_spsc_enqueue_record(rb, buf, len, true);
+        ASSERT(success);
+        V_UNUSED(success);
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuint8_t buf[MAX_RECORD_LEN];
+    vuint32_t len = 0;
+
+    for (vuint64_t seq = 0; seq < NUM; seq++) {
+        vbool_t success =
+            bbq_spsc_dequeue_record(rb, buf, sizeof(buf), &len, true);
+        ASSERT(success);
+        V_UNUSED(success);
+        vuint64_t got = 0;
+        memcpy(&got, buf, sizeof(got));
+        ASSERT(got == seq);
+        ASSERT(len == record_len(seq));
+        for (vuint32_t i = sizeof(seq); i < len; i++) {
+            ASSERT(buf[i] == (vuint8_t)(seq + i));
+        }
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_spsc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_spsc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    vbool_t success = bbq_spsc_init(rb, sz);
+    ASSERT(success);
+    ASSERT(bbq_spsc_record_max_len(rb) >= MAX_RECORD_LEN);
+
+    /* a too small buffer leaves the record in the queue */
+    vuint8_t small[8] = {0};
+    vuint8_t large[MAX_RECORD_LEN];
+    vuint32_t len = 0;
+    memset(large, 0xAB, sizeof(large));
+    ASSERT(bbq_spsc_enqueue_record(rb, large, MAX_RECORD_LEN, false));
+    ASSERT(bbq_spsc_enqueue_record(rb, NULL, 0, false));
+    ASSERT(!bbq_spsc_dequeue_record(rb, small, sizeof(small), &len, true));
+    ASSERT(len == MAX_RECORD_LEN);
+    ASSERT(bbq_spsc_dequeue_record(rb, large, sizeof(large), &len, false));
+    ASSERT(len == MAX_RECORD_LEN && large[MAX_RECORD_LEN - 1] == 0xAB);
+    ASSERT(bbq_spsc_dequeue_record(rb, small, sizeof(small), &len, false));
+    ASSERT(len == 0);
+    ASSERT(!bbq_spsc_dequeue_record(rb, small, sizeof(small), &len, false));
+    ASSERT(!bbq_spsc_enqueue_record(rb, NULL, bbq_spsc_record_max_len(rb) + 1,
+                                    false));
+
+    pthread_t t1, t2;
+    pthread_create(&t1, NULL, writer, NULL);
+    pthread_create(&t2, NULL, reader, NULL);
+
+    pthread_join(t1, NULL);
+    pthread_join(t2, NULL);
+
+    ASSERT(BBQ_SPSC_COUNT(rb) == 0);
+    free(rb);
+    return 0;
+}
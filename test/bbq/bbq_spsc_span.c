@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define NUM              1000000UL
+#define BATCH            13U
+#define BUFFER_ENTRY_NUM 1024
+#define MIN_RECORD_LEN   8U
+#define MAX_RECORD_LEN   300U
+
+#include <vsync/queue/bbq_spsc.h>
+
+bbq_spsc_t *rb;
+
+static inline vuint32_t
+record_len(vuint64_t seq)
+{
+    return MIN_RECORD_LEN + (vuint32_t)(seq % (MAX_RECORD_LEN - MIN_RECORD_LEN));
+}
+
+void *
+writer(void *arg)
+{
+    V_UNUSED(arg);
+    vuint64_t seq = 0;
+    bbq_span_t span;
+
+    while (seq < NUM) {
+        vuint32_t count =
+            bbq_spsc_reserve(rb, (vuint32_t)VMIN(BATCH, NUM - seq), &span, true);
+        ASSERT(count > 0 && count <= BATCH);
+        vuintptr_t *entries = span.data;
+        for (vuint32_t i = 0; i < count; i++) {
+            entries[i] = (vuintptr_t)seq++;
+        }
+        bbq_spsc_commit(rb, &span);
+    }
+    return NULL;
+}
+
+void *
+reader(void *arg)
+{
+    V_UNUSED(arg);
+    vuint64_t seq = 0;
+    bbq_span_t span;
+
+    while (seq < NUM) {
+        vuint32_t count = bbq_spsc_peek(rb, BATCH, &span, true);
+        ASSERT(count > 0 && count <= BATCH);
+        vuintptr_t *entries = span.data;
+        for (vuint32_t i = 0; i < count; i++) {
+            ASSERT(entries[i] == (vuintptr_t)seq);
+            seq++;
+        }
+        vbool_t intact = bbq_spsc_release(rb, &span);
+        ASSERT(intact);
+        V_UNUSED(intact);
+    }
+    return NULL;
+}
+
+void *
+record_writer(void *arg)
+{
+    V_UNUSED(arg);
+    bbq_span_t span;
+
+    for (vuint64_t seq = 0; seq < NUM / 10; seq++) {
+        vuint32_t len   = record_len(seq);
+        vbool_t success = bbq_spsc_reserve_record(rb, len, &span, true);
+        ASSERT(success && span.len == len);
+        V_UNUSED(success);
+        vuint8_t *data = span.data;
+        memcpy(data, &seq, sizeof(seq));
+        for (vuint32_t i = sizeof(seq); i < len; i++) {
+            data[i] = (vuint8_t)(seq + i);
+        }
+        bbq_spsc_commit(rb, &span);
+    }
+    return NULL;
+}
+
+void *
+record_reader(void *arg)
+{
+    V_UNUSED(arg);
+    bbq_span_t span;
+
+    for (vuint64_t seq = 0; seq < NUM / 10; seq++) {
+        vbool_t success = bbq_spsc_peek_record(rb, &span, true);
+        ASSERT(success && span.len == record_len(seq));
+        V_UNUSED(success);
+        vuint8_t *data = span.data;
+        vuint64_t got  = 0;
+        memcpy(&got, data, sizeof(got));
+        ASSERT(got == seq);
+        for (vuint32_t i = sizeof(seq); i < span.len; i++) {
+            ASSERT(data[i] == (vuint8_t)(seq + i));
+        }
+        success = bbq_spsc_release(rb, &span);
+        ASSERT(success);
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    vsize_t sz = bbq_spsc_memsize(BUFFER_ENTRY_NUM);
+    rb         = (bbq_spsc_t *)malloc(sz);
+    if (rb == NULL) {
+        perror("fail to create the ring buffer");
+        abort();
+    }
+    vbool_t success = bbq_spsc_init(rb, sz);
+    ASSERT(success);
+    V_UNUSED(success);
+
+    /* a span never crosses a block */
+    bbq_span_t span;
+    vuint32_t count = bbq_spsc_reserve(rb, BUFFER_ENTRY_NUM, &span, false);
+    ASSERT(count > 0 && count < BUFFER_ENTRY_NUM);
+    ASSERT(span.len == count * BBQ_ENTRY_SIZE);
+    bbq_spsc_commit(rb, &span);
+    ASSERT(bbq_spsc_peek(rb, BUFFER_ENTRY_NUM, &span, false) == count);
+    ASSERT(bbq_spsc_release(rb, &span));
+    ASSERT(bbq_spsc_peek(rb, 1, &span, false) == 0);
+
+    pthread_t t1, t2;
+    pthread_create(&t1, NULL, writer, NULL);
+    pthread_create(&t2, NULL, reader, NULL);
+    pthread_join(t1, NULL);
+    pthread_join(t2, NULL);
+    ASSERT(BBQ_SPSC_COUNT(rb) == 0);
+
+    /* records need a fresh queue */
+    success = bbq_spsc_init(rb, sz);
+    ASSERT(success);
+    ASSERT(bbq_spsc_record_max_len(rb) >= MAX_RECORD_LEN);
+    pthread_create(&t1, NULL, record_writer, NULL);
+    pthread_create(&t2, NULL, record_reader, NULL);
+    pthread_join(t1, NULL);
+    pthread_join(t2, NULL);
+    ASSERT(!bbq_spsc_peek_record(rb, &span, false));
+
+    free(rb);
+    return 0;
+}
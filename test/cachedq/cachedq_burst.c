@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/cachedq.h>
+
+#define NUM           20000UL
+#define WRITER_THREAD 2UL
+#define READER_THREAD 2UL
+#define BATCH         7UL
+
+cachedq_t *q;
+vatomic64_t g_sum;
+
+void *
+writer(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t buf[BATCH];
+    vuint64_t next = 1;
+
+    while (next <= NUM) {
+        vsize_t count = (vsize_t)VMIN(BATCH, NUM - next + 1);
+        for (vsize_t i = 0; i < count; i++) {
+            buf[i] = next + i;
+        }
+        next += cachedq_enqueue_burst(q, buf, count);
+    }
+    return NULL;
+}
+
+void *
+reader(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t buf[BATCH];
+
+    while (vatomic64_read(&g_sum) != 0) {
+        vsize_t count = cachedq_dequeue(q, buf, BATCH);
+        for (vsize_t i = 0; i < count; i++) {
+            vatomic64_sub(&g_sum, buf[i]);
+        }
+    }
+    return NULL;
+}
+
+/* fills and drains a queue of `capacity` entries across the wrap point */
+static void
+test_wrap(vsize_t capacity)
+{
+    vsize_t buf_size = cachedq_memsize(capacity);
+    void *mem        = malloc(buf_size);
+    cachedq_t *cq    = cachedq_init(mem, buf_size);
+    vuint64_t in[64];
+    vuint64_t out[64];
+    vuint64_t next_in  = 0;
+    vuint64_t next_out = 0;
+
+    ASSERT(cq->size == capacity);
+    ASSERT(capacity + 3 <= 64);
+    for (vsize_t round = 0; round < 5 * capacity; round++) {
+        /* all-or-nothing does not fit, burst takes what is left */
+        for (vsize_t i = 0; i < capacity + 3; i++) {
+            in[i] = next_in + i;
+        }
+        vsize_t room = capacity - cachedq_count(cq);
+        ASSERT(cachedq_enqueue(cq, in, capacity + 1) == 0);
+        vsize_t n = cachedq_enqueue_burst(cq, in, capacity + 3);
+        ASSERT(n == room);
+        next_in += n;
+        ASSERT(cachedq_count(cq) == capacity);
+        ASSERT(cachedq_enqueue_burst(cq, in, 1) == 0);
+
+        /* drain an uneven amount, so the next round wraps elsewhere */
+        vsize_t m = cachedq_dequeue(cq, out, (round % capacity) + 1);
+        ASSERT(m == (round % capacity) + 1);
+        for (vsize_t i = 0; i < m; i++) {
+            ASSERT(out[i] == next_out + i);
+        }
+        next_out += m;
+    }
+    vsize_t left = cachedq_count(cq);
+    vsize_t m    = cachedq_dequeue(cq, out, 64);
+    ASSERT(m == left && next_out + m == next_in);
+    for (vsize_t i = 0; i < m; i++) {
+        ASSERT(out[i] == next_out + i);
+    }
+    ASSERT(cachedq_dequeue(cq, out, 1) == 0);
+    free(mem);
+}
+
+int
+main(void)
+{
+    /* power-of-two capacities use the mask, the others the modulo */
+    test_wrap(16);
+    test_wrap(13);
+    test_wrap(1);
+
+    vsize_t buf_size = cachedq_memsize(64);
+    void *buf        = malloc(buf_size);
+    q                = cachedq_init(buf, buf_size);
+    vatomic64_write(&g_sum, WRITER_THREAD * NUM * (NUM + 1) / 2);
+
+    pthread_t thread_w[WRITER_THREAD];
+    pthread_t thread_r[READER_THREAD];
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_create(&thread_w[i], NULL, writer, NULL);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_create(&thread_r[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_join(thread_w[i], NULL);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_join(thread_r[i], NULL);
+    }
+    ASSERT(cachedq_count(q) == 0);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDQ_PARK
+#define VPARK_MAX_SPIN 100U
+#include <vsync/queue/cachedq.h>
+#include <vsync/utils/math.h>
+
+#define NUM              20000UL
+#define WRITER_THREAD    2UL
+#define READER_THREAD    2UL
+#define BUFFER_ENTRY_NUM 16UL
+#define ENQUEUE_BATCH    4UL
+#define DEQUEUE_BATCH    3UL
+#define PAUSE            1000UL
+
+cachedq_t *q;
+vatomic64_t g_sum;
+
+void *
+writer(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t buf[ENQUEUE_BATCH];
+    for (vuint64_t i = 0; i < NUM; i += ENQUEUE_BATCH) {
+        for (vsize_t j = 0; j < ENQUEUE_BATCH; j++) {
+            buf[j] = i + j + 1;
+        }
+        vsize_t count = cachedq_enqueue_wait(q, buf, ENQUEUE_BATCH);
+        ASSERT(count == ENQUEUE_BATCH);
+        V_UNUSED(count);
+        if (i % PAUSE == 0) {
+            /* let the readers park */
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+void *
+reader(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t buf[DEQUEUE_BATCH];
+    vuint64_t rest = NUM * WRITER_THREAD / READER_THREAD;
+    vuint64_t n    = 0;
+
+    while (rest) {
+        vsize_t count =
+            cachedq_dequeue_wait(q, buf, (vsize_t)VMIN(rest, DEQUEUE_BATCH));
+        ASSERT(count > 0);
+        for (vsize_t i = 0; i < count; i++) {
+            vatomic64_add(&g_sum, buf[i]);
+        }
+        rest -= count;
+        if (++n % PAUSE == 0) {
+            /* let the writers park */
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+void *
+idle_reader(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t val = 0;
+    vsize_t count = cachedq_dequeue_wait(q, &val, 1);
+    ASSERT(count == 1 && val == 42);
+    V_UNUSED(count);
+    return NULL;
+}
+
+int
+main(void)
+{
+    vsize_t buf_size = cachedq_memsize(BUFFER_ENTRY_NUM);
+    void *buf        = malloc(buf_size);
+    q                = cachedq_init(buf, buf_size);
+
+    /* an idle reader parks until an entry arrives */
+    pthread_t t;
+    pthread_create(&t, NULL, idle_reader, NULL);
+    while (vatomic32_read(&q->park.waiters) == 0) {
+        usleep(1000);
+    }
+    vuint64_t val = 42;
+    ASSERT(cachedq_enqueue(q, &val, 1) == 1);
+    pthread_join(t, NULL);
+    ASSERT(vatomic32_read(&q->park.waiters) == 0);
+
+    pthread_t thread_w[WRITER_THREAD];
+    pthread_t thread_r[READER_THREAD];
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_create(&thread_w[i], NULL, writer, NULL);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_create(&thread_r[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_join(thread_w[i], NULL);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_join(thread_r[i], NULL);
+    }
+
+    ASSERT(vatomic64_read(&g_sum) == WRITER_THREAD * NUM * (NUM + 1) / 2);
+    ASSERT(cachedq_count(q) == 0);
+    free(buf);
+    return 0;
+}
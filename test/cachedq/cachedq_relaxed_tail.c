@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <vsync/vtypes.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDQ_RELAXED_TAIL
+#include <vsync/queue/cachedq.h>
+#include <vsync/utils/math.h>
+
+#define NUM              5000UL
+#define WRITER_THREAD    3UL
+#define READER_THREAD    3UL
+#define BUFFER_ENTRY_NUM 13UL
+#define ENQUEUE_BATCH    4UL
+#define DEQUEUE_BATCH    3UL
+#define ID_SHIFT         32U
+
+cachedq_t *q;
+vatomic64_t g_sum;
+vatomic64_t g_read;
+
+/* a producer that reserved a batch and stalls does not block the others */
+void
+test_stalled_producer(void)
+{
+    vsize_t buf_size = cachedq_memsize(8);
+    void *buf        = malloc(buf_size);
+    cachedq_t *rq    = cachedq_init(buf, buf_size);
+    vuint64_t val[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    vuint64_t out[8] = {0};
+
+    ASSERT(rq->size == 8);
+    /* reserve two slots as a producer would, but do not publish yet */
+    ASSERT(vatomic64_cmpxchg(&rq->phead, 0, 2) == 0);
+    ASSERT(cachedq_enqueue(rq, &val[2], 3) == 3);
+    ASSERT(cachedq_enqueue(rq, &val[5], 2) == 2);
+    /* nothing is visible before the stalled batch */
+    ASSERT(cachedq_count(rq) == 0);
+    ASSERT(cachedq_dequeue(rq, out, 8) == 0);
+    /* the stalled producer finishes and publishes everything */
+    _cachedq_copy_in(rq, 0, val, 2);
+    _cachedq_publish(rq, &rq->ptail, 0, 2, CACHEDQ_MARK_PROD);
+    ASSERT(cachedq_count(rq) == 7);
+
+    /* same for a stalled consumer: the ring frees up once it finishes */
+    ASSERT(vatomic64_cmpxchg(&rq->chead, 0, 1) == 0);
+    ASSERT(cachedq_dequeue(rq, out, 6) == 6);
+    for (vsize_t i = 0; i < 6; i++) {
+        ASSERT(out[i] == val[i + 1]);
+    }
+    ASSERT(cachedq_enqueue(rq, &val[7], 1) == 1);
+    ASSERT(cachedq_enqueue(rq, val, 1) == 0);
+    _cachedq_copy_out(rq, 0, out, 1);
+    ASSERT(out[0] == val[0]);
+    _cachedq_publish(rq, &rq->ctail, 0, 1, CACHEDQ_MARK_CONS);
+    ASSERT(cachedq_count(rq) == 1);
+    ASSERT(cachedq_enqueue(rq, val, 7) == 7);
+    ASSERT(cachedq_dequeue(rq, out, 8) == 8);
+    ASSERT(out[0] == val[7]);
+    ASSERT(cachedq_count(rq) == 0);
+    free(buf);
+}
+
+void *
+writer(void *data)
+{
+    vuint64_t id = (vuint64_t)(vuintptr_t)data;
+    vuint64_t buf[ENQUEUE_BATCH];
+    for (vuint64_t i = 0; i < NUM; i += ENQUEUE_BATCH) {
+        for (vsize_t j = 0; j < ENQUEUE_BATCH; j++) {
+            buf[j] = (id << ID_SHIFT) | (i + j + 1);
+        }
+        vsize_t count = cachedq_enqueue_wait(q, buf, ENQUEUE_BATCH);
+        ASSERT(count == ENQUEUE_BATCH);
+        V_UNUSED(count);
+    }
+    return NULL;
+}
+
+void *
+reader(void *data)
+{
+    V_UNUSED(data);
+    vuint64_t buf[DEQUEUE_BATCH];
+    vuint64_t last[WRITER_THREAD] = {0};
+    vuint64_t total               = NUM * WRITER_THREAD;
+
+    while (vatomic64_read(&g_read) < total) {
+        vsize_t count = cachedq_dequeue(q, buf, DEQUEUE_BATCH);
+        for (vsize_t i = 0; i < count; i++) {
+            vuint64_t id  = buf[i] >> ID_SHIFT;
+            vuint64_t seq = buf[i] & ((1ULL << ID_SHIFT) - 1);
+            ASSERT(id < WRITER_THREAD);
+            /* entries of one writer come out in order */
+            ASSERT(seq > last[id]);
+            last[id] = seq;
+            vatomic64_add(&g_sum, seq);
+        }
+        vatomic64_add(&g_read, count);
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    test_stalled_producer();
+
+    vsize_t buf_size = cachedq_memsize(BUFFER_ENTRY_NUM);
+    void *buf        = malloc(buf_size);
+    q                = cachedq_init(buf, buf_size);
+    ASSERT(q->size == BUFFER_ENTRY_NUM);
+
+    pthread_t thread_w[WRITER_THREAD];
+    pthread_t thread_r[READER_THREAD];
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_create(&thread_w[i], NULL, writer, (void *)(vuintptr_t)i);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_create(&thread_r[i], NULL, reader, NULL);
+    }
+    for (vsize_t i = 0; i < WRITER_THREAD; i++) {
+        pthread_join(thread_w[i], NULL);
+    }
+    for (vsize_t i = 0; i < READER_THREAD; i++) {
+        pthread_join(thread_r[i], NULL);
+    }
+
+    ASSERT(vatomic64_read(&g_sum) == WRITER_THREAD * NUM * (NUM + 1) / 2);
+    ASSERT(cachedq_count(q) == 0);
+    free(buf);
+    return 0;
+}
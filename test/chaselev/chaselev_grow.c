@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/chaselev.h>
+
+#define NUM_ENTRIES 100000U
+#define NUM_THREADS 4U
+#define POP_FREQ    3U
+#define INIT_SIZE   2U
+#define MAX_RETIRED 64U
+
+vdeque_t g_deque;
+vuint32_t g_vals[NUM_ENTRIES];
+vatomic32_t g_taken[NUM_ENTRIES];
+vatomic32_t g_done;
+
+/* arrays passed to the retire callback, freed once the stealers are gone */
+vdeque_array_t *g_retired[MAX_RETIRED];
+vsize_t g_retired_count;
+
+static void *
+_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+static void
+_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+static void
+_retire(vdeque_array_t *a, void *arg)
+{
+    ASSERT(arg == &g_deque);
+    ASSERT(g_retired_count < MAX_RETIRED);
+    g_retired[g_retired_count++] = a;
+}
+
+static void
+take(void *v)
+{
+    vsize_t i = (vsize_t)((vuint32_t *)v - g_vals);
+    ASSERT(i < NUM_ENTRIES);
+    vuint32_t n = vatomic32_get_inc_rlx(&g_taken[i]);
+    ASSERT(n == 0 && "entry taken twice");
+    V_UNUSED(n);
+}
+
+static void *
+stealer(void *args)
+{
+    V_UNUSED(args);
+    void *v = NULL;
+    while (true) {
+        vdeque_state_t s = vdeque_steal(&g_deque, &v);
+        if (s == VDEQUE_STATE_OK) {
+            take(v);
+        } else if (s == VDEQUE_STATE_EMPTY && vatomic32_read(&g_done)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void
+owner(void)
+{
+    void *r = NULL;
+    for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+        vdeque_state_t s = vdeque_push_bottom(&g_deque, &g_vals[i]);
+        ASSERT(s == VDEQUE_STATE_OK);
+        V_UNUSED(s);
+        if (i % POP_FREQ == 0 &&
+            vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_OK) {
+            take(r);
+        }
+    }
+    while (vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_OK) {
+        take(r);
+    }
+    vatomic32_write(&g_done, 1U);
+}
+
+static void
+check_all_taken(void)
+{
+    for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+        ASSERT(vatomic32_read_rlx(&g_taken[i]) == 1U);
+        vatomic32_write_rlx(&g_taken[i], 0U);
+    }
+}
+
+static void
+run(void)
+{
+    pthread_t threads[NUM_THREADS];
+    vatomic32_write(&g_done, 0U);
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, stealer, NULL);
+    }
+    owner();
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    check_all_taken();
+}
+
+int
+main(void)
+{
+    vmem_lib_t mem_lib = {
+        .free_fun = _free, .malloc_fun = _malloc, .arg = NULL};
+
+    /* a deque initialized with vdeque_init stays bounded */
+    vdeque_array_t *a = (vdeque_array_t *)malloc(vdeque_memsize(INIT_SIZE));
+    vdeque_init(&g_deque, a, INIT_SIZE);
+    ASSERT(vdeque_push_bottom(&g_deque, &g_vals[0]) == VDEQUE_STATE_OK);
+    ASSERT(vdeque_push_bottom(&g_deque, &g_vals[1]) == VDEQUE_STATE_OK);
+    ASSERT(vdeque_push_bottom(&g_deque, &g_vals[2]) == VDEQUE_STATE_FULL);
+    free(a);
+
+    /* replaced arrays kept by the deque */
+    vdeque_init_growable(&g_deque, INIT_SIZE, mem_lib, NULL, NULL);
+    run();
+    ASSERT(g_deque.retired != NULL);
+    vdeque_destroy(&g_deque);
+
+    /* replaced arrays handed to the callback */
+    vdeque_init_growable(&g_deque, INIT_SIZE, mem_lib, _retire, &g_deque);
+    run();
+    ASSERT(g_retired_count > 0);
+    ASSERT(g_deque.retired == NULL);
+    for (vsize_t i = 0; i < g_retired_count; i++) {
+        vdeque_array_free(&g_deque, g_retired[i]);
+    }
+    vdeque_destroy(&g_deque);
+    return 0;
+}
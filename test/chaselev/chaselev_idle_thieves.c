@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/chaselev.h>
+
+#define NUM_ROUNDS  100000U
+#define NUM_THREADS 4U
+#define ARRAY_SIZE  16U
+#define BATCH       8U
+#define NUM_VALS    8U
+
+/* Many thieves call vdeque_steal_many on a deque while the owner pushes a
+ * few entries and pops them again. Whether or not a thief claimed the
+ * bottom entry, the owner must never see VDEQUE_STATE_ABORT, and every
+ * entry must be taken exactly once. */
+
+vdeque_t g_deque;
+vuint32_t g_vals[NUM_VALS];
+vatomic32_t g_taken[NUM_VALS];
+vatomic32_t g_done;
+
+static void
+take(void *v)
+{
+    vsize_t i = (vsize_t)((vuint32_t *)v - g_vals);
+    ASSERT(i < NUM_VALS);
+    vatomic32_inc_rlx(&g_taken[i]);
+}
+
+static void *
+thief(void *args)
+{
+    void *v[BATCH];
+    vsize_t n = 0;
+
+    V_UNUSED(args);
+    while (vatomic32_read(&g_done) == 0U) {
+        if (vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK) {
+            ASSERT(n > 0U && n <= BATCH);
+            for (vsize_t i = 0; i < n; i++) {
+                take(v[i]);
+            }
+        }
+    }
+    return NULL;
+}
+
+/* pushes `num` entries, pops until empty and checks each was taken once */
+static void
+run_owner(vuint32_t num)
+{
+    void *r = NULL;
+
+    for (vuint32_t i = 0; i < NUM_ROUNDS; i++) {
+        for (vuint32_t j = 0; j < num; j++) {
+            ASSERT(vdeque_push_bottom(&g_deque, &g_vals[j]) ==
+                   VDEQUE_STATE_OK);
+        }
+        vdeque_state_t s = VDEQUE_STATE_OK;
+        while (s == VDEQUE_STATE_OK) {
+            s = vdeque_pop_bottom(&g_deque, &r);
+            ASSERT(s != VDEQUE_STATE_ABORT);
+            if (s == VDEQUE_STATE_OK) {
+                take(r);
+            }
+        }
+        /* a thief might still hold the values it stole */
+        for (vuint32_t j = 0; j < num; j++) {
+            while (vatomic32_read(&g_taken[j]) == 0U) {
+                vatomic_cpu_pause();
+            }
+            ASSERT(vatomic32_read(&g_taken[j]) == 1U);
+            vatomic32_write_rlx(&g_taken[j], 0U);
+        }
+    }
+}
+
+/* A thief is paused after claiming its range: its output array is write
+ * protected, so it faults while copying the values and waits in the signal
+ * handler until the main thread, acting as owner, lets it go on. */
+
+void **g_paused_out;
+vsize_t g_page;
+vatomic32_t g_paused;
+vatomic32_t g_resumed;
+
+static void
+on_fault(int sig, siginfo_t *info, void *ctx)
+{
+    V_UNUSED(sig, ctx);
+    ASSERT((char *)info->si_addr >= (char *)g_paused_out &&
+           (char *)info->si_addr < (char *)g_paused_out + g_page);
+    vatomic32_write(&g_paused, 1U);
+    while (vatomic32_read(&g_resumed) == 0U) {
+        vatomic_cpu_pause();
+    }
+}
+
+static void *
+paused_thief(void *args)
+{
+    vsize_t n = 0;
+
+    V_UNUSED(args);
+    ASSERT(vdeque_steal_many(&g_deque, g_paused_out, BATCH, &n) ==
+           VDEQUE_STATE_ABORT);
+    ASSERT(n == 0U);
+    return NULL;
+}
+
+static void
+test_paused_claim(void)
+{
+    struct sigaction sa = {0};
+    pthread_t thread;
+    void *v[BATCH];
+    void *r   = NULL;
+    vsize_t n = 0;
+
+    g_page       = (vsize_t)sysconf(_SC_PAGESIZE);
+    g_paused_out = (void **)mmap(NULL, g_page, PROT_READ,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT(g_paused_out != MAP_FAILED);
+    sa.sa_sigaction = on_fault;
+    sa.sa_flags     = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    ASSERT(sigaction(SIGSEGV, &sa, NULL) == 0);
+
+    for (vuint32_t i = 0; i < 6U; i++) {
+        ASSERT(vdeque_push_bottom(&g_deque, &g_vals[i]) == VDEQUE_STATE_OK);
+    }
+    /* the thief claims the three oldest values */
+    pthread_create(&thread, NULL, paused_thief, NULL);
+    while (vatomic32_read(&g_paused) == 0U) {
+        vatomic_cpu_pause();
+    }
+    /* another thief takes a single value */
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 1U && v[0] == &g_vals[0]);
+    /* the owner pops above the claim as usual */
+    for (vuint32_t i = 5U; i >= 3U; i--) {
+        ASSERT(vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_OK);
+        ASSERT(r == &g_vals[i]);
+    }
+    /* inside the claim, it takes the oldest value instead */
+    ASSERT(vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_OK);
+    ASSERT(r == &g_vals[1]);
+    ASSERT(vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_OK);
+    ASSERT(r == &g_vals[2]);
+    ASSERT(vdeque_pop_bottom(&g_deque, &r) == VDEQUE_STATE_EMPTY);
+
+    /* the thief goes on and loses the race for top */
+    ASSERT(mprotect(g_paused_out, g_page, PROT_READ | PROT_WRITE) == 0);
+    vatomic32_write(&g_resumed, 1U);
+    pthread_join(thread, NULL);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_EMPTY);
+    ASSERT(munmap(g_paused_out, g_page) == 0);
+}
+
+static void
+test_thieves(vuint32_t num)
+{
+    pthread_t threads[NUM_THREADS];
+
+    vatomic32_write(&g_done, 0U);
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, thief, NULL);
+    }
+    run_owner(num);
+    vatomic32_write(&g_done, 1U);
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+int
+main(void)
+{
+    vdeque_array_t *a = (vdeque_array_t *)malloc(vdeque_memsize(ARRAY_SIZE));
+    void *v[BATCH];
+    vsize_t n = 0;
+
+    vdeque_init(&g_deque, a, ARRAY_SIZE);
+    /* idle thieves leave the deque alone */
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_EMPTY);
+    ASSERT(n == 0U);
+    test_paused_claim();
+
+    /* a thief can never claim the bottom entry of two */
+    test_thieves(2U);
+    /* claims include the bottom entry, the owner takes the top instead */
+    test_thieves(NUM_VALS);
+    free(a);
+    return 0;
+}
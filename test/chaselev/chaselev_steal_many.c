@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/chaselev.h>
+
+#define NUM_ENTRIES 100000U
+#define NUM_THREADS 3U
+#define ARRAY_SIZE  1024U
+#define POP_FREQ    2U
+#define BATCH       8U
+
+vdeque_t g_deque;
+vuint32_t g_vals[NUM_ENTRIES];
+vatomic32_t g_taken[NUM_ENTRIES];
+vatomic32_t g_done;
+
+static void
+take(void *v)
+{
+    vsize_t i = (vsize_t)((vuint32_t *)v - g_vals);
+    ASSERT(i < NUM_ENTRIES);
+    vuint32_t n = vatomic32_get_inc_rlx(&g_taken[i]);
+    ASSERT(n == 0 && "entry taken twice");
+    V_UNUSED(n);
+}
+
+static void *
+stealer(void *args)
+{
+    V_UNUSED(args);
+    void *v[BATCH];
+    vsize_t n = 0;
+    while (true) {
+        vdeque_state_t s = vdeque_steal_many(&g_deque, v, BATCH, &n);
+        if (s == VDEQUE_STATE_OK) {
+            ASSERT(n > 0 && n <= BATCH);
+            /* values come out oldest first */
+            for (vsize_t i = 0; i < n; i++) {
+                ASSERT(i == 0 || (vuint32_t *)v[i] > (vuint32_t *)v[i - 1]);
+                take(v[i]);
+            }
+        } else if (s == VDEQUE_STATE_EMPTY && vatomic32_read(&g_done)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void
+owner(void)
+{
+    void *r = NULL;
+    vdeque_state_t s;
+    for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+        while (vdeque_push_bottom(&g_deque, &g_vals[i]) != VDEQUE_STATE_OK) {}
+        if (i % POP_FREQ == 0) {
+            s = vdeque_pop_bottom(&g_deque, &r);
+            if (s == VDEQUE_STATE_OK) {
+                take(r);
+            }
+        }
+    }
+    while (true) {
+        s = vdeque_pop_bottom(&g_deque, &r);
+        if (s == VDEQUE_STATE_OK) {
+            take(r);
+        } else if (s == VDEQUE_STATE_EMPTY) {
+            break;
+        }
+    }
+    vatomic32_write(&g_done, 1U);
+}
+
+/* single-threaded: halves, rounding up, bounded by max */
+static void
+test_sizes(void)
+{
+    vdeque_array_t *a = (vdeque_array_t *)malloc(vdeque_memsize(16));
+    void *v[BATCH];
+    vsize_t n = 0;
+
+    vdeque_init(&g_deque, a, 16);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_EMPTY);
+    ASSERT(n == 0);
+    for (vuint32_t i = 0; i < 16; i++) {
+        ASSERT(vdeque_push_bottom(&g_deque, &g_vals[i]) == VDEQUE_STATE_OK);
+    }
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 8 && v[0] == &g_vals[0] && v[7] == &g_vals[7]);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 4 && v[0] == &g_vals[8]);
+    ASSERT(vdeque_steal_many(&g_deque, v, 1, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 1 && v[0] == &g_vals[12]);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 2 && v[0] == &g_vals[13]);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_OK);
+    ASSERT(n == 1 && v[0] == &g_vals[15]);
+    ASSERT(vdeque_steal_many(&g_deque, v, BATCH, &n) == VDEQUE_STATE_EMPTY);
+    free(a);
+}
+
+int
+main(void)
+{
+    test_sizes();
+
+    vdeque_array_t *a = (vdeque_array_t *)malloc(vdeque_memsize(ARRAY_SIZE));
+    vdeque_init(&g_deque, a, ARRAY_SIZE);
+    pthread_t threads[NUM_THREADS];
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, stealer, NULL);
+    }
+    owner();
+    for (vuint32_t i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+        ASSERT(vatomic32_read_rlx(&g_taken[i]) == 1U);
+    }
+    free(a);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef HASHTABLE_EVICTABLE
+    #define HASHTABLE_EVICTABLE
+#endif
+#include <test/hashtable/map.h>
+
+#define NUM_KEYS 64U
+#define CAPACITY 16U
+
+user_key_t g_keys[NUM_KEYS];
+
+void
+gen_unique_keys(void)
+{
+    user_key_t key = {0};
+    vbool_t unique = false;
+    for (vsize_t i = 0; i < NUM_KEYS; i++) {
+        do {
+            key    = gen_key();
+            unique = true;
+            for (vsize_t j = 0; j < i; j++) {
+                if (user_key_eq(key, g_keys[j])) {
+                    unique = false;
+                }
+            }
+        } while (!unique);
+        g_keys[i] = key;
+    }
+}
+
+void
+reinit_bounded(vuint64_t capacity)
+{
+    /* the table is still empty, swap in a bounded one */
+    ASSERT(map_get_entries_count() == 0);
+    vhashtable_init_bounded(&g_hashtable, _evict_callback, NULL,
+                            _cmp_callback, capacity);
+}
+
+void
+unit_test_bounded(void)
+{
+    vhashtable_stats_t stats = {0};
+
+    map_init();
+    reinit_bounded(CAPACITY);
+
+    for (vsize_t i = 0; i < NUM_KEYS; i++) {
+        ASSERT(map_insert(MAIN_TID, g_keys[i]));
+        ASSERT(map_get_entries_count() <= CAPACITY);
+    }
+    ASSERT(map_get_entries_count() == CAPACITY);
+    ASSERT(vatomic64_read(&g_evict_count) == NUM_KEYS - CAPACITY);
+
+    vhashtable_get_stats(&g_hashtable, &stats);
+    ASSERT(stats.evictions == NUM_KEYS - CAPACITY);
+    ASSERT(_map_get_stats().bucket_len_sum == CAPACITY);
+    map_destroy();
+}
+
+void
+unit_test_second_chance(void)
+{
+    user_key_t hot = g_keys[0];
+
+    map_init();
+    for (vsize_t i = 0; i < NUM_KEYS; i++) {
+        ASSERT(map_insert(MAIN_TID, g_keys[i]));
+    }
+    /* the first sweep clears the reference bits, the second one evicts */
+    ASSERT(map_evict(MAIN_TID, 1) == 1);
+    ASSERT(map_get_entries_count() == NUM_KEYS - 1U);
+
+    /* every entry lost its reference bit, but hot is used again */
+    if (map_get(MAIN_TID, hot) == NULL) {
+        hot = g_keys[1];
+        ASSERT(map_get(MAIN_TID, hot) != NULL);
+    }
+    ASSERT(map_evict(MAIN_TID, NUM_KEYS - 2U) == NUM_KEYS - 2U);
+    ASSERT(map_get_entries_count() == 1);
+    ASSERT(map_get(MAIN_TID, hot) != NULL);
+
+    /* nothing left to evict but hot, it gets evicted in the next sweep */
+    ASSERT(map_evict(MAIN_TID, NUM_KEYS) == 1);
+    ASSERT(map_get_entries_count() == 0);
+    ASSERT(map_get(MAIN_TID, hot) == NULL);
+    map_destroy();
+}
+
+void
+unit_test_stats(void)
+{
+    vhashtable_stats_t stats = {0};
+
+    map_init();
+    for (vsize_t i = 0; i < NUM_KEYS / 2U; i++) {
+        ASSERT(map_insert(MAIN_TID, g_keys[i]));
+    }
+    for (vsize_t i = 0; i < NUM_KEYS; i++) {
+        (void)map_get(MAIN_TID, g_keys[i]);
+    }
+    ASSERT(map_remove(MAIN_TID, g_keys[0]));
+    ASSERT(map_get(MAIN_TID, g_keys[0]) == NULL);
+
+    vhashtable_get_stats(&g_hashtable, &stats);
+    ASSERT(stats.hits == NUM_KEYS / 2U);
+    ASSERT(stats.misses == NUM_KEYS / 2U + 1U);
+    ASSERT(stats.evictions == 0);
+    map_destroy();
+}
+
+int
+main(void)
+{
+    gen_unique_keys();
+    unit_test_bounded();
+    unit_test_second_chance();
+    unit_test_stats();
+    return 0;
+}
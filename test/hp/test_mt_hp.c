@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <vsync/smr/hp.h>
+#include <test/thread_launcher.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define N       8U
+#define WRITERS 2U
+#define IT      10000U
+#define ALIVE   0xA11FEU
+
+/*
+ * Writers keep replacing the shared object and retire the old one, readers
+ * protect it and check it is not destroyed while protected.
+ */
+
+typedef struct obj_s {
+    vatomic32_t state;
+    vhp_node_t hp_node;
+} obj_t;
+
+pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+vhp_t g_hp;
+vatomicptr_t g_shared;
+vatomic64_t g_alloc = VATOMIC_INIT(0);
+vatomic64_t g_freed = VATOMIC_INIT(0);
+
+static inline void
+lock_acq(void *arg)
+{
+    pthread_mutex_lock((pthread_mutex_t *)arg);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    obj_t *obj = V_CONTAINER_OF(node, obj_t, hp_node.smr_node);
+    ASSERT(vatomic32_read(&obj->state) == ALIVE);
+    /* a reader that still sees the object would catch this */
+    vatomic32_write(&obj->state, 0);
+    free(obj);
+    vatomic64_inc(&g_freed);
+    V_UNUSED(args);
+}
+
+obj_t *
+obj_new(void)
+{
+    obj_t *obj = malloc(sizeof(obj_t));
+    vatomic32_init(&obj->state, ALIVE);
+    vatomic64_inc(&g_alloc);
+    return obj;
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    vhp_thread_t thrd;
+    obj_t *obj = NULL;
+
+    vhp_register(&g_hp, &thrd);
+    for (vsize_t i = 0; i < IT; i++) {
+        vhp_enter(&g_hp, &thrd);
+        if (tid < WRITERS) {
+            obj = vatomicptr_xchg(&g_shared, obj_new());
+            vhp_retire(&g_hp, &thrd, obj, &obj->hp_node, free_cb, NULL);
+        } else {
+            obj = vhp_protect(&thrd, 0, &g_shared);
+            ASSERT(vatomic32_read(&obj->state) == ALIVE);
+        }
+        vhp_exit(&g_hp, &thrd);
+    }
+    vhp_deregister(&g_hp, &thrd);
+    return NULL;
+}
+
+int
+main(void)
+{
+    smr_lock_lib_t lock_lib = {lock_acq, lock_rel, &g_lock};
+    obj_t *obj              = NULL;
+
+    vhp_init(&g_hp, lock_lib);
+    vatomicptr_init(&g_shared, obj_new());
+
+    launch_threads(N, run);
+
+    obj = vatomicptr_read(&g_shared);
+    free_cb(&obj->hp_node.smr_node, NULL);
+    vhp_destroy(&g_hp);
+    ASSERT(vatomic64_read(&g_alloc) == vatomic64_read(&g_freed));
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <vsync/smr/hp.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct obj_s {
+    vsize_t id;
+    vhp_node_t hp_node;
+} obj_t;
+
+pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+vhp_t g_hp;
+vsize_t g_freed = 0;
+
+static inline void
+lock_acq(void *arg)
+{
+    pthread_mutex_lock((pthread_mutex_t *)arg);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    obj_t *obj = V_CONTAINER_OF(node, obj_t, hp_node.smr_node);
+    free(obj);
+    g_freed++;
+    V_UNUSED(args);
+}
+
+obj_t *
+obj_new(vsize_t id)
+{
+    obj_t *obj = malloc(sizeof(obj_t));
+    obj->id    = id;
+    return obj;
+}
+
+void
+ut_protect(void)
+{
+    vhp_thread_t reader;
+    vhp_thread_t writer;
+    vatomicptr_t shared;
+    obj_t *obj = obj_new(1);
+    obj_t *cur = NULL;
+
+    vhp_register(&g_hp, &reader);
+    vhp_register(&g_hp, &writer);
+    vatomicptr_init(&shared, obj);
+
+    cur = vhp_protect(&reader, 0, &shared);
+    ASSERT(cur == obj);
+
+    /* replace and retire, the reader still protects the old object */
+    vatomicptr_write(&shared, obj_new(2));
+    vhp_retire(&g_hp, &writer, obj, &obj->hp_node, free_cb, NULL);
+    ASSERT(vhp_recycle(&g_hp, &writer) == 0);
+    ASSERT(cur->id == 1);
+
+    /* released, now it can go */
+    vhp_clear(&reader, 0);
+    ASSERT(vhp_recycle(&g_hp, &writer) == 1);
+    ASSERT(g_freed == 1);
+
+    /* exit releases all slots */
+    vhp_enter(&g_hp, &reader);
+    obj = vhp_protect(&reader, VHP_SLOT_COUNT - 1U, &shared);
+    ASSERT(obj->id == 2);
+    vatomicptr_write(&shared, NULL);
+    vhp_retire(&g_hp, &writer, obj, &obj->hp_node, free_cb, NULL);
+    ASSERT(vhp_recycle(&g_hp, &writer) == 0);
+    vhp_exit(&g_hp, &reader);
+    ASSERT(vhp_recycle(&g_hp, &writer) == 1);
+    ASSERT(vhp_protect(&reader, 0, &shared) == NULL);
+
+    vhp_deregister(&g_hp, &reader);
+    vhp_deregister(&g_hp, &writer);
+}
+
+void
+ut_bounded(void)
+{
+    vhp_thread_t thrd;
+    obj_t *obj     = NULL;
+    vsize_t before = g_freed;
+
+    vhp_register(&g_hp, &thrd);
+    /* retiring more than the capacity frees without explicit recycling */
+    for (vsize_t i = 0; i < 2U * VHP_RETIRE_THRESHOLD; i++) {
+        obj = obj_new(i);
+        vhp_retire(&g_hp, &thrd, obj, &obj->hp_node, free_cb, NULL);
+        ASSERT(thrd.retired_count < VHP_RETIRE_THRESHOLD);
+    }
+    ASSERT(g_freed - before == 2U * VHP_RETIRE_THRESHOLD);
+    vhp_deregister(&g_hp, &thrd);
+}
+
+void
+ut_deregister(void)
+{
+    vhp_thread_t thrd;
+    obj_t *obj = NULL;
+
+    vhp_register(&g_hp, &thrd);
+    for (vsize_t i = 0; i < VHP_RETIRE_THRESHOLD / 2U; i++) {
+        obj = obj_new(i);
+        vhp_retire(&g_hp, &thrd, obj, &obj->hp_node, free_cb, NULL);
+    }
+    ASSERT(thrd.retired_count == VHP_RETIRE_THRESHOLD / 2U);
+    /* deregistration frees what is left */
+    vhp_deregister(&g_hp, &thrd);
+}
+
+#define READERS (2U * VHP_RETIRE_THRESHOLD / VHP_SLOT_COUNT)
+
+vhp_thread_t g_readers[READERS];
+obj_t *g_objs[READERS * VHP_SLOT_COUNT];
+
+void
+ut_all_protected(void)
+{
+    vhp_thread_t thrd;
+    vsize_t before = g_freed;
+
+    vhp_register(&g_hp, &thrd);
+    for (vsize_t r = 0; r < READERS; r++) {
+        vhp_register(&g_hp, &g_readers[r]);
+    }
+    /* more protected objects than a scan can get rid of */
+    for (vsize_t i = 0; i < READERS * VHP_SLOT_COUNT; i++) {
+        g_objs[i] = obj_new(i);
+        vhp_set(&g_readers[i / VHP_SLOT_COUNT], i % VHP_SLOT_COUNT, g_objs[i]);
+    }
+    /* retire does not wait for the readers */
+    for (vsize_t i = 0; i < READERS * VHP_SLOT_COUNT; i++) {
+        vhp_retire(&g_hp, &thrd, g_objs[i], &g_objs[i]->hp_node, free_cb,
+                   NULL);
+    }
+    ASSERT(g_freed == before);
+    ASSERT(thrd.retired_count == READERS * VHP_SLOT_COUNT);
+
+    /* half of the readers leave */
+    for (vsize_t r = 0; r < READERS / 2U; r++) {
+        vhp_deregister(&g_hp, &g_readers[r]);
+    }
+    ASSERT(vhp_recycle(&g_hp, &thrd) == READERS / 2U * VHP_SLOT_COUNT);
+    for (vsize_t r = READERS / 2U; r < READERS; r++) {
+        vhp_deregister(&g_hp, &g_readers[r]);
+    }
+    vhp_deregister(&g_hp, &thrd);
+    ASSERT(g_freed - before == READERS * VHP_SLOT_COUNT);
+}
+
+int
+main(void)
+{
+    smr_lock_lib_t lock_lib = {lock_acq, lock_rel, &g_lock};
+
+    vhp_init(&g_hp, lock_lib);
+    ut_protect();
+    ut_bounded();
+    ut_deregister();
+    ut_all_protected();
+    vhp_destroy(&g_hp);
+    ASSERT(g_freed == 2U + 2U * VHP_RETIRE_THRESHOLD +
+                          VHP_RETIRE_THRESHOLD / 2U + READERS * VHP_SLOT_COUNT);
+    return 0;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -8,6 +8,11 @@
 
 #if defined(HASHTABLE_STANDARD)
     #include <vsync/map/hashtable_standard.h>
+#elif defined(HASHTABLE_SPLIT)
+    #include <vsync/map/hashtable_split.h>
+typedef vhashtable_split_t vhashtable_t;
+typedef vhashtable_split_entry_t vhashtable_entry_t;
+typedef vhashtable_split_key_t vhashtable_key_t;
 #elif defined(HASHTABLE_EVICTABLE)
     #include <vsync/map/hashtable_evictable.h>
     #include <test/hashtable/hashtable_stats.h>
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -88,10 +88,55 @@ _evict_callback(vhashtable_entry_t *hnode, void *args)
     V_UNUSED(args);
 }
 
+#if defined(HASHTABLE_SPLIT)
+    #define MAP_SPLIT_MIN_BUCKETS 16U
+
+/* internal allocations of the table are tracked separately from the entries */
+vatomic64_t g_tbl_alloc_count = VATOMIC_INIT(0);
+vatomic64_t g_tbl_free_count  = VATOMIC_INIT(0);
+
+static inline void *
+_tbl_malloc(vsize_t sz, void *arg)
+{
+    vatomic64_inc_rlx(&g_tbl_alloc_count);
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+static inline void
+_tbl_free(void *ptr, void *arg)
+{
+    vatomic64_inc_rlx(&g_tbl_free_count);
+    V_UNUSED(arg);
+    free(ptr);
+}
+#endif
+
+/* full hash for the split-ordered table, bucket index for the others */
+static inline vuint64_t
+_map_hash(user_key_t key)
+{
+#if defined(HASHTABLE_SPLIT) && !defined(VSYNC_VERIFICATION) &&                \
+    !defined(VSYNC_VERIFICATION_TEST)
+    vuint64_t h = ((vuint64_t)key.ssid << 32U) ^ key.tsid ^
+                  ((vuint64_t)key.tclass << 16U);
+    h ^= h >> 33U;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33U;
+    return h;
+#else
+    return user_key_hash(key);
+#endif
+}
+
 vuint64_t
 iisize(void)
 {
+#if defined(HASHTABLE_SPLIT)
+    return vhashtable_split_get_entries_count(&g_hashtable);
+#else
     return vhashtable_get_entries_count(&g_hashtable);
+#endif
 }
 
 #if defined(HASHTABLE_EVICTABLE)
@@ -148,7 +193,15 @@ map_init(void)
 {
     ismr_init();
 
+#if defined(HASHTABLE_SPLIT)
+    vmem_lib_t tbl_lib = {.free_fun   = _tbl_free,
+                          .malloc_fun = _tbl_malloc,
+                          .arg        = NULL};
+    vhashtable_split_init(&g_hashtable, MAP_SPLIT_MIN_BUCKETS, _evict_callback,
+                          NULL, _cmp_callback, tbl_lib);
+#else
     vhashtable_init(&g_hashtable, _evict_callback, NULL, _cmp_callback);
+#endif
 
 #if !defined(VSYNC_VERIFICATION) && !defined(VSYNC_VERIFICATION_TEST)
     ismr_start_cleaner();
@@ -163,7 +216,13 @@ map_destroy(void)
 #if !defined(VSYNC_VERIFICATION) && !defined(VSYNC_VERIFICATION_TEST)
     ismr_stop_cleaner();
 #endif
+#if defined(HASHTABLE_SPLIT)
+    vhashtable_split_destroy(&g_hashtable);
+    ASSERT(vatomic64_read_rlx(&g_tbl_alloc_count) ==
+           vatomic64_read_rlx(&g_tbl_free_count));
+#else
     vhashtable_destroy(&g_hashtable);
+#endif
     ismr_destroy();
     istats_verify(true);
 }
@@ -185,7 +244,7 @@ map_evict(vsize_t tid, vuint64_t count)
 static inline vuint64_t
 map_get_entries_count(void)
 {
-    return vhashtable_get_entries_count(&g_hashtable);
+    return iisize();
 }
 
 static inline vbool_t
@@ -195,8 +254,13 @@ map_insert_stamped(vsize_t tid, user_key_t key, vsize_t stamp)
     entry->key          = key;
     entry->data.stamp   = stamp;
 
+#if defined(HASHTABLE_SPLIT)
+    vbool_t success = vhashtable_split_insert(
+        &g_hashtable, VHASH_PASS_KEY(key), &entry->hnode, _map_hash(key));
+#else
     vbool_t success = vhashtable_insert(&g_hashtable, VHASH_PASS_KEY(key),
                                         &entry->hnode, user_key_hash(key));
+#endif
     if (!success) {
         vatomic64_inc_rlx(&g_failed_insert_count);
         vmem_free(entry);
@@ -215,15 +279,25 @@ static inline vbool_t
 map_remove(vsize_t tid, user_key_t key)
 {
     V_UNUSED(tid);
+#if defined(HASHTABLE_SPLIT)
+    return vhashtable_split_remove(&g_hashtable, VHASH_PASS_KEY(key),
+                                   _map_hash(key));
+#else
     return vhashtable_remove(&g_hashtable, VHASH_PASS_KEY(key),
                              user_key_hash(key));
+#endif
 }
 
 static inline hash_entry_t *
 map_get(vsize_t tid, user_key_t key)
 {
+#if defined(HASHTABLE_SPLIT)
+    vhashtable_entry_t *hnode = vhashtable_split_get(
+        &g_hashtable, VHASH_PASS_KEY(key), _map_hash(key));
+#else
     vhashtable_entry_t *hnode =
         vhashtable_get(&g_hashtable, VHASH_PASS_KEY(key), user_key_hash(key));
+#endif
     hash_entry_t *entry = _hnode_to_entry(hnode);
 
     if (hnode) {
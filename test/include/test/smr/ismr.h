@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2023-2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2023-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -46,8 +46,8 @@ static inline void ismr_destroy(void);
     #include <test/smr/ismr_cebr.h>
 #elif defined(SMR_GDUMP_LT)
     #include <test/smr/ismr_gdump_lt.h>
-#elif defined(SMR_GDUMPV1) || defined(SMR_GDUMPV2) || defined(SMR_GDUMPV3) ||  \
-    defined(SMR_GDUMPV4)
+#elif defined(SMR_GDUMP) || defined(SMR_GDUMPV1) || defined(SMR_GDUMPV2) ||   \
+    defined(SMR_GDUMPV3) || defined(SMR_GDUMPV4)
     #include <test/smr/ismr_gdump.h>
 #elif defined(DEFAULT_SMR_EBR)
     #include <test/smr/ismr_ebr.h>
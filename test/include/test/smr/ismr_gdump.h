@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef VSYNC_ISMR_GDUMP_H
+#define VSYNC_ISMR_GDUMP_H
+
+#include <vsync/smr/gdump.h>
+#include <vsync/common/dbg.h>
+#include <test/smr/mock_node.h>
+#include <vsync/common/verify.h>
+#include <sched.h>
+#include <stdio.h>
+
+typedef gdump_thread_t ismr_thread_t;
+#include <test/smr/thread_storage.h>
+
+static inline void
+_ismr_rw_read_acq(void *arg)
+{
+    int ret = pthread_rwlock_rdlock((pthread_rwlock_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline void
+_ismr_rw_write_acq(void *arg)
+{
+    int ret = pthread_rwlock_wrlock((pthread_rwlock_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline void
+_ismr_rw_rel(void *arg)
+{
+    int ret = pthread_rwlock_unlock((pthread_rwlock_t *)arg);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+}
+
+static inline int
+_ismr_yield(void *arg)
+{
+    V_UNUSED(arg);
+    return sched_yield();
+}
+
+/* Global Vars */
+gdump_t g_smr;
+pthread_rwlock_t g_gdump_lock;
+smr_rwlock_lib_t g_gdump_lock_lib = {_ismr_rw_read_acq, _ismr_rw_rel,
+                                     _ismr_rw_write_acq, _ismr_rw_rel,
+                                     &g_gdump_lock};
+__thread vsize_t g_tls_tid        = MAIN_TID;
+
+/* ISMR wrapper implementations */
+static inline void
+ismr_enter(vsize_t tid)
+{
+    ASSERT(tid == g_tls_tid);
+    gdump_enter(&g_smr, ismr_get_thread_obj(tid));
+}
+
+static inline void
+ismr_exit(vsize_t tid)
+{
+    ASSERT(tid == g_tls_tid);
+    gdump_exit(&g_smr, ismr_get_thread_obj(tid));
+}
+
+static inline void
+ismr_reg(vsize_t tid)
+{
+    g_tls_tid = tid;
+    gdump_register(&g_smr, ismr_get_thread_obj(tid));
+}
+
+static inline void
+ismr_dereg(vsize_t tid)
+{
+    ASSERT(tid == g_tls_tid);
+    gdump_deregister(&g_smr, ismr_get_thread_obj(tid));
+    ismr_destroy_thread_obj(tid);
+}
+
+static inline void
+ismr_init(void)
+{
+    int ret = pthread_rwlock_init(&g_gdump_lock, NULL);
+    ASSERT(ret == 0);
+    V_UNUSED(ret);
+    gdump_init(&g_smr, g_gdump_lock_lib);
+    ismr_reg(MAIN_TID);
+}
+
+static inline void
+ismr_destroy(void)
+{
+    ismr_dereg(MAIN_TID);
+    gdump_destroy(&g_smr);
+    pthread_rwlock_destroy(&g_gdump_lock);
+}
+
+/* retire through the thread-local buffer to exercise batching */
+static inline void
+ismr_retire(smr_node_t *n, smr_node_destroy_fun destroy_fun, vbool_t local)
+{
+    gdump_retire_local(&g_smr, ismr_get_thread_obj(g_tls_tid), n, destroy_fun,
+                       NULL);
+    V_UNUSED(local);
+}
+
+static inline void
+ismr_retire_with_arg(smr_node_t *node, smr_node_destroy_fun destroy_fun,
+                     void *args)
+{
+    gdump_retire_local(&g_smr, ismr_get_thread_obj(g_tls_tid), node,
+                       destroy_fun, args);
+}
+
+static inline vsize_t
+ismr_recycle(vsize_t tid)
+{
+    V_UNUSED(tid);
+    return gdump_recycle(&g_smr, _ismr_yield, NULL, 1);
+}
+
+static inline vbool_t
+ismr_sync(vsize_t tid)
+{
+    gdump_sync(&g_smr, _ismr_yield, NULL);
+    V_UNUSED(tid);
+    return true;
+}
+
+static inline char *
+ismr_get_name(void)
+{
+    return "gdump";
+}
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#if defined(VSYNC_ADDRESS_SANITIZER)
+    #undef NTHREADS
+    #undef IT
+    #define NTHREADS 4U
+    #define IT       128U
+#endif
+#include <stdlib.h>
+#include <vsync/queue/mpsc.h>
+#include <vsync/common/assert.h>
+#include <test/thread_launcher.h>
+
+#define NPRODUCERS (NTHREADS - 1U)
+#define BATCH      16U
+#define ID_SHIFT   32U
+
+vmpsc_t g_queue;
+vmpsc_node_cache_t g_caches[NTHREADS];
+vatomic32_t g_allocated;
+
+static void
+free_cb(vmpsc_node_t *node, void *args)
+{
+    V_UNUSED(args);
+    free(node);
+}
+
+/* discarded nodes come back to producers through the free list */
+static void
+test_recycle(void)
+{
+    vmpsc_node_t nodes[BATCH];
+    vmpsc_node_cache_t cache;
+    vmpsc_node_t *discarded = NULL;
+    void *out[BATCH];
+
+    vmpsc_init(&g_queue);
+    vmpsc_node_cache_init(&cache);
+    ASSERT(vmpsc_node_get(&g_queue, &cache) == NULL);
+    for (vuintptr_t i = 0; i < BATCH; i++) {
+        vmpsc_enq(&g_queue, &nodes[i], (void *)(i + 1U));
+    }
+    ASSERT(vmpsc_deq_batch(&g_queue, out, 4, &discarded) == 4);
+    /* the sentinel is not discarded */
+    ASSERT(discarded == &nodes[0]);
+    ASSERT(vatomicptr_read_rlx(&nodes[2].next) == NULL);
+    vmpsc_recycle(&g_queue, discarded);
+    ASSERT(vmpsc_deq_batch(&g_queue, out, BATCH, &discarded) == BATCH - 4U);
+    ASSERT(out[0] == (void *)5U && out[BATCH - 5U] == (void *)BATCH);
+    ASSERT(discarded == &nodes[3]);
+    vmpsc_recycle(&g_queue, discarded);
+
+    /* the producer takes the whole list at once */
+    for (vsize_t i = 0; i < BATCH - 1U; i++) {
+        ASSERT(vmpsc_node_get(&g_queue, &cache) != NULL);
+        ASSERT(vatomicptr_read_rlx(&g_queue.free) == NULL);
+    }
+    ASSERT(vmpsc_node_get(&g_queue, &cache) == NULL);
+    ASSERT(vmpsc_deq_batch(&g_queue, out, BATCH, &discarded) == 0);
+}
+
+void
+consume(void)
+{
+    void *out[BATCH];
+    vuintptr_t last[NTHREADS] = {0};
+    vsize_t count             = 0;
+    vsize_t n                 = 0;
+    vmpsc_node_t *discarded   = NULL;
+
+    while (count < NPRODUCERS * IT) {
+        n = vmpsc_deq_batch(&g_queue, out, BATCH, &discarded);
+        ASSERT(n <= BATCH);
+        for (vsize_t i = 0; i < n; i++) {
+            vuintptr_t v   = (vuintptr_t)out[i];
+            vuintptr_t tid = v >> ID_SHIFT;
+            ASSERT(tid > 0 && tid < NTHREADS);
+            /* entries of one producer come out in order */
+            ASSERT((v & ((1ULL << ID_SHIFT) - 1U)) == last[tid] + 1U);
+            last[tid]++;
+        }
+        count += n;
+        vmpsc_recycle(&g_queue, discarded);
+    }
+    ASSERT(vmpsc_deq_batch(&g_queue, out, BATCH, &discarded) == 0);
+    ASSERT(discarded == NULL);
+}
+
+void
+produce(vsize_t tid)
+{
+    vmpsc_node_t *node = NULL;
+    for (vuintptr_t i = 1; i <= IT; i++) {
+        node = vmpsc_node_get(&g_queue, &g_caches[tid]);
+        if (node == NULL) {
+            node = malloc(sizeof(vmpsc_node_t));
+            vatomic32_inc_rlx(&g_allocated);
+        }
+        vmpsc_enq(&g_queue, node, (void *)(((vuintptr_t)tid << ID_SHIFT) | i));
+    }
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    if (tid == 0) {
+        consume();
+    } else {
+        produce(tid);
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    test_recycle();
+    vmpsc_init(&g_queue);
+    for (vsize_t i = 0; i < NTHREADS; i++) {
+        vmpsc_node_cache_init(&g_caches[i]);
+    }
+    launch_threads(NTHREADS, run);
+    ASSERT(vatomic32_read(&g_allocated) <= NPRODUCERS * IT);
+    for (vsize_t i = 0; i < NTHREADS; i++) {
+        vmpsc_node_cache_destroy(&g_caches[i], free_cb, NULL);
+    }
+    vmpsc_destroy(&g_queue, free_cb, NULL);
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <vsync/pool/cached_pool.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDP_NUM_ENTRIES 64U
+#define CACHEDP_MAX_THREAD  4U
+#define CACHEDP_ENTRY_SIZE  8U
+#define NUM_ROUNDS          10U
+#define NUM_BATCHES         (CACHEDP_MAX_THREAD * 2U)
+
+uint8_t buf[cached_pool_memsize(CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES,
+                                CACHEDP_ENTRY_SIZE)];
+
+cached_pool_entry_t batches[NUM_BATCHES];
+
+cached_pool_slot_t *g_stalled_slot;
+vuint64_t g_stalled_seq;
+vatomic32_t g_finished;
+
+/* the stalled consumer publishes that it is done with its slot */
+void *
+finish_consumer(void *arg)
+{
+    V_UNUSED(arg);
+    usleep(10000);
+    vatomic32_write(&g_finished, 1U);
+    vatomic64_write_rel(&g_stalled_slot->seq, g_stalled_seq);
+    return NULL;
+}
+
+int
+main(void)
+{
+    cached_pool_t *a = cached_pool_init(
+        buf, CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES, CACHEDP_ENTRY_SIZE);
+    cached_pool_buffer_t *b = a->buf;
+    cached_pool_entry_t *es = NULL;
+
+    /* drain the batches put there by init */
+    for (vuint32_t i = 0; i < CACHEDP_MAX_THREAD; i++) {
+        ASSERT(_cached_pool_buffer_alloc(a, b));
+    }
+    ASSERT(_cached_pool_buffer_alloc(a, b) == NULL);
+
+    /* FIFO across several wrap-arounds */
+    for (vuint32_t r = 0; r < NUM_ROUNDS; r++) {
+        for (vuint32_t i = 0; i < NUM_BATCHES; i++) {
+            ASSERT(_cached_pool_buffer_free(a, b, &batches[i]));
+        }
+        for (vuint32_t i = 0; i < NUM_BATCHES; i++) {
+            ASSERT(_cached_pool_buffer_alloc(a, b) == &batches[i]);
+        }
+        ASSERT(_cached_pool_buffer_alloc(a, b) == NULL);
+    }
+
+    /* a producer stalls after claiming its slot */
+    vuint64_t stalled = vatomic64_get_inc(&b->phead);
+    ASSERT(_cached_pool_buffer_free(a, b, &batches[1]));
+    ASSERT(_cached_pool_buffer_free(a, b, &batches[2]));
+    /* consumers do not wait for it */
+    ASSERT(_cached_pool_buffer_alloc(a, b) == NULL);
+
+    /* the stalled producer finishes */
+    cached_pool_slot_t *slot = &b->slots[stalled & a->conf.buffer_mask];
+    slot->es                 = &batches[0];
+    vatomic64_write_rel(&slot->seq, stalled + 1U);
+    for (vuint32_t i = 0; i < 3U; i++) {
+        es = _cached_pool_buffer_alloc(a, b);
+        ASSERT(es == &batches[i]);
+    }
+    ASSERT(_cached_pool_buffer_alloc(a, b) == NULL);
+
+    /* a consumer stalls after claiming its slot */
+    vuint64_t slot_num = a->conf.buffer_mask + 1U;
+    ASSERT(_cached_pool_buffer_free(a, b, &batches[0]));
+    vuint64_t claimed = vatomic64_get_inc(&b->chead);
+    g_stalled_slot    = &b->slots[claimed & a->conf.buffer_mask];
+    g_stalled_seq     = claimed + slot_num;
+    ASSERT(g_stalled_slot->es == &batches[0]);
+    /* the others go around the ring up to its slot */
+    for (vuint64_t i = 1; i < slot_num; i++) {
+        ASSERT(_cached_pool_buffer_free(a, b, &batches[i % NUM_BATCHES]));
+        ASSERT(_cached_pool_buffer_alloc(a, b) == &batches[i % NUM_BATCHES]);
+    }
+    /* a fixed pool has nowhere else to put the batch, the producer waits */
+    pthread_t thread;
+    pthread_create(&thread, NULL, finish_consumer, NULL);
+    ASSERT(_cached_pool_buffer_free(a, b, &batches[1]));
+    ASSERT(vatomic32_read(&g_finished) == 1U);
+    pthread_join(thread, NULL);
+    ASSERT(_cached_pool_buffer_alloc(a, b) == &batches[1]);
+    ASSERT(_cached_pool_buffer_alloc(a, b) == NULL);
+    return 0;
+}
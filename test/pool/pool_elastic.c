@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <vsync/pool/cached_pool.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDP_MAX_THREAD   4U
+#define CACHEDP_SLAB_ENTRIES 64U
+#define CACHEDP_MAX_FREE     32U
+#define CACHEDP_ENTRY_SIZE   12U
+#define NUM_ENTRIES          1000U
+#define NUM_IT               200U
+#define NUM_LOCAL            100U
+
+vatomic32_t g_live;
+
+void *
+counting_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_inc(&g_live);
+    return malloc(sz);
+}
+
+void
+counting_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_dec(&g_live);
+    free(ptr);
+}
+
+vmem_lib_t g_mem_lib = {.free_fun   = counting_free,
+                        .malloc_fun = counting_malloc,
+                        .arg        = NULL};
+
+void *data[NUM_ENTRIES];
+
+void
+test_grow_shrink(void)
+{
+    cached_pool_t *a =
+        cached_pool_create(CACHEDP_MAX_THREAD, CACHEDP_SLAB_ENTRIES,
+                           CACHEDP_ENTRY_SIZE, CACHEDP_MAX_FREE, g_mem_lib);
+    ASSERT(a);
+    ASSERT(vatomic32_read(&g_live) == 1U);
+
+    for (vuint32_t round = 0; round < 2; round++) {
+        for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+            data[i] = cached_pool_alloc(a, 0);
+            ASSERT(data[i]);
+            memset(data[i], (int)i, CACHEDP_ENTRY_SIZE);
+        }
+        for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+            for (vuint32_t j = 0; j < CACHEDP_ENTRY_SIZE; j++) {
+                ASSERT(((vuint8_t *)data[i])[j] == (vuint8_t)i);
+            }
+        }
+        /* pool + enough slabs for all entries */
+        ASSERT(vatomic32_read(&g_live) >=
+               1U + NUM_ENTRIES / CACHEDP_SLAB_ENTRIES);
+
+        for (vuint32_t i = 0; i < NUM_ENTRIES; i++) {
+            cached_pool_free(a, 0, data[i]);
+        }
+        /* at most MAX_FREE + 2 batches stay cached, the other slabs are
+         * released */
+        ASSERT(vatomic32_read(&g_live) <= 1U + 3U);
+    }
+
+    cached_pool_destroy(a);
+    ASSERT(vatomic32_read(&g_live) == 0U);
+}
+
+cached_pool_t *g_pool;
+
+void *
+run(void *arg)
+{
+    vuint32_t tid = (vuint32_t)(vuintptr_t)arg;
+    void *local[NUM_LOCAL];
+
+    for (vuint32_t it = 0; it < NUM_IT; it++) {
+        vuint32_t n = (it * 7U + tid) % NUM_LOCAL + 1U;
+        for (vuint32_t i = 0; i < n; i++) {
+            local[i] = cached_pool_alloc(g_pool, tid);
+            ASSERT(local[i]);
+            *(vuint32_t *)local[i] = tid;
+        }
+        for (vuint32_t i = 0; i < n; i++) {
+            ASSERT(*(vuint32_t *)local[i] == tid);
+            cached_pool_free(g_pool, tid, local[i]);
+        }
+    }
+    return NULL;
+}
+
+void
+test_mt(void)
+{
+    pthread_t threads[CACHEDP_MAX_THREAD];
+
+    g_pool = cached_pool_create(CACHEDP_MAX_THREAD, CACHEDP_SLAB_ENTRIES,
+                                CACHEDP_ENTRY_SIZE, CACHEDP_MAX_FREE, g_mem_lib);
+    ASSERT(g_pool);
+    for (vuintptr_t i = 0; i < CACHEDP_MAX_THREAD; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)i);
+    }
+    for (vuint32_t i = 0; i < CACHEDP_MAX_THREAD; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    cached_pool_destroy(g_pool);
+    ASSERT(vatomic32_read(&g_live) == 0U);
+}
+
+int
+main(void)
+{
+    test_grow_shrink();
+    test_mt();
+    return 0;
+}
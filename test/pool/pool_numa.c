@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <vsync/pool/cached_pool.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDP_NUM_ENTRIES 64U
+#define CACHEDP_MAX_THREAD  4U
+#define CACHEDP_ENTRY_SIZE  8U
+#define CACHEDP_NUMA_NUM    2U
+#define CACHEDP_MAX_FREE    32U
+
+uint8_t buf[cached_pool_memsize_numa(CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES,
+                                     CACHEDP_ENTRY_SIZE, CACHEDP_NUMA_NUM)];
+
+void *data[CACHEDP_NUM_ENTRIES * 2U];
+
+vuint64_t
+batches(cached_pool_t *a, vuint32_t node)
+{
+    cached_pool_buffer_t *b = _cached_pool_buffer_find(a, node);
+    return vatomic64_read(&b->phead) - vatomic64_read(&b->chead);
+}
+
+void
+test_fixed(void)
+{
+    cached_pool_t *a =
+        cached_pool_init_numa(buf, CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES,
+                              CACHEDP_ENTRY_SIZE, CACHEDP_NUMA_NUM);
+    vuint32_t batch = a->conf.threshold_init;
+    vuint32_t n     = 0;
+
+    /* threads 0 and 1 on node 0, threads 2 and 3 on node 1 */
+    for (vuint32_t id = 0; id < CACHEDP_MAX_THREAD; id++) {
+        cached_pool_set_node(a, id, id / 2U);
+    }
+    /* init spread the batches over the nodes */
+    ASSERT(batches(a, 0) == 2U);
+    ASSERT(batches(a, 1) == 2U);
+
+    /* local entries, then the local node, then the remote node */
+    for (; n < batch; n++) {
+        data[n] = cached_pool_alloc(a, 0);
+        ASSERT(data[n]);
+    }
+    ASSERT(batches(a, 0) == 2U);
+    for (; n < batch * 3U; n++) {
+        data[n] = cached_pool_alloc(a, 0);
+        ASSERT(data[n]);
+    }
+    ASSERT(batches(a, 0) == 0U);
+    ASSERT(batches(a, 1) == 2U);
+    for (; n < batch * (CACHEDP_MAX_THREAD + 1U); n++) {
+        data[n] = cached_pool_alloc(a, 0);
+        ASSERT(data[n]);
+    }
+    ASSERT(batches(a, 1) == 0U);
+    ASSERT(cached_pool_alloc(a, 0) == NULL);
+
+    /* a thread of node 1 spills to node 1 only */
+    for (vuint32_t i = 0; i < n; i++) {
+        cached_pool_free(a, 2, data[i]);
+    }
+    ASSERT(batches(a, 0) == 0U);
+    ASSERT(batches(a, 1) > 0U);
+
+    /* node 0 steals them back */
+    for (vuint32_t i = 0; i < batch * 2U; i++) {
+        ASSERT(cached_pool_alloc(a, 1));
+    }
+}
+
+vatomic32_t g_live;
+
+void *
+counting_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_inc(&g_live);
+    return malloc(sz);
+}
+
+void
+counting_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_dec(&g_live);
+    free(ptr);
+}
+
+void
+test_elastic(void)
+{
+    vmem_lib_t mem_lib = {.free_fun   = counting_free,
+                          .malloc_fun = counting_malloc,
+                          .arg        = NULL};
+    cached_pool_t *a   = cached_pool_create_numa(
+        CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES, CACHEDP_ENTRY_SIZE,
+        CACHEDP_MAX_FREE, CACHEDP_NUMA_NUM, mem_lib);
+    ASSERT(a);
+
+    cached_pool_set_node(a, 0, 0);
+    cached_pool_set_node(a, 1, 1);
+    for (vuint32_t i = 0; i < CACHEDP_NUM_ENTRIES * 2U; i++) {
+        data[i] = cached_pool_alloc(a, 0);
+        ASSERT(data[i]);
+    }
+    /* freed on node 1, up to the high-water mark of node 1 */
+    for (vuint32_t i = 0; i < CACHEDP_NUM_ENTRIES * 2U; i++) {
+        cached_pool_free(a, 1, data[i]);
+    }
+    ASSERT(batches(a, 0) == 0U);
+    ASSERT(batches(a, 1) * a->conf.threshold_init <= CACHEDP_MAX_FREE);
+    ASSERT(batches(a, 1) > 0U);
+
+    cached_pool_destroy(a);
+    ASSERT(vatomic32_read(&g_live) == 0U);
+}
+
+int
+main(void)
+{
+    test_fixed();
+    test_elastic();
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define CACHED_POOL_REMOTE_FREE
+#include <pthread.h>
+#include <vsync/pool/cached_pool.h>
+#include <vsync/queue/bounded_spsc.h>
+#include <vsync/common/assert.h>
+
+#define CACHEDP_NUM_ENTRIES 256U
+#define CACHEDP_MAX_THREAD  2U
+#define CACHEDP_ENTRY_SIZE  8U
+#define NUM_IT              20000U
+#define QSZ                 64U
+
+uint8_t buf[cached_pool_memsize(CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES,
+                                CACHEDP_ENTRY_SIZE)];
+
+cached_pool_t *g_pool;
+bounded_spsc_t g_queue;
+void *g_data[CACHEDP_NUM_ENTRIES * 2U];
+void *g_queue_buf[QSZ];
+
+void
+test_remote(void)
+{
+    cached_pool_t *a = cached_pool_init(
+        buf, CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES, CACHEDP_ENTRY_SIZE);
+    cached_pool_vunit_t *u0 = &a->vunits[0];
+    cached_pool_vunit_t *u1 = &a->vunits[1];
+    vuint32_t cnt1          = u1->cnt;
+
+    void *p = cached_pool_alloc(a, 0);
+    ASSERT(p);
+
+    /* freed by thread 1, goes back to thread 0 */
+    cached_pool_free(a, 1, p);
+    ASSERT(u1->cnt == cnt1);
+    ASSERT(!quack_is_empty(&u0->remote));
+
+    /* thread 0 takes it back on its next miss */
+    while (u0->top != NULL) {
+        ASSERT(cached_pool_alloc(a, 0));
+    }
+    ASSERT(cached_pool_alloc(a, 0) == p);
+    ASSERT(quack_is_empty(&u0->remote));
+}
+
+void
+test_orphan(void)
+{
+    cached_pool_t *a = cached_pool_init(
+        buf, CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES, CACHEDP_ENTRY_SIZE);
+    cached_pool_vunit_t *u0 = &a->vunits[0];
+    vuint32_t n             = 0;
+    vuint32_t m             = 0;
+
+    /* thread 0 takes everything it can, then stops allocating */
+    while ((g_data[n] = cached_pool_alloc(a, 0)) != NULL) {
+        n++;
+    }
+    /* thread 1 frees all of it onto the list of thread 0 */
+    for (vuint32_t i = 0; i < n; i++) {
+        cached_pool_free(a, 1, g_data[i]);
+    }
+    ASSERT(!quack_is_empty(&u0->remote));
+
+    /* thread 1 adopts the list once its own entries are gone */
+    while (cached_pool_alloc(a, 1) != NULL) {
+        m++;
+    }
+    ASSERT(m > n);
+    ASSERT(quack_is_empty(&u0->remote));
+}
+
+void *
+producer(void *arg)
+{
+    void *p = NULL;
+    V_UNUSED(arg);
+
+    for (vuint32_t i = 0; i < NUM_IT; i++) {
+        while ((p = cached_pool_alloc(g_pool, 0)) == NULL) {
+            vatomic_cpu_pause();
+        }
+        *(vuint32_t *)p = i;
+        while (bounded_spsc_enq(&g_queue, p) != QUEUE_BOUNDED_OK) {
+            vatomic_cpu_pause();
+        }
+    }
+    return NULL;
+}
+
+void *
+consumer(void *arg)
+{
+    void *p = NULL;
+    V_UNUSED(arg);
+
+    for (vuint32_t i = 0; i < NUM_IT; i++) {
+        while (bounded_spsc_deq(&g_queue, &p) != QUEUE_BOUNDED_OK) {
+            vatomic_cpu_pause();
+        }
+        ASSERT(*(vuint32_t *)p == i);
+        cached_pool_free(g_pool, 1, p);
+    }
+    return NULL;
+}
+
+void
+test_pipeline(void)
+{
+    pthread_t threads[2];
+
+    g_pool = cached_pool_init(buf, CACHEDP_MAX_THREAD, CACHEDP_NUM_ENTRIES,
+                              CACHEDP_ENTRY_SIZE);
+    bounded_spsc_init(&g_queue, g_queue_buf, QSZ);
+    vuint32_t cnt1 = g_pool->vunits[1].cnt;
+
+    pthread_create(&threads[0], NULL, producer, NULL);
+    pthread_create(&threads[1], NULL, consumer, NULL);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+
+    /* the consumer never kept any of the entries */
+    ASSERT(g_pool->vunits[1].cnt == cnt1);
+}
+
+int
+main(void)
+{
+    test_remote();
+    test_orphan();
+    test_pipeline();
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define TREESET_LOCK_TTAS
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <vsync/pool/sized_pool.h>
+#include <vsync/map/treeset_rb_coarse.h>
+#include <vsync/common/assert.h>
+
+#define NTHREADS   4U
+#define MAX_SIZE   1024U
+#define SLAB_SIZE  4096U
+#define NUM_BLOCKS 64U
+#define NUM_KEYS   200U
+/* bytes of a block the caller cannot use */
+#define OVERHEAD (SIZED_POOL_ALIGN + sizeof(void *))
+
+vatomic32_t g_live;
+
+void *
+counting_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_inc(&g_live);
+    return malloc(sz);
+}
+
+void
+counting_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    vatomic32_dec(&g_live);
+    free(ptr);
+}
+
+vmem_lib_t g_mem_lib = {.free_fun   = counting_free,
+                        .malloc_fun = counting_malloc,
+                        .arg        = NULL};
+
+__thread vuint32_t g_tid;
+
+vuint32_t
+get_tid(void)
+{
+    return g_tid;
+}
+
+void
+test_classes(vuint32_t steps)
+{
+    sized_pool_t sp;
+    void *blocks[NUM_BLOCKS];
+
+    ASSERT(sized_pool_init(&sp, NTHREADS, MAX_SIZE, steps, SLAB_SIZE, NULL,
+                           g_mem_lib));
+    /* 64 .. 1024 + overhead */
+    ASSERT(sp.class_num == 1U + 5U * steps);
+
+    for (vsize_t sz = 0; sz <= MAX_SIZE; sz++) {
+        void *p = sized_pool_alloc(&sp, 0, sz);
+        ASSERT(p);
+        ASSERT(((vuintptr_t)p & (SIZED_POOL_ALIGN - 1U)) == 0U);
+        vsize_t usable = sized_pool_usable_size(&sp, p);
+        ASSERT(usable >= sz);
+        /* at most one class step of waste */
+        ASSERT(usable + OVERHEAD <= SIZED_POOL_MIN_SIZE ||
+               (usable - sz) * steps <= sz + OVERHEAD);
+        memset(p, 0xab, sz);
+        sized_pool_free(&sp, 0, p);
+    }
+
+    /* larger blocks come from the backing allocator */
+    void *big = sized_pool_alloc(&sp, 1, MAX_SIZE * 4U);
+    ASSERT(big);
+    ASSERT(((vuintptr_t)big & (SIZED_POOL_ALIGN - 1U)) == 0U);
+    ASSERT(sized_pool_usable_size(&sp, big) == 0U);
+    memset(big, 0xcd, MAX_SIZE * 4U);
+    sized_pool_free(&sp, 1, big);
+
+    for (vuint32_t i = 0; i < NUM_BLOCKS; i++) {
+        blocks[i] = sized_pool_alloc(&sp, 2, i * 13U);
+        ASSERT(blocks[i]);
+        memset(blocks[i], (int)i, i * 13U);
+    }
+    for (vuint32_t i = 0; i < NUM_BLOCKS; i++) {
+        for (vuint32_t j = 0; j < i * 13U; j++) {
+            ASSERT(((vuint8_t *)blocks[i])[j] == (vuint8_t)i);
+        }
+        sized_pool_free(&sp, 2, blocks[i]);
+    }
+
+    sized_pool_destroy(&sp);
+    ASSERT(vatomic32_read(&g_live) == 0U);
+}
+
+sized_pool_t g_sp;
+treeset_t g_tree;
+
+void *
+run(void *arg)
+{
+    g_tid = (vuint32_t)(vuintptr_t)arg;
+
+    for (treeset_key_t key = g_tid; key < NUM_KEYS; key += NTHREADS) {
+        ASSERT(treeset_add(&g_tree, key, NULL, NULL));
+    }
+    for (treeset_key_t key = g_tid; key < NUM_KEYS; key += NTHREADS) {
+        ASSERT(treeset_contains(&g_tree, key, NULL));
+        if (key % 2U == 0U) {
+            ASSERT(treeset_remove(&g_tree, key, NULL));
+        }
+    }
+    return NULL;
+}
+
+void
+test_treeset(void)
+{
+    pthread_t threads[NTHREADS];
+
+    ASSERT(sized_pool_init(&g_sp, NTHREADS, MAX_SIZE, 4U, SLAB_SIZE, get_tid,
+                           g_mem_lib));
+    treeset_init(&g_tree, sized_pool_mem_lib(&g_sp));
+    for (vuintptr_t i = 0; i < NTHREADS; i++) {
+        pthread_create(&threads[i], NULL, run, (void *)i);
+    }
+    for (vuint32_t i = 0; i < NTHREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (treeset_key_t key = 0; key < NUM_KEYS; key++) {
+        ASSERT(treeset_contains(&g_tree, key, NULL) == (key % 2U == 1U));
+    }
+    treeset_destroy(&g_tree);
+    sized_pool_destroy(&g_sp);
+    ASSERT(vatomic32_read(&g_live) == 0U);
+}
+
+int
+main(void)
+{
+    test_classes(1U);
+    test_classes(2U);
+    test_classes(4U);
+    test_treeset();
+    return 0;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2024-2025. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2024-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -27,6 +27,7 @@
 typedef struct data_s {
     vuintptr_t key;
     vuint64_t val;
+    struct data_s *next;
 } data_t;
 
 /* Globals */
@@ -67,11 +68,41 @@ cb_hash(vuintptr_t key)
     return h;
 }
 #endif
+#if defined(VSIMPLEHT_REMOVE_LF)
+/* removed values might still be accessed by other threads, we defer freeing
+ * them until the hashtable is destroyed */
+static vatomicptr(data_t *) g_retired = VATOMIC_INIT(NULL);
+
+static inline void
+cb_destroy(void *data)
+{
+    data_t *d    = data;
+    data_t *head = vatomicptr_read(&g_retired);
+    data_t *exp  = NULL;
+    do {
+        exp     = head;
+        d->next = head;
+        head    = vatomicptr_cmpxchg(&g_retired, exp, d);
+    } while (head != exp);
+}
+
+static inline void
+_imap_free_retired(void)
+{
+    data_t *d = vatomicptr_xchg(&g_retired, NULL);
+    while (d) {
+        data_t *next = d->next;
+        free(d);
+        d = next;
+    }
+}
+#else
 static inline void
 cb_destroy(void *data)
 {
     free(data);
 }
+#endif
 
 static inline void
 _imap_verify(void)
@@ -133,6 +164,9 @@ imap_destroy(void)
         trace_destroy(&g_rem[i]);
     }
     vsimpleht_destroy(&g_simpleht);
+#if defined(VSIMPLEHT_REMOVE_LF)
+    _imap_free_retired();
+#endif
     free(g_buff);
     g_buff = NULL;
 }
@@ -173,6 +207,52 @@ imap_get(vsize_t tid, vuintptr_t key)
     return data;
 }
 
+/* adds keys[i] -> keys[i] for all i, returns the number of added keys */
+static inline vsize_t
+imap_add_batch(vsize_t tid, const vuintptr_t *keys, vsize_t count)
+{
+    void *values[VSIMPLEHT_BATCH_SIZE];
+    vsimpleht_ret_t rets[VSIMPLEHT_BATCH_SIZE];
+    vsize_t added = 0;
+
+    ASSERT(count <= VSIMPLEHT_BATCH_SIZE);
+    for (vsize_t i = 0; i < count; i++) {
+        data_t *data = malloc(sizeof(data_t));
+        data->key    = keys[i];
+        data->val    = keys[i];
+        values[i]    = data;
+    }
+    added = vsimpleht_add_batch(&g_simpleht, keys, values, rets, count);
+    for (vsize_t i = 0; i < count; i++) {
+        if (rets[i] == VSIMPLEHT_RET_OK) {
+            trace_add(&g_add[tid], keys[i]);
+        } else {
+            free(values[i]);
+        }
+    }
+    return added;
+}
+
+/* looks up all keys, returns the number of found keys */
+static inline vsize_t
+imap_get_batch(vsize_t tid, const vuintptr_t *keys, vsize_t count)
+{
+    void *values[VSIMPLEHT_BATCH_SIZE];
+    vsize_t found = 0;
+
+    V_UNUSED(tid);
+    ASSERT(count <= VSIMPLEHT_BATCH_SIZE);
+    vsimpleht_get_batch(&g_simpleht, keys, values, count);
+    for (vsize_t i = 0; i < count; i++) {
+        data_t *data = values[i];
+        if (data) {
+            ASSERT(data->key == keys[i]);
+            found++;
+        }
+    }
+    return found;
+}
+
 static inline void
 imap_reg(vsize_t tid)
 {
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) Huawei Technologies Co., Ltd. 2024. All rights reserved.
+ * Copyright (C) Huawei Technologies Co., Ltd. 2024-2026. All rights reserved.
  * SPDX-License-Identifier: MIT
  */
 
@@ -76,6 +76,34 @@ ut_rem_full(void)
     DBG_YELLOW("Removed %zu entries", cnt);
 }
 
+void
+ut_batch(void)
+{
+    vuintptr_t keys[VSIMPLEHT_BATCH_SIZE];
+    vsize_t cnt = 0;
+    vsize_t n   = 0;
+
+    for (vuintptr_t key = MIN_KEY; key <= MAX_KEY; key += n) {
+        n = VMIN(VSIMPLEHT_BATCH_SIZE, MAX_KEY - key + 1U);
+        for (vsize_t i = 0; i < n; i++) {
+            keys[i] = key + i;
+        }
+        ASSERT(imap_get_batch(TID, keys, n) == 0);
+        ASSERT(imap_add_batch(TID, keys, n) == n);
+        /* second time around all keys exist already */
+        ASSERT(imap_add_batch(TID, keys, n) == 0);
+        ASSERT(imap_get_batch(TID, keys, n) == n);
+        cnt += n;
+    }
+    ASSERT(cnt == VSIMPLE_HT_CAPACITY);
+    /* a batch that mixes present and absent keys */
+    ASSERT(imap_rem(TID, MAX_KEY));
+    keys[0] = MIN_KEY;
+    keys[1] = MAX_KEY;
+    ASSERT(imap_get_batch(TID, keys, 2U) == 1U);
+    DBG_YELLOW("Batch inserted %zu entries", cnt);
+}
+
 int
 main(void)
 {
@@ -88,6 +116,7 @@ main(void)
     ut_rem_insert();
     ut_rem_full();
     imap_print();
+    ut_batch();
 
     imap_dereg(TID);
     imap_destroy();
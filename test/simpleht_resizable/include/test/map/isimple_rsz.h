@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ISIMPLE_RSZ_H
+#define ISIMPLE_RSZ_H
+
+/* Macros */
+#define SMR_MAX_NTHREADS NTHREADS
+#define NTRACES          (NTHREADS + 1U)
+
+#define TRACE_CAPACITY 4096U
+
+/* the table starts small and has to grow to hold all keys */
+#define VSIMPLE_RSZ_MIN_CAPACITY 8U
+#define VSIMPLE_RSZ_KEY_COUNT    (TRACE_CAPACITY / 2U)
+
+/* includes */
+#include <test/trace_manager.h>
+#include <test/vmem_stdlib.h>
+#include <test/smr/ismr.h>
+#include <vsync/map/simpleht_resizable.h>
+#include <vsync/vtypes.h>
+
+/* types */
+typedef struct data_s {
+    vuintptr_t key;
+    vuint64_t val;
+    smr_node_t smr_node;
+} data_t;
+
+/* Globals */
+static trace_t g_add[NTRACES]     = {0};
+static trace_t g_rem[NTRACES]     = {0};
+static vsimpleht_rsz_t g_simpleht = {0};
+
+/* callbacks */
+static inline vint8_t
+cb_cmp(vuintptr_t key_a, vuintptr_t key_b)
+{
+    if (key_a == key_b) {
+        return 0;
+    } else if (key_a < key_b) {
+        return -1;
+    } else {
+        return 1;
+    }
+}
+
+static inline vuint64_t
+cb_hash(vuintptr_t key)
+{
+    vuint64_t h = key;
+    h ^= h >> 16U;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13U;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16U;
+    return h;
+}
+
+static inline void
+cb_free_data(smr_node_t *node, void *args)
+{
+    data_t *data = V_CONTAINER_OF(node, data_t, smr_node);
+    vmem_free(data);
+    V_UNUSED(args);
+}
+
+static inline void
+cb_free_tbl(smr_node_t *node, void *args)
+{
+    vsimpleht_rsz_tbl_t *tbl =
+        V_CONTAINER_OF(node, vsimpleht_rsz_tbl_t, smr_node);
+    vsimpleht_rsz_tbl_free(&g_simpleht, tbl);
+    V_UNUSED(args);
+}
+
+static inline void
+cb_retire_val(void *val, void *args)
+{
+    data_t *data = val;
+    ismr_retire(&data->smr_node, cb_free_data, false);
+    V_UNUSED(args);
+}
+
+static inline void
+cb_retire_tbl(vsimpleht_rsz_tbl_t *tbl, void *args)
+{
+    ismr_retire(&tbl->smr_node, cb_free_tbl, false);
+    V_UNUSED(args);
+}
+
+static inline vbool_t
+_imap_unique_key(trace_unit_t *unit)
+{
+    return unit->count == 1U;
+}
+
+static inline void
+_imap_verify(void)
+{
+    vuintptr_t key = 0;
+    data_t *data   = NULL;
+    vsimpleht_rsz_iter_t iter;
+
+    trace_t add_trc;
+    trace_t rem_trc;
+    trace_t final_state_trc;
+
+    trace_init(&add_trc, TRACE_CAPACITY);
+    trace_init(&rem_trc, TRACE_CAPACITY);
+
+    /* merge local traces */
+    for (vsize_t i = 0; i < NTRACES; i++) {
+        trace_merge_into(&add_trc, &g_add[i]);
+        trace_merge_into(&rem_trc, &g_rem[i]);
+    }
+
+    /* extract final state */
+    trace_init(&final_state_trc, TRACE_CAPACITY);
+    vsimpleht_rsz_iter_init(&g_simpleht, &iter);
+    while (vsimpleht_rsz_iter_next(&iter, &key, (void **)&data)) {
+        ASSERT(data->key == key);
+        trace_add(&final_state_trc, key);
+    }
+
+    trace_subtract_from(&add_trc, &rem_trc);
+    vbool_t eq     = trace_is_subtrace(&add_trc, &final_state_trc, NULL);
+    /* a key must not be visible in two tables at the same time */
+    vbool_t no_dup = trace_verify(&final_state_trc, _imap_unique_key);
+
+    trace_destroy(&add_trc);
+    trace_destroy(&rem_trc);
+    trace_destroy(&final_state_trc);
+    ASSERT(eq && "the final state is not what is expected");
+    ASSERT(no_dup && "the final state contains duplicates");
+}
+
+/* interface functions */
+static inline void
+imap_init(void)
+{
+    ismr_init();
+    vsimpleht_rsz_init(&g_simpleht, VSIMPLE_RSZ_MIN_CAPACITY, cb_cmp, cb_hash,
+                       cb_retire_val, cb_retire_tbl, NULL, VMEM_LIB_DEFAULT());
+
+    for (vsize_t i = 0; i < NTRACES; i++) {
+        trace_init(&g_add[i], TRACE_CAPACITY);
+        trace_init(&g_rem[i], TRACE_CAPACITY);
+    }
+}
+static inline void
+imap_destroy(void)
+{
+    _imap_verify();
+    for (vsize_t i = 0; i < NTRACES; i++) {
+        trace_destroy(&g_add[i]);
+        trace_destroy(&g_rem[i]);
+    }
+    vsimpleht_rsz_destroy(&g_simpleht);
+    ismr_destroy();
+    ASSERT(vmem_no_leak());
+}
+static inline vbool_t
+imap_add(vsize_t tid, vuintptr_t key, vuint64_t val)
+{
+    data_t *data = vmem_malloc(sizeof(data_t));
+    data->key    = key;
+    data->val    = val;
+    ismr_enter(tid);
+    vbool_t added =
+        vsimpleht_rsz_add(&g_simpleht, key, data) == VSIMPLEHT_RSZ_RET_OK;
+    ismr_exit(tid);
+    if (added) {
+        /* data might be reclaimed already */
+        trace_add(&g_add[tid], key);
+    } else {
+        vmem_free(data);
+    }
+    return added;
+}
+
+static inline vbool_t
+imap_rem(vsize_t tid, vuintptr_t key)
+{
+    ismr_enter(tid);
+    vbool_t removed =
+        vsimpleht_rsz_remove(&g_simpleht, key) == VSIMPLEHT_RSZ_RET_OK;
+    ismr_exit(tid);
+    if (removed) {
+        trace_add(&g_rem[tid], key);
+    }
+    return removed;
+}
+
+/* @note returns only whether the key was found, the value might be reclaimed
+ * once we leave the critical section */
+static inline vbool_t
+imap_get(vsize_t tid, vuintptr_t key)
+{
+    ismr_enter(tid);
+    data_t *data = vsimpleht_rsz_get(&g_simpleht, key);
+    if (data) {
+        ASSERT(data->key == key);
+        ASSERT(data->val == key);
+    }
+    ismr_exit(tid);
+    return data != NULL;
+}
+
+static inline vsize_t
+imap_capacity(vsize_t tid)
+{
+    vsize_t capacity = 0;
+    ismr_enter(tid);
+    capacity = vsimpleht_rsz_get_capacity(&g_simpleht);
+    ismr_exit(tid);
+    return capacity;
+}
+
+static inline void
+imap_reg(vsize_t tid)
+{
+    ismr_reg(tid);
+}
+
+static inline void
+imap_dereg(vsize_t tid)
+{
+    ismr_dereg(tid);
+}
+
+static inline void
+imap_print(void)
+{
+    vuintptr_t key = 0;
+    data_t *data   = NULL;
+    vsimpleht_rsz_iter_t iter;
+    vsimpleht_rsz_iter_init(&g_simpleht, &iter);
+    while (vsimpleht_rsz_iter_next(&iter, &key, (void **)&data)) {
+        printf("[%" VUINTPTR_FORMAT ":%" VUINT64_FORMAT "],", key, data->val);
+    }
+    printf("\n");
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define NTHREADS 24U
+
+#include <test/map/isimple_rsz.h>
+#include <stdlib.h>
+#include <test/thread_launcher.h>
+
+#define MIN_KEY 1U
+#define MAX_KEY VSIMPLE_RSZ_KEY_COUNT
+
+void
+run_operation(vsize_t tid, vuintptr_t key)
+{
+    if (imap_get(tid, key)) {
+        imap_rem(tid, key);
+    } else {
+        imap_add(tid, key, key);
+    }
+}
+
+void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+
+    imap_reg(tid);
+
+    /* go back and forth such that the table grows and shrinks */
+    for (vsize_t i = 0; i < 2U; i++) {
+        for (vuintptr_t key = MIN_KEY; key <= MAX_KEY; key++) {
+            run_operation(tid, key);
+        }
+        for (vuintptr_t key = MAX_KEY; key >= MIN_KEY; key--) {
+            run_operation(tid, key);
+        }
+    }
+
+    imap_dereg(tid);
+
+    return NULL;
+}
+
+int
+main(void)
+{
+    imap_init();
+    ismr_start_cleaner();
+    launch_threads(NTHREADS, run);
+    ismr_stop_cleaner();
+    imap_destroy();
+    return 0;
+}
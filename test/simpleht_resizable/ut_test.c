@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define NTHREADS 1U
+#include <test/map/isimple_rsz.h>
+#include <stdlib.h>
+
+#define MIN_KEY 1U
+#define MAX_KEY VSIMPLE_RSZ_KEY_COUNT
+#define TID     MAIN_TID
+
+void
+ut_insert_grow(void)
+{
+    vuintptr_t key  = 0;
+    vbool_t success = false;
+    vsize_t cnt     = 0;
+
+    for (key = MIN_KEY; key <= MAX_KEY; key++) {
+        success = imap_add(TID, key, key);
+        ASSERT(success);
+        success = imap_add(TID, key, key);
+        ASSERT(!success);
+        cnt++;
+    }
+    ASSERT(cnt == VSIMPLE_RSZ_KEY_COUNT);
+    ASSERT(vsimpleht_rsz_get_entries_count(&g_simpleht) == cnt);
+    ASSERT(imap_capacity(TID) > VSIMPLE_RSZ_MIN_CAPACITY);
+    DBG_YELLOW("Inserted %zu entries, capacity %zu", cnt, imap_capacity(TID));
+}
+
+void
+ut_get_all(void)
+{
+    vuintptr_t key = 0;
+
+    for (key = MIN_KEY; key <= MAX_KEY; key++) {
+        ASSERT(imap_get(TID, key));
+    }
+    ASSERT(!imap_get(TID, MAX_KEY + 1U));
+    DBG_YELLOW("Found all inserted entries");
+}
+
+void
+ut_rem_insert(void)
+{
+    vbool_t success = false;
+
+    success = imap_rem(TID, MAX_KEY);
+    ASSERT(success);
+    success = imap_rem(TID, MAX_KEY);
+    ASSERT(!success);
+    ASSERT(!imap_get(TID, MAX_KEY));
+    success = imap_add(TID, MAX_KEY, MAX_KEY);
+    ASSERT(success);
+    ASSERT(imap_get(TID, MAX_KEY));
+}
+
+void
+ut_rem_shrink(void)
+{
+    vuintptr_t key  = 0;
+    vbool_t success = false;
+    vsize_t cnt     = 0;
+
+    for (key = MIN_KEY; key <= MAX_KEY; key++) {
+        success = imap_rem(TID, key);
+        ASSERT(success);
+        cnt++;
+        /* the remaining keys must survive the migration */
+        if (key + 1U <= MAX_KEY) {
+            ASSERT(imap_get(TID, key + 1U));
+        }
+    }
+    ASSERT(cnt == VSIMPLE_RSZ_KEY_COUNT);
+    ASSERT(vsimpleht_rsz_get_entries_count(&g_simpleht) == 0);
+    /* run a few operations to finish pending migrations */
+    for (key = MIN_KEY; key <= MAX_KEY; key++) {
+        ASSERT(!imap_get(TID, key));
+    }
+    ASSERT(imap_capacity(TID) == VSIMPLE_RSZ_MIN_CAPACITY);
+    DBG_YELLOW("Removed %zu entries", cnt);
+}
+
+void
+ut_churn(void)
+{
+    vuintptr_t key  = 0;
+    vbool_t success = false;
+
+    /* tombstones must not fill up the table */
+    for (key = MIN_KEY; key <= MAX_KEY; key++) {
+        success = imap_add(TID, key, key);
+        ASSERT(success);
+        success = imap_rem(TID, key);
+        ASSERT(success);
+        ismr_recycle(TID);
+    }
+    ASSERT(vsimpleht_rsz_get_entries_count(&g_simpleht) == 0);
+}
+
+int
+main(void)
+{
+    imap_init();
+
+    ut_insert_grow();
+    ut_get_all();
+    ut_rem_insert();
+    ut_rem_shrink();
+    ut_churn();
+    imap_print();
+
+    imap_destroy();
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <vsync/smr/ebr.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define ROUNDS 8U
+
+/*
+ * Threads free their own retired nodes once they retired VEBR_RETIRE_BATCH of
+ * them, without anyone calling vebr_recycle. Leaving the critical section
+ * does not wait for a blocking recycler that is stuck on a lagging reader.
+ */
+
+typedef struct obj_s {
+    smr_node_t smr_node;
+} obj_t;
+
+vebr_t g_ebr;
+pthread_mutex_t g_lock  = PTHREAD_MUTEX_INITIALIZER;
+vatomic32_t g_stop      = VATOMIC_INIT(0);
+vatomic32_t g_entered   = VATOMIC_INIT(0);
+vatomic32_t g_recycling = VATOMIC_INIT(0);
+vatomic32_t g_freed     = VATOMIC_INIT(0);
+
+static inline void
+lock_acq(void *arg)
+{
+    pthread_mutex_lock((pthread_mutex_t *)arg);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    free(V_CONTAINER_OF(node, obj_t, smr_node));
+    vatomic32_inc(&g_freed);
+    V_UNUSED(args);
+}
+
+void
+retire_one(vebr_thread_t *thrd)
+{
+    obj_t *obj = malloc(sizeof(obj_t));
+
+    vebr_enter(&g_ebr, thrd);
+    vebr_retire(&g_ebr, thrd, &obj->smr_node, free_cb, NULL);
+    vebr_exit(&g_ebr, thrd);
+}
+
+void
+test_amortized(void)
+{
+    vebr_thread_t thrd;
+
+    vebr_register(&g_ebr, &thrd);
+    for (vsize_t i = 0; i + 1U < VEBR_RETIRE_BATCH; i++) {
+        retire_one(&thrd);
+    }
+    ASSERT(vatomic32_read(&g_freed) == 0U);
+    /* the batch is complete, exit frees it */
+    retire_one(&thrd);
+    ASSERT(vatomic32_read(&g_freed) == VEBR_RETIRE_BATCH);
+
+    for (vsize_t i = 0; i < ROUNDS * VEBR_RETIRE_BATCH; i++) {
+        retire_one(&thrd);
+    }
+    ASSERT(vatomic32_read(&g_freed) == (ROUNDS + 1U) * VEBR_RETIRE_BATCH);
+    ASSERT(thrd.retired_count == 0U);
+    vebr_deregister(&g_ebr, &thrd);
+}
+
+void *
+laggard(void *args)
+{
+    vebr_thread_t thrd;
+
+    vebr_register(&g_ebr, &thrd);
+    vebr_enter(&g_ebr, &thrd);
+    vatomic32_write(&g_entered, 1);
+    while (vatomic32_read(&g_stop) == 0) {}
+    vebr_exit(&g_ebr, &thrd);
+    vebr_deregister(&g_ebr, &thrd);
+    V_UNUSED(args);
+    return NULL;
+}
+
+void *
+recycler(void *args)
+{
+    /* advances the epoch past the laggard */
+    (void)vebr_recycle(&g_ebr);
+    vatomic32_write(&g_recycling, 1);
+    /* waits for the laggard while holding the lock */
+    (void)vebr_recycle(&g_ebr);
+    V_UNUSED(args);
+    return NULL;
+}
+
+void
+test_exit_does_not_wait(void)
+{
+    vebr_thread_t thrd;
+    pthread_t threads[2];
+    vuint32_t freed = vatomic32_read(&g_freed);
+
+    vebr_register(&g_ebr, &thrd);
+    pthread_create(&threads[0], NULL, laggard, NULL);
+    while (vatomic32_read(&g_entered) == 0) {}
+    pthread_create(&threads[1], NULL, recycler, NULL);
+    while (vatomic32_read(&g_recycling) == 0) {}
+    usleep(10000);
+
+    /* would hang in vebr_exit if it took the lock */
+    for (vsize_t i = 0; i < ROUNDS * VEBR_RETIRE_BATCH; i++) {
+        retire_one(&thrd);
+    }
+    ASSERT(thrd.recycle_at > thrd.retired_count);
+
+    vatomic32_write(&g_stop, 1);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    /* the laggard is gone, the next batch frees everything */
+    for (vsize_t i = 0; i < VEBR_RETIRE_BATCH; i++) {
+        retire_one(&thrd);
+    }
+    ASSERT(thrd.retired_count == 0U);
+    ASSERT(vatomic32_read(&g_freed) - freed ==
+           (ROUNDS + 1U) * VEBR_RETIRE_BATCH);
+    vebr_deregister(&g_ebr, &thrd);
+}
+
+int
+main(void)
+{
+    smr_lock_lib_t lock_lib = {lock_acq, lock_rel, &g_lock};
+
+    vebr_init(&g_ebr, lock_lib);
+    test_amortized();
+    test_exit_does_not_wait();
+    vebr_destroy(&g_ebr);
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define VEBR_ROBUST
+#include <vsync/smr/ebr.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define RETIRE_COUNT 64U
+
+/*
+ * A thread stays in its critical section until the end of the test. Without
+ * neutralization, vebr_recycle would wait for it forever.
+ */
+
+typedef struct obj_s {
+    smr_node_t smr_node;
+} obj_t;
+
+vebr_t g_ebr;
+pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+vatomic32_t g_stop     = VATOMIC_INIT(0);
+vatomic32_t g_entered  = VATOMIC_INIT(0);
+vatomic32_t g_restarts = VATOMIC_INIT(0);
+vatomic32_t g_freed    = VATOMIC_INIT(0);
+
+static inline void
+lock_acq(void *arg)
+{
+    pthread_mutex_lock((pthread_mutex_t *)arg);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    free(V_CONTAINER_OF(node, obj_t, smr_node));
+    vatomic32_inc(&g_freed);
+    V_UNUSED(args);
+}
+
+void *
+laggard(void *args)
+{
+    vebr_thread_t thrd;
+
+    vebr_register(&g_ebr, &thrd);
+    vebr_enter(&g_ebr, &thrd);
+    vatomic32_write(&g_entered, 1);
+    while (vatomic32_read(&g_stop) == 0) {
+        /* a long traversal that restarts when asked */
+        if (vebr_check(&g_ebr, &thrd)) {
+            vatomic32_inc(&g_restarts);
+        }
+    }
+    vebr_exit(&g_ebr, &thrd);
+    vebr_deregister(&g_ebr, &thrd);
+    V_UNUSED(args);
+    return NULL;
+}
+
+int
+main(void)
+{
+    smr_lock_lib_t lock_lib = {lock_acq, lock_rel, &g_lock};
+    pthread_t thread;
+    obj_t *obj = NULL;
+
+    vebr_init(&g_ebr, lock_lib);
+    pthread_create(&thread, NULL, laggard, NULL);
+    while (vatomic32_read(&g_entered) == 0) {}
+
+    for (vsize_t i = 0; i < RETIRE_COUNT; i++) {
+        obj = malloc(sizeof(obj_t));
+        vebr_retire(&g_ebr, NULL, &obj->smr_node, free_cb, NULL);
+        (void)vebr_recycle(&g_ebr);
+    }
+    /* rounds given up until the laggard restarts are retried */
+    while (vatomic32_read(&g_freed) != RETIRE_COUNT) {
+        (void)vebr_recycle(&g_ebr);
+    }
+    ASSERT(vatomic32_read(&g_restarts) > 0);
+
+    vatomic32_write(&g_stop, 1);
+    pthread_join(thread, NULL);
+    vebr_destroy(&g_ebr);
+    return 0;
+}
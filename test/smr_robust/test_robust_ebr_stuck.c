@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#define VEBR_ROBUST
+#include <vsync/smr/ebr.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define RETIRE_COUNT 256U
+
+/*
+ * A thread stays in its critical section and never calls vebr_check. Another
+ * thread keeps reclaiming: it must not wait for the stuck thread, nor free
+ * anything the stuck thread could still reference.
+ */
+
+typedef struct obj_s {
+    smr_node_t smr_node;
+} obj_t;
+
+vebr_t g_ebr;
+pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+vatomic32_t g_stop     = VATOMIC_INIT(0);
+vatomic32_t g_entered  = VATOMIC_INIT(0);
+vatomic32_t g_done     = VATOMIC_INIT(0);
+vatomic32_t g_freed    = VATOMIC_INIT(0);
+vatomicptr_t g_shared;
+
+static inline void
+lock_acq(void *arg)
+{
+    pthread_mutex_lock((pthread_mutex_t *)arg);
+}
+
+static inline void
+lock_rel(void *arg)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+void
+free_cb(smr_node_t *node, void *args)
+{
+    free(V_CONTAINER_OF(node, obj_t, smr_node));
+    vatomic32_inc(&g_freed);
+    V_UNUSED(args);
+}
+
+void *
+stuck(void *args)
+{
+    vebr_thread_t thrd;
+    obj_t *obj = NULL;
+
+    vebr_register(&g_ebr, &thrd);
+    vebr_enter(&g_ebr, &thrd);
+    /* a reference obtained in the critical section */
+    obj = vatomicptr_read(&g_shared);
+    vatomic32_write(&g_entered, 1);
+    while (vatomic32_read(&g_stop) == 0) {}
+    ASSERT(vatomic32_read(&g_freed) == 0U);
+    V_UNUSED(obj);
+    vebr_exit(&g_ebr, &thrd);
+    vebr_deregister(&g_ebr, &thrd);
+    V_UNUSED(args);
+    return NULL;
+}
+
+void *
+reclaimer(void *args)
+{
+    vebr_thread_t thrd;
+    obj_t *obj = NULL;
+
+    vebr_register(&g_ebr, &thrd);
+    for (vsize_t i = 0; i < RETIRE_COUNT; i++) {
+        vebr_enter(&g_ebr, &thrd);
+        obj = vatomicptr_xchg(&g_shared, malloc(sizeof(obj_t)));
+        vebr_retire(&g_ebr, NULL, &obj->smr_node, free_cb, NULL);
+        vebr_exit(&g_ebr, &thrd);
+        /* returns although the stuck thread lags behind */
+        (void)vebr_recycle(&g_ebr);
+    }
+    vebr_deregister(&g_ebr, &thrd);
+    vatomic32_write(&g_done, 1);
+    V_UNUSED(args);
+    return NULL;
+}
+
+int
+main(void)
+{
+    smr_lock_lib_t lock_lib = {lock_acq, lock_rel, &g_lock};
+    pthread_t threads[2];
+    vebr_thread_t thrd;
+
+    vebr_init(&g_ebr, lock_lib);
+    vatomicptr_init(&g_shared, malloc(sizeof(obj_t)));
+    pthread_create(&threads[0], NULL, stuck, NULL);
+    while (vatomic32_read(&g_entered) == 0) {}
+    pthread_create(&threads[1], NULL, reclaimer, NULL);
+
+    /* the lock is not held while the reclaimer gives up */
+    while (vatomic32_read(&g_done) == 0) {
+        vebr_register(&g_ebr, &thrd);
+        vebr_deregister(&g_ebr, &thrd);
+    }
+    pthread_join(threads[1], NULL);
+
+    vatomic32_write(&g_stop, 1);
+    pthread_join(threads[0], NULL);
+    while (vatomic32_read(&g_freed) != RETIRE_COUNT) {
+        (void)vebr_recycle(&g_ebr);
+    }
+    free(vatomicptr_read(&g_shared));
+    vebr_destroy(&g_ebr);
+    return 0;
+}
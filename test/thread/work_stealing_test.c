@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/thread/work_stealing.h>
+
+#define NUM_WORKERS 4U
+#define FIB_N       20U
+#define FIB_RESULT  6765U
+#define FOR_LEN     100000U
+#define FOR_GRAIN   64U
+/* number of calls of the recursive fib(FIB_N) */
+#define FIB_CALLS   21891U
+
+typedef struct fib_s {
+    vws_task_t task; /* keep first */
+    vuint32_t n;
+    vuint32_t result;
+} fib_t;
+
+typedef struct range_s {
+    vws_task_t task; /* keep first */
+    vsize_t from;
+    vsize_t to;
+} range_t;
+
+vws_sched_t g_sched;
+vws_worker_t g_workers[NUM_WORKERS];
+vuint32_t g_data[FOR_LEN];
+vatomic64_t g_sum;
+vatomic32_t g_ran_on[NUM_WORKERS];
+
+static vuint32_t
+_rand(vuint32_t min, vuint32_t max)
+{
+    return min + ((vuint32_t)rand() % (max - min + 1U));
+}
+
+static void *
+_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+static void
+_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+static void
+fib(vws_worker_t *w, vws_task_t *task)
+{
+    fib_t *f = (fib_t *)task;
+    fib_t a;
+    fib_t b;
+
+    vatomic32_inc_rlx(&g_ran_on[w->idx]);
+    if (f->n < 2U) {
+        f->result = f->n;
+        return;
+    }
+    a.n = f->n - 1U;
+    b.n = f->n - 2U;
+    vws_spawn(w, task, &a.task, fib);
+    vws_spawn(w, task, &b.task, fib);
+    vws_sync(w, task);
+    f->result = a.result + b.result;
+}
+
+/* parallel loop by recursive splitting */
+static void
+sum_range(vws_worker_t *w, vws_task_t *task)
+{
+    range_t *r  = (range_t *)task;
+    vuint64_t s = 0;
+
+    if (r->to - r->from <= FOR_GRAIN) {
+        for (vsize_t i = r->from; i < r->to; i++) {
+            s += g_data[i];
+        }
+        vatomic64_add_rlx(&g_sum, s);
+        return;
+    }
+    range_t left  = {.from = r->from, .to = r->from + (r->to - r->from) / 2};
+    range_t right = {.from = left.to, .to = r->to};
+    vws_spawn(w, task, &left.task, sum_range);
+    vws_spawn(w, task, &right.task, sum_range);
+    vws_sync(w, task);
+}
+
+static void *
+run_worker(void *arg)
+{
+    vws_worker_run(&g_sched, (vuint32_t)(vuintptr_t)arg);
+    return NULL;
+}
+
+int
+main(void)
+{
+    vmem_lib_t mem_lib = {
+        .free_fun = _free, .malloc_fun = _malloc, .arg = NULL};
+    pthread_t threads[NUM_WORKERS];
+    vws_worker_t *w = NULL;
+    void *t         = NULL;
+    vws_task_t root;
+    fib_t f = {.n = FIB_N};
+    range_t r = {.from = 0, .to = FOR_LEN};
+
+    vws_init(&g_sched, g_workers, NUM_WORKERS, _rand, mem_lib);
+    for (vuint32_t i = 1; i < NUM_WORKERS; i++) {
+        pthread_create(&threads[i], NULL, run_worker, (void *)(vuintptr_t)i);
+    }
+    /* the idle workers eventually park */
+    while (vatomic32_read(&g_sched.park.waiters) != NUM_WORKERS - 1U) {
+        usleep(1000);
+    }
+
+    w = vws_worker(&g_sched, 0);
+    vws_task_init(&root);
+    vws_spawn(w, &root, &f.task, fib);
+    vws_sync(w, &root);
+    ASSERT(f.result == FIB_RESULT);
+
+    for (vsize_t i = 0; i < FOR_LEN; i++) {
+        g_data[i] = (vuint32_t)i;
+    }
+    vws_task_init(&root);
+    vws_spawn(w, &root, &r.task, sum_range);
+    vws_sync(w, &root);
+    ASSERT(vatomic64_read(&g_sum) ==
+           (vuint64_t)FOR_LEN * (FOR_LEN - 1U) / 2U);
+
+    vws_stop(&g_sched);
+    for (vuint32_t i = 1; i < NUM_WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    vuint32_t calls = 0;
+    for (vuint32_t i = 0; i < NUM_WORKERS; i++) {
+        ASSERT(vdeque_pop_bottom(&g_workers[i].deque, &t) ==
+               VDEQUE_STATE_EMPTY);
+        calls += vatomic32_read_rlx(&g_ran_on[i]);
+    }
+    ASSERT(calls == FIB_CALLS);
+    vws_destroy(&g_sched);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/chaselev.h>
+#include <test/thread_launcher.h>
+
+#define ARRAY_SIZE  1U
+#define NUM_PUSH    3U
+#define NUM_THREADS 3U
+
+/* Tests growing the deque while thieves steal. The owner pushes more entries
+ * than fit in the initial array, which grows it twice, then pops. Every entry
+ * must be taken exactly once, whether it was stolen from the old or from the
+ * new array. Replaced arrays are kept by the deque until it is destroyed. */
+
+vdeque_t g_vdeque;
+vsize_t g_vals[NUM_PUSH];
+vatomic32_t g_taken[NUM_PUSH];
+
+static void *
+_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+static void
+_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+static void
+take(void *v)
+{
+    vsize_t i = (vsize_t)((vsize_t *)v - g_vals);
+    ASSERT(i < NUM_PUSH);
+    vatomic32_inc_rlx(&g_taken[i]);
+}
+
+static void
+run_owner(void)
+{
+    void *r = NULL;
+    vdeque_state_t status;
+
+    for (vsize_t i = 0; i < NUM_PUSH; i++) {
+        status = vdeque_push_bottom(&g_vdeque, &g_vals[i]);
+        ASSERT(status == VDEQUE_STATE_OK);
+    }
+    while (vdeque_pop_bottom(&g_vdeque, &r) == VDEQUE_STATE_OK) {
+        take(r);
+    }
+    V_UNUSED(status);
+}
+
+static void
+run_stealer(void)
+{
+    void *v = NULL;
+    if (vdeque_steal(&g_vdeque, &v) == VDEQUE_STATE_OK) {
+        take(v);
+    }
+}
+
+static void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    ASSERT(tid < NUM_THREADS);
+    switch (tid) {
+        case 0:
+            run_owner();
+            break;
+        default:
+            run_stealer();
+            break;
+    }
+    return NULL;
+}
+
+/* Initializes global chase-lev deque */
+static void
+init(void)
+{
+    vmem_lib_t mem_lib = {
+        .free_fun = _free, .malloc_fun = _malloc, .arg = NULL};
+    vdeque_init_growable(&g_vdeque, ARRAY_SIZE, mem_lib, NULL, NULL);
+}
+
+/* Checks that every entry was taken exactly once */
+static void
+post(void)
+{
+    for (vsize_t i = 0; i < NUM_PUSH; i++) {
+        ASSERT(vatomic32_read_rlx(&g_taken[i]) == 1U);
+    }
+    vdeque_array_t *a = (vdeque_array_t *)vatomicptr_read_rlx(&g_vdeque.array);
+    ASSERT(vatomicsz_read_rlx(&a->size) == 4U);
+}
+
+int
+main(void)
+{
+    init();
+    launch_threads(NUM_THREADS, run);
+    post();
+    vdeque_destroy(&g_vdeque);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/queue/chaselev.h>
+#include <test/thread_launcher.h>
+
+#define ARRAY_SIZE  4U
+#define NUM_PUSH    3U
+#define NUM_THREADS 3U
+
+/* Tests vdeque_steal_many against vdeque_pop_bottom and vdeque_steal. The
+ * owner pushes three entries and pops until the deque is empty, one thief
+ * steals many, another steals one. Every entry must be taken exactly once. */
+
+vdeque_t g_vdeque;
+vdeque_array_t *g_arr;
+vsize_t g_vals[NUM_PUSH];
+vatomic32_t g_taken[NUM_PUSH];
+
+static void
+take(void *v)
+{
+    vsize_t i = (vsize_t)((vsize_t *)v - g_vals);
+    ASSERT(i < NUM_PUSH);
+    vatomic32_inc_rlx(&g_taken[i]);
+}
+
+static void
+run_owner(void)
+{
+    void *r = NULL;
+    vdeque_state_t status;
+
+    for (vsize_t i = 0; i < NUM_PUSH; i++) {
+        status = vdeque_push_bottom(&g_vdeque, &g_vals[i]);
+        ASSERT(status == VDEQUE_STATE_OK);
+    }
+    do {
+        status = vdeque_pop_bottom(&g_vdeque, &r);
+        if (status == VDEQUE_STATE_OK) {
+            take(r);
+        }
+    } while (status != VDEQUE_STATE_EMPTY);
+}
+
+static void
+run_stealer_many(void)
+{
+    void *v[NUM_PUSH];
+    vsize_t n = 0;
+    if (vdeque_steal_many(&g_vdeque, v, NUM_PUSH, &n) == VDEQUE_STATE_OK) {
+        ASSERT(n > 0);
+        for (vsize_t i = 0; i < n; i++) {
+            take(v[i]);
+        }
+    }
+}
+
+static void
+run_stealer(void)
+{
+    void *v = NULL;
+    if (vdeque_steal(&g_vdeque, &v) == VDEQUE_STATE_OK) {
+        take(v);
+    }
+}
+
+static void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    ASSERT(tid < NUM_THREADS);
+    switch (tid) {
+        case 0:
+            run_owner();
+            break;
+        case 1:
+            run_stealer_many();
+            break;
+        default:
+            run_stealer();
+            break;
+    }
+    return NULL;
+}
+
+/* Initializes global chase-lev deque */
+static void
+init(void)
+{
+    vsize_t array_size = vdeque_memsize(ARRAY_SIZE);
+    g_arr              = (vdeque_array_t *)malloc(array_size);
+    vdeque_init(&g_vdeque, g_arr, ARRAY_SIZE);
+}
+
+/* Checks that every entry was taken exactly once */
+static void
+post(void)
+{
+    for (vsize_t i = 0; i < NUM_PUSH; i++) {
+        ASSERT(vatomic32_read_rlx(&g_taken[i]) == 1U);
+    }
+}
+
+int
+main(void)
+{
+    init();
+    launch_threads(NUM_THREADS, run);
+    post();
+    free(g_arr);
+    g_arr = NULL;
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <vsync/atomic.h>
+#include <vsync/common/assert.h>
+#include <vsync/thread/work_stealing.h>
+#include <test/thread_launcher.h>
+
+#define NUM_WORKERS 2U
+#define NUM_TASKS   2U
+
+/* Worker 0 spawns two tasks and syncs on them while worker 1 steals. After
+ * the sync, the effects of both tasks must be visible, no matter which worker
+ * ran them. Then the scheduler is stopped and worker 1 must return. */
+
+vws_sched_t g_sched;
+vws_worker_t g_workers[NUM_WORKERS];
+vws_task_t g_tasks[NUM_TASKS];
+vsize_t g_done[NUM_TASKS];
+
+static vuint32_t
+_rand(vuint32_t min, vuint32_t max)
+{
+    V_UNUSED(max);
+    return min;
+}
+
+static void *
+_malloc(vsize_t sz, void *arg)
+{
+    V_UNUSED(arg);
+    return malloc(sz);
+}
+
+static void
+_free(void *ptr, void *arg)
+{
+    V_UNUSED(arg);
+    free(ptr);
+}
+
+static void
+task_fun(vws_worker_t *w, vws_task_t *task)
+{
+    V_UNUSED(w);
+    g_done[task - g_tasks]++;
+}
+
+static void
+run_driver(void)
+{
+    vws_worker_t *w = vws_worker(&g_sched, 0);
+    vws_task_t root;
+
+    vws_task_init(&root);
+    for (vsize_t i = 0; i < NUM_TASKS; i++) {
+        vws_spawn(w, &root, &g_tasks[i], task_fun);
+    }
+    vws_sync(w, &root);
+    for (vsize_t i = 0; i < NUM_TASKS; i++) {
+        ASSERT(g_done[i] == 1U);
+    }
+    vws_stop(&g_sched);
+}
+
+static void *
+run(void *args)
+{
+    vsize_t tid = (vsize_t)(vuintptr_t)args;
+    ASSERT(tid < NUM_WORKERS);
+    if (tid == 0) {
+        run_driver();
+    } else {
+        vws_worker_run(&g_sched, (vuint32_t)tid);
+    }
+    return NULL;
+}
+
+int
+main(void)
+{
+    vmem_lib_t mem_lib = {
+        .free_fun = _free, .malloc_fun = _malloc, .arg = NULL};
+    vws_init(&g_sched, g_workers, NUM_WORKERS, _rand, mem_lib);
+    launch_threads(NUM_WORKERS, run);
+    vws_destroy(&g_sched);
+    return 0;
+}